@@ -1,4 +1,6 @@
 #include "amr.h"
+#include "amr_crc.h"
+#include "amr_manch.h"
 #include <string.h>
 
 #ifndef AMR_DEBUG
@@ -8,8 +10,14 @@
 #ifdef ESP8266
 // Include AMR HAL source file so compiler can inline the
 // amrProcessRxBit function into the interrupt handler
+static void amrProcessRxBit(uint8_t rxBit);
 #include "ezradio/platform/esp8266/amr_hal.c"
 #include <osapi.h>
+#elif defined(AMR_HOST_HAL)
+// Host builds replaying captures, see ezradio/platform/host/amr_hal.h
+#include "ezradio/platform/host/amr_hal.c"
+#include <stdio.h>
+#define ICACHE_FLASH_ATTR
 #else
 #include <stdio.h>
 void amrHalInit() {}
@@ -19,9 +27,10 @@ uint8_t amrHalRunning() { return 1; }
 #endif
 
 
-#define RX_BUF_SIZE (AMR_MSG_HDR_SIZE + 2*AMR_MAX_MSG_SIZE)
-#define PROC_RING_BUF_SIZE 512
+#define AMR_MANCH_CHUNK 256 //! Chip bytes the bulk path Manchester decodes at a time
 
+// Preambles are matched against the oldest 32 bits of each phase's 64-bit
+// shift register, so a hit means the frame started 64 decoded bits ago.
 #define SCM_PRE_32      0xf9530000
 #define SCM_PRE_32_MASK 0xfffff800
 #define SCM_PLUS_PRE_32      0x16a30000
@@ -29,24 +38,19 @@ uint8_t amrHalRunning() { return 1; }
 #define IDM_PRE_32      0x555516a3
 #define IDM_PRE_32_MASK 0xffffffff
 
+#define AMR_PRE_WINDOW_BITS 64
+
 uint32_t minIntTime = 999999;
 uint32_t maxIntTime = 0;
 
-static uint8_t rxBuf0[RX_BUF_SIZE] = {0}; //! Manchester decoded data buffer 0
-static uint8_t rxBuf1[RX_BUF_SIZE] = {0}; //! Manchester decoded data buffer 1
-static uint8_t *rxBuf = rxBuf0; //! Active data bufer
-static uint16_t rxBufHeadBit = 0; //! Head of circular buffer in bits
-static uintptr_t xor_rxBufPtr = 0; //! XOR-ed pointers of buffers 0 and 1 for fast toggling
-
-static uint8_t prevRxBit = 0;
-static AmrScmMsg scmMsg = {0};
-static AmrScmPlusMsg scmPlusMsg = {0};
-static AmrIdmMsg idmMsg = {0};
-
+//! Decoder behind the global amr* API
+static AmrDecoder amrDefaultDecoder;
 static void (*amrMsgCallback)(const void * msg, AMR_MSG_TYPE msgType, const uint8_t *data) = NULL;
-
-static Ring msgRing;
-static uint8_t msgRingData[PROC_RING_BUF_SIZE] = {0};
+static void (*amrBatchCallback)(const AmrTaggedMsg * msgs, size_t cnt) = NULL;
+static void (*amrScmMsgCallback)(const AmrScmMsg * msg) = NULL;
+static void (*amrScmPlusMsgCallback)(const AmrScmPlusMsg * msg) = NULL;
+static void (*amrIdmMsgCallback)(const AmrIdmMsg * msg) = NULL;
+static uint8_t amrPreambleFilter = 0;
 
 #if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
 #define NTOH_16BIT(num) ((((uint16_t)(num) << 8) & 0xff00) | (((uint16_t)(num) >> 8) & 0xff))
@@ -57,145 +61,229 @@ static uint8_t msgRingData[PROC_RING_BUF_SIZE] = {0};
 #define HTON_32BIT(num) \
     ((((uint32_t)(num)>>24)&0xff) | (((uint32_t)(num)<<8)&0xff0000) | \
     (((uint32_t)(num)>>8)&0xff00) | (((uint32_t)(num)<<24)&0xff000000))
+#define NTOH_64BIT(num) __builtin_bswap64((uint64_t)(num))
 #elif __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
 #define NTOH_16BIT(num) (num)
 #define NTOH_32BIT(num) (num)
 #define HTON_16BIT(num) (num)
 #define HTON_32BIT(num) (num)
+#define NTOH_64BIT(num) (num)
 #else
 #error Only __ORDER_LITTLE_ENDIAN__ and __ORDER_BIG_ENDIAN__ are supported.
 #endif
 
-/* BCH CRC-16 Table Generation Code
-void calcBCHCRCTable() {
-    const uint16_t poly = 0x6f63;
+// Evaluate BCH CRC-16
+static inline uint8_t computeBCHCRC(const uint8_t * data, size_t len) {
+    uint16_t crc = amrCrc16(AMR_CRC_BCH, 0x0000, data, len);
+    return crc == 0x0000; /* Compare to residual value */
+}
 
-    printf("const uint16_t crc16Table[256] = {");
-    for (size_t div = 0; div < sizeof(crc16Table)/sizeof(crc16Table[0]); div++) {
-        uint16_t curByte = (uint16_t)(div) << 8;
-        for (uint8_t bit = 0; bit < 8; bit++) {
-            if ((curByte & 0x8000) != 0) {
-                curByte = (curByte << 1) ^ poly;
-            }
-            else {
-                curByte = curByte << 1;
-            }
-        }
-        printf("0x%04x,", curByte);
-        crc16Table[div] = curByte;
+// Evaluate CCITT CRC-16
+static inline uint16_t computeCCITTCRC(const uint8_t * data, size_t len) {
+    uint16_t crc = amrCrc16(AMR_CRC_CCITT, 0xffff /* init value */, data, len);
+    return crc == 0x1D0F; /* Compare to residual value */
+}
+
+typedef struct {
+    uint8_t len; //! Frame length in bytes
+    uint8_t crcStart; //! First byte covered by the CRC, which runs to the end
+    uint16_t crcInit;
+    uint16_t crcResidual; //! CRC register after a valid frame
+    const uint16_t * crcTable;
+} AmrFrameLayout;
+
+// Indexed by AMR_MSG_TYPE
+static const AmrFrameLayout amrFrameLayouts[] = {
+    {AMR_MSG_SCM_RAW_SIZE, 2, 0x0000, 0x0000, amrCrcTables[AMR_CRC_BCH][0]},
+    {AMR_MSG_SCM_PLUS_RAW_SIZE, 2, 0xffff, 0x1D0F, amrCrcTables[AMR_CRC_CCITT][0]},
+    {AMR_MSG_IDM_RAW_SIZE, 4, 0xffff, 0x1D0F, amrCrcTables[AMR_CRC_CCITT][0]},
+};
+
+static inline uint8_t amrCheckCrc(AMR_MSG_TYPE type, const uint8_t * data) {
+    const AmrFrameLayout * layout = &amrFrameLayouts[type];
+    if (type == AMR_MSG_TYPE_SCM) {
+        return computeBCHCRC(data + layout->crcStart, layout->len - layout->crcStart);
     }
-    printf("}");
+    return computeCCITTCRC(data + layout->crcStart, layout->len - layout->crcStart);
 }
-*/
 
-/* BCH CRC-16 Lookup table */
-static const uint16_t crc16BCHTable[256] = {
-    0x0000,0x6f63,0xdec6,0xb1a5,0xd2ef,0xbd8c,0x0c29,0x634a,0xcabd,0xa5de,
-    0x147b,0x7b18,0x1852,0x7731,0xc694,0xa9f7,0xfa19,0x957a,0x24df,0x4bbc,
-    0x28f6,0x4795,0xf630,0x9953,0x30a4,0x5fc7,0xee62,0x8101,0xe24b,0x8d28,
-    0x3c8d,0x53ee,0x9b51,0xf432,0x4597,0x2af4,0x49be,0x26dd,0x9778,0xf81b,
-    0x51ec,0x3e8f,0x8f2a,0xe049,0x8303,0xec60,0x5dc5,0x32a6,0x6148,0x0e2b,
-    0xbf8e,0xd0ed,0xb3a7,0xdcc4,0x6d61,0x0202,0xabf5,0xc496,0x7533,0x1a50,
-    0x791a,0x1679,0xa7dc,0xc8bf,0x59c1,0x36a2,0x8707,0xe864,0x8b2e,0xe44d,
-    0x55e8,0x3a8b,0x937c,0xfc1f,0x4dba,0x22d9,0x4193,0x2ef0,0x9f55,0xf036,
-    0xa3d8,0xccbb,0x7d1e,0x127d,0x7137,0x1e54,0xaff1,0xc092,0x6965,0x0606,
-    0xb7a3,0xd8c0,0xbb8a,0xd4e9,0x654c,0x0a2f,0xc290,0xadf3,0x1c56,0x7335,
-    0x107f,0x7f1c,0xceb9,0xa1da,0x082d,0x674e,0xd6eb,0xb988,0xdac2,0xb5a1,
-    0x0404,0x6b67,0x3889,0x57ea,0xe64f,0x892c,0xea66,0x8505,0x34a0,0x5bc3,
-    0xf234,0x9d57,0x2cf2,0x4391,0x20db,0x4fb8,0xfe1d,0x917e,0xb382,0xdce1,
-    0x6d44,0x0227,0x616d,0x0e0e,0xbfab,0xd0c8,0x793f,0x165c,0xa7f9,0xc89a,
-    0xabd0,0xc4b3,0x7516,0x1a75,0x499b,0x26f8,0x975d,0xf83e,0x9b74,0xf417,
-    0x45b2,0x2ad1,0x8326,0xec45,0x5de0,0x3283,0x51c9,0x3eaa,0x8f0f,0xe06c,
-    0x28d3,0x47b0,0xf615,0x9976,0xfa3c,0x955f,0x24fa,0x4b99,0xe26e,0x8d0d,
-    0x3ca8,0x53cb,0x3081,0x5fe2,0xee47,0x8124,0xd2ca,0xbda9,0x0c0c,0x636f,
-    0x0025,0x6f46,0xdee3,0xb180,0x1877,0x7714,0xc6b1,0xa9d2,0xca98,0xa5fb,
-    0x145e,0x7b3d,0xea43,0x8520,0x3485,0x5be6,0x38ac,0x57cf,0xe66a,0x8909,
-    0x20fe,0x4f9d,0xfe38,0x915b,0xf211,0x9d72,0x2cd7,0x43b4,0x105a,0x7f39,
-    0xce9c,0xa1ff,0xc2b5,0xadd6,0x1c73,0x7310,0xdae7,0xb584,0x0421,0x6b42,
-    0x0808,0x676b,0xd6ce,0xb9ad,0x7112,0x1e71,0xafd4,0xc0b7,0xa3fd,0xcc9e,
-    0x7d3b,0x1258,0xbbaf,0xd4cc,0x6569,0x0a0a,0x6940,0x0623,0xb786,0xd8e5,
-    0x8b0b,0xe468,0x55cd,0x3aae,0x59e4,0x3687,0x8722,0xe841,0x41b6,0x2ed5,
-    0x9f70,0xf013,0x9359,0xfc3a,0x4d9f,0x22fc};
+// Meter ID of a byte aligned frame, as the parsers extract it. It always lies
+// within the CRC span.
+static inline uint32_t amrFrameMeterId(AMR_MSG_TYPE type, const uint8_t * data) {
+    switch (type) {
+        case AMR_MSG_TYPE_SCM:
+            return ((uint32_t)(data[2] & 0x6) << 23) | (data[7] << 16) | (data[8] << 8) | data[9];
+        case AMR_MSG_TYPE_SCM_PLUS:
+            return ((uint32_t)data[4] << 24) | (data[5] << 16) | (data[6] << 8) | data[7];
+        default:
+            return ((uint32_t)data[9] << 24) | (data[10] << 16) | (data[11] << 8) | data[12];
+    }
+}
 
-// Evaluate BCH CRC-16
-static inline uint8_t computeBCHCRC(const uint8_t * data, size_t len) {
-    uint16_t crc = 0;
-    uint16_t i = 0;
-    for (; i < len; i++) {
-        crc = (crc << 8) ^ crc16BCHTable[(crc >> 8) ^ data[i]];
+// Advance a running CRC by one byte
+static inline uint16_t amrCrcByte(const uint16_t * table, uint16_t crc, uint8_t byte) {
+    return (uint16_t)(crc << 8) ^ table[(crc >> 8) ^ byte];
+}
+
+void amrDecoderInit(AmrDecoder * dec) {
+    if (dec == NULL) {
+        return;
     }
 
-    return crc == 0x0000; /* Compare to residual value */
+    memset(dec, 0, sizeof(*dec));
+    dec->msgRing = ringInit(dec->msgRingData, sizeof(dec->msgRingData));
+    dec->msgMask = AMR_MSG_MASK_ALL;
+    dec->preambleMask = AMR_MSG_MASK_ALL;
+}
+
+void amrDecoderSetIdFilter(AmrDecoder * dec, const AmrIdFilter * filter) {
+    if (dec == NULL) {
+        return;
+    }
+
+    dec->idFilter = filter;
 }
 
-/* ccitt crc-16 table generation code
-void calcccittcrctable() {
-    const uint16_t poly = 0x1021;
+void amrDecoderSetDedup(AmrDecoder * dec, AmrDedup * dedup) {
+    if (dec == NULL) {
+        return;
+    }
+
+    dec->dedup = dedup;
+}
+
+void amrDecoderSetFrameTap(AmrDecoder * dec, AmrDecoderFrameTap tap, void * user) {
+    if (dec == NULL) {
+        return;
+    }
+
+    dec->frameTap = tap;
+    dec->frameTapUser = user;
+}
+
+uint8_t amrDecoderInjectFrame(AmrDecoder * dec, const AmrMsgHeader * hdr,
+        const uint8_t * frame, size_t len) {
+    if (dec == NULL || hdr == NULL || frame == NULL || len == 0 || len > AMR_MAX_MSG_SIZE + 1) {
+        return 0;
+    }
+
+    // Check for room first, a failed reserve counts as a ring overflow
+    uint8_t * msg = NULL;
+    if (ringFree(&dec->msgRing) < AMR_MSG_HDR_SIZE + len ||
+            ringReserve(&dec->msgRing, AMR_MSG_HDR_SIZE + len, &msg) != RING_STATUS_OK) {
+        return 0;
+    }
+    memcpy(msg, hdr, AMR_MSG_HDR_SIZE);
+    memcpy(msg + AMR_MSG_HDR_SIZE, frame, len);
+    ringCommit(&dec->msgRing);
+    return 1;
+}
+
+void amrDecoderSetMsgMask(AmrDecoder * dec, uint8_t mask, uint8_t filterPreambles) {
+    if (dec == NULL) {
+        return;
+    }
+
+    dec->msgMask = mask;
+    dec->preambleMask = filterPreambles ? mask : AMR_MSG_MASK_ALL;
+}
+
+void amrDecoderSetEarlyCrc(AmrDecoder * dec, uint8_t enable) {
+    if (dec == NULL) {
+        return;
+    }
+
+    dec->earlyCrc = enable;
+}
+
+void amrDecoderRegisterMsgCallback(AmrDecoder * dec, AmrDecoderMsgCallback callback, void * user) {
+    if (dec == NULL) {
+        return;
+    }
+
+    dec->msgCallback = callback;
+    dec->user = user;
+}
+
+void amrDecoderRegisterBatchCallback(AmrDecoder * dec, AmrDecoderBatchCallback callback,
+        AmrTaggedMsg * msgs, size_t maxMsgs) {
+    if (dec == NULL || (callback != NULL && (msgs == NULL || maxMsgs == 0))) {
+        return;
+    }
+
+    dec->batchCallback = callback;
+    dec->batchMsgs = callback ? msgs : NULL;
+    dec->batchMax = callback ? maxMsgs : 0;
+}
+
+// Adapts the default decoder to the callbacks registered with
+// registerAmrMsgCallback and the typed register functions
+static void amrDefaultMsgCallback(AmrDecoder * dec, const AmrMsgHeader * hdr,
+        const void * msg, const uint8_t * data) {
+    if (amrMsgCallback) {
+        amrMsgCallback(msg, hdr->type, data);
+    }
 
-    printf("const uint16_t crc16ccitttable[256] = {");
-    for (size_t div = 0; div < sizeof(crc16table)/sizeof(crc16table[0]); div++) {
-        uint16_t curbyte = (uint16_t)(div) << 8;
-        for (uint8_t bit = 0; bit < 8; bit++) {
-            if ((curbyte & 0x8000) != 0) {
-                curbyte = (curbyte << 1) ^ poly;
+    switch (hdr->type) {
+        case AMR_MSG_TYPE_SCM:
+            if (amrScmMsgCallback) {
+                amrScmMsgCallback((const AmrScmMsg *)msg);
             }
-            else {
-                curbyte = curbyte << 1;
+            break;
+        case AMR_MSG_TYPE_SCM_PLUS:
+            if (amrScmPlusMsgCallback) {
+                amrScmPlusMsgCallback((const AmrScmPlusMsg *)msg);
             }
-        }
-        printf("0x%04x,", curbyte);
+            break;
+        case AMR_MSG_TYPE_IDM:
+            if (amrIdmMsgCallback) {
+                amrIdmMsgCallback((const AmrIdmMsg *)msg);
+            }
+            break;
+        default:
+            break;
     }
-    printf("}");
 }
-*/
 
-/* CCITT CRC-16 Lookup table */
-static const uint16_t crc16CCITTTable[256] = {
-    0x0000,0x1021,0x2042,0x3063,0x4084,0x50a5,0x60c6,0x70e7,0x8108,0x9129,
-    0xa14a,0xb16b,0xc18c,0xd1ad,0xe1ce,0xf1ef,0x1231,0x0210,0x3273,0x2252,
-    0x52b5,0x4294,0x72f7,0x62d6,0x9339,0x8318,0xb37b,0xa35a,0xd3bd,0xc39c,
-    0xf3ff,0xe3de,0x2462,0x3443,0x0420,0x1401,0x64e6,0x74c7,0x44a4,0x5485,
-    0xa56a,0xb54b,0x8528,0x9509,0xe5ee,0xf5cf,0xc5ac,0xd58d,0x3653,0x2672,
-    0x1611,0x0630,0x76d7,0x66f6,0x5695,0x46b4,0xb75b,0xa77a,0x9719,0x8738,
-    0xf7df,0xe7fe,0xd79d,0xc7bc,0x48c4,0x58e5,0x6886,0x78a7,0x0840,0x1861,
-    0x2802,0x3823,0xc9cc,0xd9ed,0xe98e,0xf9af,0x8948,0x9969,0xa90a,0xb92b,
-    0x5af5,0x4ad4,0x7ab7,0x6a96,0x1a71,0x0a50,0x3a33,0x2a12,0xdbfd,0xcbdc,
-    0xfbbf,0xeb9e,0x9b79,0x8b58,0xbb3b,0xab1a,0x6ca6,0x7c87,0x4ce4,0x5cc5,
-    0x2c22,0x3c03,0x0c60,0x1c41,0xedae,0xfd8f,0xcdec,0xddcd,0xad2a,0xbd0b,
-    0x8d68,0x9d49,0x7e97,0x6eb6,0x5ed5,0x4ef4,0x3e13,0x2e32,0x1e51,0x0e70,
-    0xff9f,0xefbe,0xdfdd,0xcffc,0xbf1b,0xaf3a,0x9f59,0x8f78,0x9188,0x81a9,
-    0xb1ca,0xa1eb,0xd10c,0xc12d,0xf14e,0xe16f,0x1080,0x00a1,0x30c2,0x20e3,
-    0x5004,0x4025,0x7046,0x6067,0x83b9,0x9398,0xa3fb,0xb3da,0xc33d,0xd31c,
-    0xe37f,0xf35e,0x02b1,0x1290,0x22f3,0x32d2,0x4235,0x5214,0x6277,0x7256,
-    0xb5ea,0xa5cb,0x95a8,0x8589,0xf56e,0xe54f,0xd52c,0xc50d,0x34e2,0x24c3,
-    0x14a0,0x0481,0x7466,0x6447,0x5424,0x4405,0xa7db,0xb7fa,0x8799,0x97b8,
-    0xe75f,0xf77e,0xc71d,0xd73c,0x26d3,0x36f2,0x0691,0x16b0,0x6657,0x7676,
-    0x4615,0x5634,0xd94c,0xc96d,0xf90e,0xe92f,0x99c8,0x89e9,0xb98a,0xa9ab,
-    0x5844,0x4865,0x7806,0x6827,0x18c0,0x08e1,0x3882,0x28a3,0xcb7d,0xdb5c,
-    0xeb3f,0xfb1e,0x8bf9,0x9bd8,0xabbb,0xbb9a,0x4a75,0x5a54,0x6a37,0x7a16,
-    0x0af1,0x1ad0,0x2ab3,0x3a92,0xfd2e,0xed0f,0xdd6c,0xcd4d,0xbdaa,0xad8b,
-    0x9de8,0x8dc9,0x7c26,0x6c07,0x5c64,0x4c45,0x3ca2,0x2c83,0x1ce0,0x0cc1,
-    0xef1f,0xff3e,0xcf5d,0xdf7c,0xaf9b,0xbfba,0x8fd9,0x9ff8,0x6e17,0x7e36,
-    0x4e55,0x5e74,0x2e93,0x3eb2,0x0ed1,0x1ef0};
-
-// Evaluate CCITT CRC-16
-static inline uint16_t computeCCITTCRC(const uint8_t * data, size_t len) {
-    uint16_t crc = 0xffff; /* init value */
-    uint16_t i = 0;
-    for (; i < len; i++) {
-        crc = (crc << 8) ^ crc16CCITTTable[(crc >> 8) ^ data[i]];
+// Subscribe the default decoder to the types that have a callback. Without
+// typed callbacks every type is kept for amrDrainMsgs and callbacks set
+// directly on amrGetDecoder().
+static void amrDefaultUpdateMsgMask() {
+    uint8_t mask = 0;
+    if (amrScmMsgCallback) {
+        mask |= AMR_MSG_MASK(AMR_MSG_TYPE_SCM);
+    }
+    if (amrScmPlusMsgCallback) {
+        mask |= AMR_MSG_MASK(AMR_MSG_TYPE_SCM_PLUS);
+    }
+    if (amrIdmMsgCallback) {
+        mask |= AMR_MSG_MASK(AMR_MSG_TYPE_IDM);
+    }
+    if (mask == 0 || amrMsgCallback || amrBatchCallback) {
+        mask = AMR_MSG_MASK_ALL;
     }
+    amrDecoderSetMsgMask(&amrDefaultDecoder, mask, amrPreambleFilter);
+}
 
-    return crc == 0x1D0F; /* Compare to residual value */
+// Adapts the default decoder to the callback registered with registerAmrBatchCallback
+static void amrDefaultBatchCallback(AmrDecoder * dec, const AmrTaggedMsg * msgs, size_t cnt) {
+    if (amrBatchCallback) {
+        amrBatchCallback(msgs, cnt);
+    }
 }
 
 void amrInit() {
     // system_set_os_print(1);
-    msgRing = ringInit(msgRingData, sizeof(msgRingData));
-	xor_rxBufPtr = (uintptr_t)(rxBuf0) ^ (uintptr_t)(rxBuf1);
+    amrDecoderInit(&amrDefaultDecoder);
+    amrDecoderRegisterMsgCallback(&amrDefaultDecoder, amrDefaultMsgCallback, NULL);
+    amrDefaultUpdateMsgMask();
     amrHalInit();
 }
 
+AmrDecoder * amrGetDecoder() {
+    return &amrDefaultDecoder;
+}
+
 void amrEnable(uint8_t enable) {
     amrHalEnable(enable);
 }
@@ -204,112 +292,285 @@ uint8_t amrRunning() {
     return amrHalRunning();
 }
 
+void amrSetEarlyCrc(uint8_t enable) {
+    amrDecoderSetEarlyCrc(&amrDefaultDecoder, enable);
+}
+
+void amrSetIdFilter(const AmrIdFilter * filter) {
+    amrDecoderSetIdFilter(&amrDefaultDecoder, filter);
+}
+
+void amrSetDedup(AmrDedup * dedup) {
+    amrDecoderSetDedup(&amrDefaultDecoder, dedup);
+}
+
+void amrSetPreambleFilter(uint8_t enable) {
+    amrPreambleFilter = enable;
+    amrDefaultUpdateMsgMask();
+}
+
+// Start capturing a frame whose first 64 bits are held in the shift register
+static inline void amrStartCapture(AmrDecoder * dec, AmrPhase * phase, uint64_t reg,
+        AMR_MSG_TYPE type, uint16_t size) {
+    ++dec->stats.preambles;
+    if (phase->activeCaptures == (1u << AMR_MAX_CAPTURES) - 1) {
+        debug_printf("No free capture slot for msg type %u\r\n", type);
+        ++dec->stats.dropped;
+        return;
+    }
+
+    uint8_t slot = 0;
+    while (phase->activeCaptures & (1u << slot)) {
+        ++slot;
+    }
+
+    AmrCapture * cap = &phase->captures[slot];
+    cap->type = type;
+
+    // Materialize the bytes already sitting in the shift register
+    uint8_t * data = cap->buf;
+    uint8_t i = 0;
+    for (; i < AMR_PRE_WINDOW_BITS / 8; ++i) {
+        data[i] = (uint8_t)(reg >> (AMR_PRE_WINDOW_BITS - 8 - 8*i));
+    }
+
+    // Start the running CRC on the bytes already received
+    const AmrFrameLayout * layout = &amrFrameLayouts[type];
+    uint16_t crc = layout->crcInit;
+    for (i = layout->crcStart; i < AMR_PRE_WINDOW_BITS / 8; ++i) {
+        crc = amrCrcByte(layout->crcTable, crc, data[i]);
+    }
+    cap->crc = crc;
+
+    cap->bitCnt = AMR_PRE_WINDOW_BITS;
+    cap->bitLen = size * 8;
+    phase->activeCaptures |= (1u << slot);
+}
+
+// Append the newest bit of the shift register to all in-progress captures.
+// Bytes are only written once all 8 of their bits have been received.
+static inline void amrCaptureBit(AmrDecoder * dec, AmrPhase * phase, uint64_t reg) {
+    uint8_t slot = 0;
+    for (; slot < AMR_MAX_CAPTURES; ++slot) {
+        if (!(phase->activeCaptures & (1u << slot))) {
+            continue;
+        }
+
+        AmrCapture * cap = &phase->captures[slot];
+        uint16_t bitCnt = ++cap->bitCnt;
+        if ((bitCnt & 7) == 0) {
+            cap->buf[(bitCnt >> 3) - 1] = (uint8_t)reg;
+            cap->crc = amrCrcByte(amrFrameLayouts[cap->type].crcTable, cap->crc, (uint8_t)reg);
+        }
+
+        if (bitCnt != cap->bitLen) {
+            continue;
+        }
+
+        phase->activeCaptures &= ~(1u << slot);
+        if (dec->earlyCrc && cap->crc != amrFrameLayouts[cap->type].crcResidual) {
+            debug_printf("INVALID CHECKSUM. Msg type %u\r\n", cap->type);
+            ++dec->stats.crcFail;
+        }
+        else {
+            // Build the message directly in ring storage
+            uint8_t * msg = NULL;
+            RING_STATUS status = ringReserve(&dec->msgRing,
+                    AMR_MSG_HDR_SIZE + (bitCnt >> 3), &msg);
+            if (status == RING_STATUS_OK) {
+                AmrMsgHeader * hdr = (AmrMsgHeader *)msg;
+                hdr->type = (AMR_MSG_TYPE)cap->type;
+                // Timestamp with the chip that completed the frame
+                hdr->timestamp = dec->chipCnt;
+                hdr->bitOffset = 0; // Captures are always byte aligned
+                memcpy(msg + AMR_MSG_HDR_SIZE, cap->buf, bitCnt >> 3);
+                ringCommit(&dec->msgRing);
+            }
+            else {
+                debug_printf("Failed to reserve msg type %u on ring. Status: %u\r\n",
+                        cap->type, status);
+                ++dec->stats.dropped;
+            }
+        }
+    }
+}
+
 // This function needs to be inlined into the interrupt handler for performance reasons
-static inline void amrProcessRxBit(uint8_t rxBit) {
-    // The decoding of the current bit depends on the previous bit and the
-    // result is stored in alternating buffers because there are two possible
-    // alignments of the encoded data.
-    
+static inline void amrDecoderProcessRxBit(AmrDecoder * dec, uint8_t rxBit) {
+    // The decoding of the current bit depends on the previous bit and there
+    // are two possible alignments of the encoded data. Each alignment (phase)
+    // keeps its own shift register of decoded bits and alternates every bit.
+
     /* uint32_t ts = system_get_time(); */
 
-    // Select active buffer of manchester decoded data
-    /* rxBuf = (rxBuf != rxBuf0) ? rxBuf0 : rxBuf1; */
-    // Toggle between buffer pointers with XOR-ed value
-    rxBuf = (uint8_t*)(xor_rxBufPtr ^ (uintptr_t)rxBuf);
+    AmrPhase * phase = &dec->phases[dec->phaseIdx];
+    dec->phaseIdx ^= 1;
+    ++dec->chipCnt;
 
     // Manchester decode the current bit based on the previous bit
     // Decode 0b10 as 1 and 0b01, 0b00, 0b11 as 0
-    uint8_t manchBit = prevRxBit && !rxBit;
-
-    // Leave space at the front of the Rx buffer to populate the message header
-    uint8_t* bufHead = rxBuf + AMR_MSG_HDR_SIZE + (rxBufHeadBit / 8);
-    uint8_t bitOffset = (rxBufHeadBit % 8);
-    uint8_t nthBit = 7 - bitOffset;
-
-    // All rx buffer write are duplicated to an identical circular buffer at the
-    // back of the first buffer to avoid having to unwrap data;
-    *bufHead = (*bufHead & (~(1u << nthBit))) | (manchBit << nthBit);
-    *(bufHead + AMR_MAX_MSG_SIZE) = *bufHead;
-
-    uint8_t* msgEnd = bufHead + AMR_MAX_MSG_SIZE;
-    uint8_t* scmData = msgEnd - AMR_MSG_SCM_RAW_SIZE;
-    uint8_t* idmData = msgEnd - AMR_MSG_IDM_RAW_SIZE;
-
-    // Delay the seach for SCM+ preamble until after we checked for an IDM
-    // message. This is accomplished by using the same pointer for both of them.
-    // This will result in an SCM+ preamble being found 16-bits after every IDM
-    // message. Populating the SCM+ header in front of the SCM+ preamble when the
-    // current messsage is an IDM message the IDM message.
-    int8_t* scmPlusData = idmData;
-
-    // Assemble the 32bits of data at the message starts for comparision
-    // Compute preambles
-    uint32_t scmPre =
-        (scmData[0] << (24+bitOffset)) |
-        (scmData[1] << (16+bitOffset)) |
-        (scmData[2] << (8+bitOffset)) |
-        (scmData[3] << (0+bitOffset)) |
-        (scmData[4] >> (8-bitOffset));
-    uint32_t idmPre =
-        idmData[0] << (24+bitOffset) |
-        idmData[1] << (16+bitOffset) |
-        idmData[2] << (8+bitOffset) |
-        idmData[3] << (0+bitOffset) |
-        idmData[4] >> (8-bitOffset);
-    uint32_t scmPlusPre = idmPre;
-
-
-    if ((scmPre & SCM_PRE_32_MASK) == SCM_PRE_32) {
-    /* if ((preamble & SCM_PRE_32_MASK) == SCM_PRE_32) { */
-        AmrMsgHeader * hdr = (AmrMsgHeader *)(scmData - AMR_MSG_HDR_SIZE);
-        hdr->type = AMR_MSG_TYPE_SCM;
-        // TODO populate timestamp with platform agnostic call
-        // hdr->timestamp = system_get_time() / 1000; // Convert micro to millis
-        hdr->bitOffset = bitOffset;
-        RING_STATUS status =
-            ringPush(&msgRing, (uint8_t*)hdr,
-                    AMR_MSG_SCM_RAW_SIZE + AMR_MSG_HDR_SIZE + 1);
-        if (AMR_DEBUG && status != RING_STATUS_OK) {
-            debug_printf("Failed to push SCM msg onto ring. Status: %u\r\n", status);
-        }
+    uint8_t manchBit = dec->prevRxBit && !rxBit;
+    dec->prevRxBit = rxBit;
+
+    uint64_t reg = (phase->shiftReg << 1) | manchBit;
+    phase->shiftReg = reg;
+
+    if (phase->activeCaptures) {
+        amrCaptureBit(dec, phase, reg);
+    }
+
+    // An IDM preamble ends with the SCM+ preamble so IDM is checked first. An
+    // SCM+ hit is still reported 16 bits after every IDM hit, which then fails
+    // its CRC check.
+    // Types filtered out of preambleMask are skipped before the compare.
+    uint32_t pre = (uint32_t)(reg >> 32);
+    uint8_t preMask = dec->preambleMask;
+    if ((preMask & AMR_MSG_MASK(AMR_MSG_TYPE_SCM)) &&
+            (pre & SCM_PRE_32_MASK) == SCM_PRE_32) {
+        amrStartCapture(dec, phase, reg, AMR_MSG_TYPE_SCM, AMR_MSG_SCM_RAW_SIZE);
+    }
+    else if ((preMask & AMR_MSG_MASK(AMR_MSG_TYPE_IDM)) &&
+            (pre & IDM_PRE_32_MASK) == IDM_PRE_32) {
+        amrStartCapture(dec, phase, reg, AMR_MSG_TYPE_IDM, AMR_MSG_IDM_RAW_SIZE);
     }
-    else if (idmPre == IDM_PRE_32) {
-        AmrMsgHeader * hdr = (AmrMsgHeader *)(idmData - AMR_MSG_HDR_SIZE);
-        hdr->type = AMR_MSG_TYPE_IDM;
-        // TODO populate timestamp with platform agnostic call
-        // hdr->timestamp = system_get_time() / 1000; // Convert micro to millis
-        hdr->bitOffset = bitOffset;
-        RING_STATUS status =
-            ringPush(&msgRing, (uint8_t*)hdr,
-                    AMR_MSG_IDM_RAW_SIZE + AMR_MSG_HDR_SIZE + 1);
-        if (AMR_DEBUG && status != RING_STATUS_OK) {
-            debug_printf("Failed to push IDM msg onto ring. Status: %u\r\n", status);
+    else if ((preMask & AMR_MSG_MASK(AMR_MSG_TYPE_SCM_PLUS)) &&
+            (pre & SCM_PLUS_PRE_32_MASK) == SCM_PLUS_PRE_32) {
+        amrStartCapture(dec, phase, reg, AMR_MSG_TYPE_SCM_PLUS, AMR_MSG_SCM_PLUS_RAW_SIZE);
+    }
+
+    /* uint32_t dt = system_get_time() - ts; */
+    /* if (dt < minIntTime) minIntTime = dt; */
+    /* if (dt > maxIntTime) maxIntTime = dt; */
+}
+
+static inline void amrProcessRxBit(uint8_t rxBit) {
+    amrDecoderProcessRxBit(&amrDefaultDecoder, rxBit);
+}
+
+// Bit-parallel filter over the 32 preamble windows that shifting 32 more bits
+// into a phase register would expose. Window k is compared after the k-th new
+// bit, at which point the oldest 32 bits of the register are reg >> (31 - k),
+// so bit j of every window is held in (uint32_t)(reg >> j). Only the leading
+// 16 bits of the preambles are compared, which rules out nearly every word;
+// the exact masked compare is left to the per bit path. The loop has a fixed
+// trip count and no branches so the compiler can unroll and vectorize it.
+// Types missing from preMask are dropped from the result.
+static inline uint32_t amrScanPreambles(uint64_t reg, uint8_t preMask) {
+    uint32_t scm = 0xffffffff;
+    uint32_t idm = 0xffffffff;
+    uint32_t scmPlus = 0xffffffff;
+    uint8_t j = 16;
+    for (; j < 32; ++j) {
+        uint32_t bits = (uint32_t)(reg >> j);
+        scm &= bits ^ (((SCM_PRE_32 >> j) & 1) - 1);
+        idm &= bits ^ (((IDM_PRE_32 >> j) & 1) - 1);
+        scmPlus &= bits ^ (((SCM_PLUS_PRE_32 >> j) & 1) - 1);
+    }
+    return (scm & -(uint32_t)((preMask >> AMR_MSG_TYPE_SCM) & 1)) |
+            (idm & -(uint32_t)((preMask >> AMR_MSG_TYPE_IDM) & 1)) |
+            (scmPlus & -(uint32_t)((preMask >> AMR_MSG_TYPE_SCM_PLUS) & 1));
+}
+
+// Returns non-zero when an in-progress capture completes within nbits
+static inline uint8_t amrCaptureEnding(const AmrPhase * phase, uint16_t nbits) {
+    uint8_t slot = 0;
+    for (; slot < AMR_MAX_CAPTURES; ++slot) {
+        if ((phase->activeCaptures & (1u << slot)) &&
+                phase->captures[slot].bitLen - phase->captures[slot].bitCnt <= nbits) {
+            return 1;
         }
     }
-    else if ((scmPlusPre & SCM_PLUS_PRE_32_MASK) == SCM_PLUS_PRE_32) {
-        AmrMsgHeader * hdr = (AmrMsgHeader *)(scmPlusData - AMR_MSG_HDR_SIZE);
-        hdr->type = AMR_MSG_TYPE_SCM_PLUS;
-        // TODO populate timestamp with platform agnostic call
-        // hdr->timestamp = system_get_time() / 1000; // Convert micro to millis
-        hdr->bitOffset = bitOffset;
-        RING_STATUS status =
-            ringPush(&msgRing, (uint8_t*)hdr,
-                    AMR_MSG_SCM_PLUS_RAW_SIZE + AMR_MSG_HDR_SIZE + 1);
-        if (AMR_DEBUG && status != RING_STATUS_OK) {
-            debug_printf("Failed to push SCM+ msg onto ring. Status: %u\r\n", status);
+    return 0;
+}
+
+// Append 32 bits (already shifted into reg) to all in-progress captures. None
+// of the captures may complete within these bits.
+static inline void amrCaptureWord(AmrPhase * phase, uint64_t reg) {
+    uint8_t slot = 0;
+    for (; slot < AMR_MAX_CAPTURES; ++slot) {
+        if (!(phase->activeCaptures & (1u << slot))) {
+            continue;
+        }
+
+        AmrCapture * cap = &phase->captures[slot];
+        uint16_t byteIdx = cap->bitCnt >> 3;
+        cap->bitCnt += 32;
+        // Newest bit of the register is frame bit bitCnt - 1
+        for (; byteIdx < (cap->bitCnt >> 3); ++byteIdx) {
+            uint8_t byte = (uint8_t)(reg >> (cap->bitCnt - 8*byteIdx - 8));
+            cap->buf[byteIdx] = byte;
+            cap->crc = amrCrcByte(amrFrameLayouts[cap->type].crcTable, cap->crc, byte);
         }
     }
+}
 
-    prevRxBit = rxBit;
+void amrDecoderProcessBits(AmrDecoder * dec, const uint8_t * packed, size_t nbits) {
+    if (dec == NULL || packed == NULL) {
+        return;
+    }
+
+    uint8_t phase0[AMR_MANCH_CHUNK / 2];
+    uint8_t phase1[AMR_MANCH_CHUNK / 2];
+    size_t bit = 0;
+    // Whole words of 64 chips carry 32 decoded bits for each phase
+    while (bit + 64 <= nbits) {
+        size_t nbytes = (nbits - bit) / 64 * 8;
+        if (nbytes > AMR_MANCH_CHUNK) {
+            nbytes = AMR_MANCH_CHUNK;
+        }
+        // Decoded bits depend on the chips alone, so the chunk stays valid
+        // when a word below falls back to the per bit path
+        amrManchDecode(packed + bit / 8, nbytes, dec->prevRxBit != 0, phase0, phase1);
+
+        size_t i = 0;
+        for (; i < nbytes; i += 8, bit += 64) {
+            // Chips 0, 2, ... of the word belong to the phase that receives the
+            // next chip
+            AmrPhase * first = &dec->phases[dec->phaseIdx];
+            AmrPhase * second = &dec->phases[dec->phaseIdx ^ 1];
+            uint32_t firstBits;
+            uint32_t secondBits;
+            memcpy(&firstBits, phase0 + i / 2, sizeof(firstBits));
+            memcpy(&secondBits, phase1 + i / 2, sizeof(secondBits));
+            firstBits = NTOH_32BIT(firstBits);
+            secondBits = NTOH_32BIT(secondBits);
+
+            if (amrScanPreambles(first->shiftReg, dec->preambleMask) == 0 &&
+                    amrScanPreambles(second->shiftReg, dec->preambleMask) == 0 &&
+                    !amrCaptureEnding(first, 32) &&
+                    !amrCaptureEnding(second, 32)) {
+                first->shiftReg = (first->shiftReg << 32) | firstBits;
+                second->shiftReg = (second->shiftReg << 32) | secondBits;
+                if (first->activeCaptures) {
+                    amrCaptureWord(first, first->shiftReg);
+                }
+                if (second->activeCaptures) {
+                    amrCaptureWord(second, second->shiftReg);
+                }
+                dec->prevRxBit = packed[bit / 8 + 7] & 1;
+                dec->chipCnt += 64;
+            }
+            else {
+                // Preamble hit or completed frame, let the per bit path order
+                // ring pushes exactly as if the bits arrived one at a time
+                uint64_t chips = 0;
+                memcpy(&chips, packed + bit / 8, sizeof(chips));
+                chips = NTOH_64BIT(chips);
+                int8_t b = 63;
+                for (; b >= 0; --b) {
+                    amrDecoderProcessRxBit(dec, (chips >> b) & 1);
+                }
+            }
+        }
+    }
 
-    // Only increment the head bit after we've processed both buffers 0 and 1
-    if (rxBuf == rxBuf1) {
-        rxBufHeadBit = (rxBufHeadBit + 1) % (AMR_MAX_MSG_SIZE*8);
+    for (; bit < nbits; ++bit) {
+        amrDecoderProcessRxBit(dec, (packed[bit / 8] >> (7 - bit % 8)) & 1);
     }
+}
 
-    /* uint32_t dt = system_get_time() - ts; */
-    /* if (dt < minIntTime) minIntTime = dt; */
-    /* if (dt > maxIntTime) maxIntTime = dt; */
+void amrProcessRxBits(const uint8_t * packed, size_t nbits) {
+    amrDecoderProcessBits(&amrDefaultDecoder, packed, nbits);
 }
 
 uint32_t extractBits(const uint8_t *data, uint16_t offset, uint16_t len) {
@@ -342,195 +603,361 @@ uint32_t extractBits(const uint8_t *data, uint16_t offset, uint16_t len) {
     return out;
 }
 
-static inline void parseSCMMsg(const uint8_t *data, uint32_t t_ms) {
-    if(computeBCHCRC(data+2, 10)) {
-        scmMsg.id =
-            ((data[2] & 0x6) << 23) |
-            (data[7] << 16) |
-            (data[8] << 8) |
-            data[9];
-        scmMsg.consumption =
-            data[4] << 16 |
-            data[5] << 8 |
-            data[6];
-        scmMsg.type = (data[3] >> 2) & 0xf;
-        scmMsg.tamper_phy = (data[3] >> 6) & 0x3;
-        scmMsg.tamper_enc = data[3] & 0x3;
-        scmMsg.crc = data[10] << 8 | data[11];
+// Unpack count big endian fields of width bits (at most 16) laid end to end
+// from data. Every field is shifted out of the 64-bit big endian word that
+// holds its first bit, so there are no per-bit branches and the loop unrolls
+// into loads, shifts and masks. data must be readable for 8 bytes from the
+// byte holding the last field's first bit.
+#define AMR_DEFINE_UNPACK(width, count) \
+static inline void amrUnpack##width##x##count(const uint8_t * data, uint16_t * out) { \
+    size_t i = 0; \
+    for (; i < (count); ++i) { \
+        uint64_t w; \
+        memcpy(&w, data + i * (width) / 8, sizeof(w)); \
+        out[i] = (uint16_t)((NTOH_64BIT(w) << (i * (width) % 8)) >> (64 - (width))); \
+    } \
+}
 
+AMR_DEFINE_UNPACK(9, 47) // Standard IDM differential consumption
+AMR_DEFINE_UNPACK(14, 27) // ERT type 0x18 differential consumption
 
-/*
-if((scmMsg.id & 0xfffffff0) ==  (32839945 & 0xfffffff0)) {
-        printf("SCM %8u: 0x%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X\r\n",
-        scmMsg.id,
-        data[0], data[1], data[2], data[3], data[4], data[5], data[6],
-        data[7], data[8], data[9], data[10], data[11], data[12]);
-}
-*/
+// Realignment works a machine word at a time
+#if UINTPTR_MAX > 0xffffffffu
+typedef uint64_t AmrWord;
+#define NTOH_WORD(num) NTOH_64BIT(num)
+#else
+typedef uint32_t AmrWord;
+#define NTOH_WORD(num) NTOH_32BIT(num)
+#endif
 
-        if (amrMsgCallback) {
-            amrMsgCallback(&scmMsg, AMR_MSG_TYPE_SCM, data);
-        }
+// Shift len bytes left by offset (1-7) bits, filling the low bits of the last
+// byte from next. Each big endian word is funnel shifted with the first byte
+// of the following word, which hasn't been shifted yet. Live captures are
+// queued byte aligned, so only frames queued with a bitOffset through
+// amrDecoderInjectFrame (e.g. by amrReplay) get here.
+static inline void amrRealign(uint8_t * data, size_t len, uint8_t next, uint8_t offset) {
+    size_t i = 0;
+    for (; i + sizeof(AmrWord) < len; i += sizeof(AmrWord)) {
+        AmrWord w;
+        memcpy(&w, data + i, sizeof(w));
+        w = (AmrWord)(NTOH_WORD(w) << offset) | (data[i + sizeof(AmrWord)] >> (8 - offset));
+        w = NTOH_WORD(w);
+        memcpy(data + i, &w, sizeof(w));
     }
-    else {
-        debug_printf("INAVLID SCM CHECKSUM\r\n");
+    for (; i + 1 < len; ++i) {
+        data[i] = (data[i] << offset) | (data[i+1] >> (8-offset));
+    }
+    if (i < len) {
+        data[i] = (data[i] << offset) | (next >> (8-offset));
     }
 }
 
-static inline void parseSCMPlusMsg(const uint8_t *data, uint32_t t_ms) {
-    if(computeCCITTCRC(data+2, sizeof(AmrScmPlusMsg)-2)) {
-        memcpy((void*)&scmPlusMsg, (void*)data, sizeof(AmrScmPlusMsg));
-        scmPlusMsg.frameSync = NTOH_16BIT(scmPlusMsg.frameSync);
-        scmPlusMsg.protocolId = scmPlusMsg.protocolId; // No op
-        scmPlusMsg.endpointType = scmPlusMsg.endpointType; // No op
-        scmPlusMsg.endpointId = NTOH_32BIT(scmPlusMsg.endpointId);
-        scmPlusMsg.consumption = NTOH_32BIT(scmPlusMsg.consumption);
-        scmPlusMsg.tamper = NTOH_16BIT(scmPlusMsg.tamper);
-        scmPlusMsg.crc = NTOH_16BIT(scmPlusMsg.crc);
+uint8_t amrParseScm(const uint8_t * frame, AmrScmMsg * out) {
+    if (frame == NULL || out == NULL) {
+        return 0;
+    }
 
+    out->id =
+        ((frame[2] & 0x6) << 23) |
+        (frame[7] << 16) |
+        (frame[8] << 8) |
+        frame[9];
+    out->consumption =
+        frame[4] << 16 |
+        frame[5] << 8 |
+        frame[6];
+    out->type = (frame[3] >> 2) & 0xf;
+    out->tamper_phy = (frame[3] >> 6) & 0x3;
+    out->tamper_enc = frame[3] & 0x3;
+    out->crc = frame[10] << 8 | frame[11];
+
+    return 1;
+}
 
-        if (amrMsgCallback) {
-            amrMsgCallback(&scmPlusMsg, AMR_MSG_TYPE_SCM_PLUS, data);
-        }
+uint8_t amrParseScmPlus(const uint8_t * frame, AmrScmPlusMsg * out) {
+    if (frame == NULL || out == NULL) {
+        return 0;
+    }
+
+    memcpy((void*)out, (const void*)frame, sizeof(AmrScmPlusMsg));
+    out->frameSync = NTOH_16BIT(out->frameSync);
+    out->protocolId = out->protocolId; // No op
+    out->endpointType = out->endpointType; // No op
+    out->endpointId = NTOH_32BIT(out->endpointId);
+    out->consumption = NTOH_32BIT(out->consumption);
+    out->tamper = NTOH_16BIT(out->tamper);
+    out->crc = NTOH_16BIT(out->crc);
+    return 1;
+}
+
+uint8_t amrParseIdm(const uint8_t * frame, AmrIdmMsg * out) {
+    if (frame == NULL || out == NULL) {
+        return 0;
+    }
+
+    const uint8_t * head = frame;
+    memset(out, 0, sizeof(*out));
+    memcpy((void*)out, (const void*)head, 14);
+    head+=14;
+
+    out->preamble = NTOH_32BIT(out->preamble);
+    // out->ertType; // No op (deviation from rtl-amr that masks out the first 4-bits)
+    out->ertId = NTOH_32BIT(out->ertId);
+
+    if (out->ertType == 0x18) {
+        memcpy((void *)&(out->data.x18.unknown), (void*)head, 10);
+        head += 10;
+        memcpy((void *)&(out->data.x18.lastConsumption), (void*)head, 4);
+        out->data.x18.lastConsumption = NTOH_32BIT(out->data.x18.lastConsumption);
+        head += 4;
+        out->data.x18.lastExcess = (head[0] << 16) | (head[1] << 8) | head[0];
+        head += 3;
+        out->data.x18.lastResidual = (head[0] << 16) | (head[1] << 8) | head[0];
+        head += 3;
+        memcpy((void *)&(out->data.x18.lastConsumptionHighRes), (void*)head, 4);
+        out->data.x18.lastConsumptionHighRes = NTOH_32BIT(out->data.x18.lastConsumptionHighRes);
+        head += 4;
+
+        // Last field starts in byte 45 of the 48, the 8 byte load stays
+        // inside the frame
+        amrUnpack14x27(head, out->data.x18.differentialConsumption);
+        head += 48;
     }
     else {
-        debug_printf("INAVLID SCM+ CHECKSUM\r\n");
-    }
-}
-
-static inline void parseIDMMsg(const uint8_t *data, uint32_t t_ms) {
-    const uint8_t * head = data;
-    if (computeCCITTCRC(head+4, 88)) {
-        memcpy((void*)&idmMsg, (void*)head, 14);
-        head+=14;
-
-        idmMsg.preamble = NTOH_32BIT(idmMsg.preamble);
-        // idmMsg.ertType; // No op (deviation from rtl-amr that masks out the first 4-bits)
-        idmMsg.ertId = NTOH_32BIT(idmMsg.ertId);
-
-        if (idmMsg.ertType == 0x18) {
-            memcpy((void *)&(idmMsg.data.x18.unknown), (void*)head, 10);
-            head += 10;
-            memcpy((void *)&(idmMsg.data.x18.lastConsumption), (void*)head, 4);
-            idmMsg.data.x18.lastConsumption = NTOH_32BIT(idmMsg.data.x18.lastConsumption);
-            head += 4;
-            idmMsg.data.x18.lastExcess = (head[0] << 16) | (head[1] << 8) | head[0];
-            head += 3;
-            idmMsg.data.x18.lastResidual = (head[0] << 16) | (head[1] << 8) | head[0];
-            head += 3;
-            memcpy((void *)&(idmMsg.data.x18.lastConsumptionHighRes), (void*)head, 4);
-            idmMsg.data.x18.lastConsumptionHighRes = NTOH_32BIT(idmMsg.data.x18.lastConsumptionHighRes);
-            head += 4;
-
-            const uint16_t spacing = 14;
-            for (uint16_t cnt = 0; cnt < 27; cnt++) {
-                idmMsg.data.x18.differentialConsumption[cnt] = extractBits(head, cnt * spacing, spacing);
-            }
-            head += 48;
-        }
-        else {
-            memcpy((void *)&(idmMsg.data.std.moduleProgrammingState), (void *)head, 19);
-            // idmMsg.tamperCounters; // No op
-            head += 19;
-
-            idmMsg.data.std.asyncCnt = NTOH_16BIT(idmMsg.data.std.asyncCnt);
-            // idm.powerOutageFlags; // No op
-            idmMsg.data.std.lastConsumption = NTOH_32BIT(idmMsg.data.std.lastConsumption);
-
-            const uint16_t spacing = 9;
-            for (uint16_t cnt = 0; cnt < 47; cnt++)
-            {
-                idmMsg.data.std.differentialConsumption[cnt] = extractBits(head, cnt * spacing, spacing);
-            }
-            head += 53;
+        memcpy((void *)&(out->data.std.moduleProgrammingState), (void *)head, 19);
+        // out->tamperCounters; // No op
+        head += 19;
 
-        }
+        out->data.std.asyncCnt = NTOH_16BIT(out->data.std.asyncCnt);
+        // idm.powerOutageFlags; // No op
+        out->data.std.lastConsumption = NTOH_32BIT(out->data.std.lastConsumption);
 
-        memcpy((void *)&(idmMsg.txTimeOffset), (void *)head, 6);
-        head += 6;
+        // Last field starts in byte 51 of the 53, the 8 byte load stays
+        // inside the frame
+        amrUnpack9x47(frame + AMR_MSG_IDM_INTERVALS_OFFSET, out->data.std.differentialConsumption);
+        head += 53;
 
-        idmMsg.txTimeOffset = NTOH_16BIT(idmMsg.txTimeOffset);
-        idmMsg.serialNumberCRC = NTOH_16BIT(idmMsg.serialNumberCRC);
-        idmMsg.pktCRC = NTOH_16BIT(idmMsg.pktCRC);
+    }
 
+    memcpy((void *)&(out->txTimeOffset), (void *)head, 6);
+    head += 6;
+
+    out->txTimeOffset = NTOH_16BIT(out->txTimeOffset);
+    out->serialNumberCRC = NTOH_16BIT(out->serialNumberCRC);
+    out->pktCRC = NTOH_16BIT(out->pktCRC);
+    return 1;
+}
+
+static inline void parseSCMMsg(AmrDecoder * dec, const AmrMsgHeader * hdr, const uint8_t *data) {
+    amrParseScm(data, &dec->scmMsg);
+
+/*
+if((dec->scmMsg.id & 0xfffffff0) ==  (32839945 & 0xfffffff0)) {
+    printf("SCM %8u: 0x%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X\r\n",
+    dec->scmMsg.id,
+    data[0], data[1], data[2], data[3], data[4], data[5], data[6],
+    data[7], data[8], data[9], data[10], data[11], data[12]);
+}
+*/
+
+    if (dec->msgCallback) {
+        dec->msgCallback(dec, hdr, &dec->scmMsg, data);
+    }
+}
+
+static inline void parseSCMPlusMsg(AmrDecoder * dec, const AmrMsgHeader * hdr, const uint8_t *data) {
+    amrParseScmPlus(data, &dec->scmPlusMsg);
+
+    if (dec->msgCallback) {
+        dec->msgCallback(dec, hdr, &dec->scmPlusMsg, data);
+    }
+}
+
+static inline void parseIDMMsg(AmrDecoder * dec, const AmrMsgHeader * hdr, const uint8_t *data) {
+    amrParseIdm(data, &dec->idmMsg);
 
 /* Print Binary */
 /*
-if((idmMsg.ertId & 0xfffffff0) ==  (32839945 & 0xfffffff0)) {
-        // printf("IDM %8u: 0x", idmMsg.ertId); 
-        printf("\r\n");
-        for (int j = 0; j < 92; ++j) {
-            printf("%02X", data[j]);
-            os_delay_us(2000);
-     }
+if((dec->idmMsg.ertId & 0xfffffff0) ==  (32839945 & 0xfffffff0)) {
+    // printf("IDM %8u: 0x", dec->idmMsg.ertId); 
     printf("\r\n");
-    os_delay_us(50000);
+    for (int j = 0; j < 92; ++j) {
+        printf("%02X", data[j]);
+        os_delay_us(2000);
+ }
+printf("\r\n");
+os_delay_us(50000);
 }
 */
 
-        if (amrMsgCallback) {
-            amrMsgCallback(&idmMsg, AMR_MSG_TYPE_IDM, data);
-        }
-    }
-    else {
-        debug_printf("INVALID IDM CHECKSUM\r\n");
+    if (dec->msgCallback) {
+        dec->msgCallback(dec, hdr, &dec->idmMsg, data);
     }
 }
 
-void amrProcessMsgs() {
+// Peek the next message that passes its CRC, byte aligned in place. Frames
+// that fail are released along the way. Returns 0 once the ring is empty,
+// otherwise the caller releases the message when done with it.
+static uint8_t amrDecoderNextMsg(AmrDecoder * dec, AmrMsgHeader ** hdrOut, uint8_t ** dataOut) {
     while (1) {
         uint8_t * peek = 0;
-        RingPos_t size = ringPeek(&msgRing, &peek); 
-        // Message available
-        if (size > AMR_MSG_HDR_SIZE && peek) {
-            AmrMsgHeader* hdr = (AmrMsgHeader*)peek;
-            uint8_t* msgData = peek + AMR_MSG_HDR_SIZE;
-
-            // Shift data to be byte boundary aligned
-            if (hdr->bitOffset != 0) {
-                uint8_t offset = hdr->bitOffset;
-                uint8_t i = 0;
-                for (; i < (size - AMR_MSG_HDR_SIZE - 1); ++i) {
-                    msgData[i] = (msgData[i] << offset) | (msgData[i+1] >> (8-offset));
-                }
-            }
+        RingPos_t size = ringPeek(&dec->msgRing, &peek);
+        // No message ready
+        if (size <= AMR_MSG_HDR_SIZE || !peek) {
+            return 0;
+        }
 
-            switch (hdr->type) {
-                case AMR_MSG_TYPE_SCM:
-                    {
-                        /*printf("SCM Msg. Offset: %u Pre: 0x%02x%02X%02X\r\n",
-                                hdr->bitOffset, msgData[0], msgData[1],
-                                msgData[2] & 0xf8);*/
-                        parseSCMMsg(msgData, hdr->timestamp);
-                    }
-                    break;
-                case AMR_MSG_TYPE_SCM_PLUS:
-                    {
-                        /*printf("SCM+ Msg. Offset: %u Pre: 0x%02x%02x\r\n",
-                                hdr->bitOffset, msgData[0], msgData[1]);*/
-                        parseSCMPlusMsg(msgData, hdr->timestamp);
-                    }
-                    break;
-                case AMR_MSG_TYPE_IDM:
-                    {
-                        /*printf("IDM Msg. Offset: %u Pre: 0x%02x%02x%02x%02x\r\n",
-                                hdr->bitOffset, msgData[0], msgData[1],
-                                msgData[2], msgData[3]);*/
-                        parseIDMMsg(msgData, hdr->timestamp);
-                    }
-                    break;
-                default:
-                    {
-                        debug_printf("Unhandled message type: %u\r\n", hdr->type);
-                    }
-                    break;
-            }
-            ringPop(&msgRing, NULL, 0);
+        AmrMsgHeader* hdr = (AmrMsgHeader*)peek;
+        uint8_t* msgData = peek + AMR_MSG_HDR_SIZE;
+
+        if (dec->frameTap) {
+            dec->frameTap(dec, hdr, msgData, size - AMR_MSG_HDR_SIZE);
         }
-        // No message ready
-        else {
+
+        if (hdr->type > AMR_MSG_TYPE_IDM) {
+            debug_printf("Unhandled message type: %u\r\n", hdr->type);
+            ringRelease(&dec->msgRing);
+            continue;
+        }
+
+        if (!(dec->msgMask & AMR_MSG_MASK(hdr->type))) {
+            ++dec->stats.unsubscribed;
+            ringRelease(&dec->msgRing);
+            continue;
+        }
+
+        // Frames that aren't byte aligned carry one extra byte with the
+        // remaining bits. Only injected frames can have an offset, the
+        // capture path always queues them aligned.
+        const AmrFrameLayout * layout = &amrFrameLayouts[hdr->type];
+        uint8_t offset = hdr->bitOffset;
+        if (size - AMR_MSG_HDR_SIZE < (size_t)layout->len + (offset != 0)) {
+            debug_printf("Short msg type %u: %u bytes\r\n", hdr->type, size);
+            ringRelease(&dec->msgRing);
+            continue;
+        }
+
+        // Only shift the bytes covered by the CRC until it passes, which
+        // saves the rest on injected frames that fail it. The first of them
+        // is still needed to shift the bytes in front.
+        uint8_t crcFirst = msgData[layout->crcStart];
+        if (offset != 0) {
+            amrRealign(msgData + layout->crcStart, layout->len - layout->crcStart,
+                    msgData[layout->len], offset);
+        }
+
+        if (!amrIdFilterPass(dec->idFilter, amrFrameMeterId(hdr->type, msgData))) {
+            ++dec->stats.filtered;
+            ringRelease(&dec->msgRing);
+            continue;
+        }
+
+        if (!amrCheckCrc(hdr->type, msgData)) {
+            debug_printf("INVALID CHECKSUM. Msg type %u\r\n", hdr->type);
+            ++dec->stats.crcFail;
+            ringRelease(&dec->msgRing);
+            continue;
+        }
+        ++dec->stats.crcPass;
+
+        if (offset != 0) {
+            amrRealign(msgData, layout->crcStart, crcFirst, offset);
+        }
+
+        if (dec->dedup && amrDedupCheck(dec->dedup, hdr->type,
+                amrFrameMeterId(hdr->type, msgData), msgData, layout->len, hdr->timestamp)) {
+            ++dec->stats.duplicates;
+            ringRelease(&dec->msgRing);
+            continue;
+        }
+
+        *hdrOut = hdr;
+        *dataOut = msgData;
+        return 1;
+    }
+}
+
+static inline void amrTagMsg(AmrTaggedMsg * out, const AmrMsgHeader * hdr, const uint8_t * data) {
+    out->hdr = *hdr;
+    memcpy(out->frame, data, amrFrameLayouts[hdr->type].len);
+    switch (hdr->type) {
+        case AMR_MSG_TYPE_SCM:
+            amrParseScm(data, &out->msg.scm);
             break;
+        case AMR_MSG_TYPE_SCM_PLUS:
+            amrParseScmPlus(data, &out->msg.scmPlus);
+            break;
+        default:
+            amrParseIdm(data, &out->msg.idm);
+            break;
+    }
+}
+
+size_t amrDecoderDrainMsgs(AmrDecoder * dec, AmrTaggedMsg * msgs, size_t maxMsgs) {
+    if (dec == NULL || msgs == NULL) {
+        return 0;
+    }
+
+    size_t cnt = 0;
+    AmrMsgHeader * hdr;
+    uint8_t * msgData;
+    while (cnt < maxMsgs && amrDecoderNextMsg(dec, &hdr, &msgData)) {
+        amrTagMsg(&msgs[cnt++], hdr, msgData);
+        ringRelease(&dec->msgRing);
+    }
+    return cnt;
+}
+
+void amrDecoderProcessMsgs(AmrDecoder * dec) {
+    if (dec == NULL) {
+        return;
+    }
+
+    if (dec->batchCallback) {
+        size_t cnt;
+        do {
+            cnt = amrDecoderDrainMsgs(dec, dec->batchMsgs, dec->batchMax);
+            if (cnt) {
+                dec->batchCallback(dec, dec->batchMsgs, cnt);
+            }
+        } while (cnt == dec->batchMax);
+        return;
+    }
+
+    AmrMsgHeader * hdr;
+    uint8_t * msgData;
+    while (amrDecoderNextMsg(dec, &hdr, &msgData)) {
+        switch (hdr->type) {
+            case AMR_MSG_TYPE_SCM:
+                {
+                    /*printf("SCM Msg. Offset: %u Pre: 0x%02x%02X%02X\r\n",
+                            hdr->bitOffset, msgData[0], msgData[1],
+                            msgData[2] & 0xf8);*/
+                    parseSCMMsg(dec, hdr, msgData);
+                }
+                break;
+            case AMR_MSG_TYPE_SCM_PLUS:
+                {
+                    /*printf("SCM+ Msg. Offset: %u Pre: 0x%02x%02x\r\n",
+                            hdr->bitOffset, msgData[0], msgData[1]);*/
+                    parseSCMPlusMsg(dec, hdr, msgData);
+                }
+                break;
+            case AMR_MSG_TYPE_IDM:
+                {
+                    /*printf("IDM Msg. Offset: %u Pre: 0x%02x%02x%02x%02x\r\n",
+                            hdr->bitOffset, msgData[0], msgData[1],
+                            msgData[2], msgData[3]);*/
+                    parseIDMMsg(dec, hdr, msgData);
+                }
+                break;
+            default:
+                {
+                    debug_printf("Unhandled message type: %u\r\n", hdr->type);
+                }
+                break;
         }
+        ringRelease(&dec->msgRing);
     }
 
     /*
@@ -540,6 +967,10 @@ void amrProcessMsgs() {
     // */
 }
 
+void amrProcessMsgs() {
+    amrDecoderProcessMsgs(&amrDefaultDecoder);
+}
+
 void ICACHE_FLASH_ATTR printIdmMsg(const char * dateStr, const AmrIdmMsg * msg) {
     if (!msg) {
         printf("Error: Invalid IDM message pointer\r\n");
@@ -630,4 +1061,32 @@ void printAmrMsg(const char * dateStr, const void * msg, AMR_MSG_TYPE msgType) {
 
 void registerAmrMsgCallback(void (*callback)(const void * msg, AMR_MSG_TYPE msgType, const uint8_t * data)) {
     amrMsgCallback = callback;
+    amrDefaultUpdateMsgMask();
+}
+
+void registerScmMsgCallback(void (*callback)(const AmrScmMsg * msg)) {
+    amrScmMsgCallback = callback;
+    amrDefaultUpdateMsgMask();
+}
+
+void registerScmPlusMsgCallback(void (*callback)(const AmrScmPlusMsg * msg)) {
+    amrScmPlusMsgCallback = callback;
+    amrDefaultUpdateMsgMask();
+}
+
+void registerIdmMsgCallback(void (*callback)(const AmrIdmMsg * msg)) {
+    amrIdmMsgCallback = callback;
+    amrDefaultUpdateMsgMask();
+}
+
+void registerAmrBatchCallback(void (*callback)(const AmrTaggedMsg * msgs, size_t cnt),
+        AmrTaggedMsg * msgs, size_t maxMsgs) {
+    amrBatchCallback = callback;
+    amrDecoderRegisterBatchCallback(&amrDefaultDecoder,
+            callback ? amrDefaultBatchCallback : NULL, msgs, maxMsgs);
+    amrDefaultUpdateMsgMask();
+}
+
+size_t amrDrainMsgs(AmrTaggedMsg * msgs, size_t maxMsgs) {
+    return amrDecoderDrainMsgs(&amrDefaultDecoder, msgs, maxMsgs);
 }
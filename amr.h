@@ -2,14 +2,20 @@
 #define AMR_LIB_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include "ring/ringbuf.h"
+#include "amr_filter.h"
+#include "amr_dedup.h"
 #include <stdio.h>
 
 #define AMR_MSG_SCM_RAW_SIZE 12
 #define AMR_MSG_SCM_PLUS_RAW_SIZE 16
 #define AMR_MSG_IDM_RAW_SIZE 92
+#define AMR_MSG_IDM_INTERVALS_OFFSET 33 //! Byte of the 9 bit intervals in standard IDM frames
 #define AMR_MAX_MSG_SIZE AMR_MSG_IDM_RAW_SIZE
 #define AMR_MSG_HDR_SIZE sizeof(AmrMsgHeader)
+#define AMR_MAX_CAPTURES 4 //! Concurrent frame captures per Manchester phase
+#define AMR_DECODER_RING_SIZE 512 //! Bytes of decoded frames queued per decoder
 
 #define debug_printf(fmt, ...) \
     do { if (AMR_DEBUG) printf("%s:%d:%s(): " fmt, __FILE__, \
@@ -22,6 +28,10 @@ typedef enum  {
     AMR_MSG_TYPE_IDM18
 } AMR_MSG_TYPE;
 
+#define AMR_MSG_MASK(type) (1u << (type)) //! Subscription mask bit of an AMR_MSG_TYPE
+#define AMR_MSG_MASK_ALL (AMR_MSG_MASK(AMR_MSG_TYPE_SCM) | \
+        AMR_MSG_MASK(AMR_MSG_TYPE_SCM_PLUS) | AMR_MSG_MASK(AMR_MSG_TYPE_IDM))
+
 #pragma pack(push, 1)
 typedef struct {
     uint32_t id;
@@ -80,18 +90,164 @@ typedef struct {
 
 typedef struct {
     AMR_MSG_TYPE type;
-    uint32_t timestamp;
-    uint8_t bitOffset;
+    uint32_t timestamp; //! Decoder chip count when the frame completed
+    uint8_t bitOffset; //! 0 for captures, injected frames may be shifted by 1-7 bits
 } AmrMsgHeader;
 #pragma pack(pop)
 
+typedef struct {
+    uint16_t bitCnt; //! Frame bits received so far
+    uint16_t bitLen; //! Frame length in bits
+    uint8_t type; //! AMR_MSG_TYPE of the frame
+    uint16_t crc; //! Running CRC of the frame bytes received so far
+    uint8_t buf[AMR_MAX_MSG_SIZE]; //! Frame data
+} AmrCapture;
+
+typedef struct {
+    uint64_t shiftReg; //! Last 64 Manchester decoded bits, newest bit in the LSB
+    uint8_t activeCaptures; //! Bitmask of in-progress entries in captures
+    AmrCapture captures[AMR_MAX_CAPTURES];
+} AmrPhase;
+
+typedef struct {
+    uint32_t preambles; //! Preamble hits, each one starts a frame capture
+    uint32_t crcPass;
+    uint32_t crcFail;
+    uint32_t dropped; //! Frames lost to a full ring or no free capture slot
+    uint32_t unsubscribed; //! Frames released unchecked because their type is masked out
+    uint32_t filtered; //! Frames released unchecked because their meter ID was filtered
+    uint32_t duplicates; //! Valid frames suppressed by the dedup cache
+} AmrDecoderStats;
+
+// A decoded message with its header and raw frame, for batch delivery
+typedef struct {
+    AmrMsgHeader hdr;
+    union {
+        AmrScmMsg scm;
+        AmrScmPlusMsg scmPlus;
+        AmrIdmMsg idm;
+    } msg; //! Selected by hdr.type
+    uint8_t frame[AMR_MAX_MSG_SIZE]; //! Byte aligned frame, the first len bytes are valid
+} AmrTaggedMsg;
+
+typedef struct AmrDecoder AmrDecoder;
+
+typedef void (*AmrDecoderMsgCallback)(AmrDecoder * dec, const AmrMsgHeader * hdr,
+        const void * msg, const uint8_t * data);
+typedef void (*AmrDecoderBatchCallback)(AmrDecoder * dec, const AmrTaggedMsg * msgs, size_t cnt);
+// Raw frame as queued by the bit decoder: len bytes, not realigned to
+// hdr->bitOffset and not CRC checked
+typedef void (*AmrDecoderFrameTap)(AmrDecoder * dec, const AmrMsgHeader * hdr,
+        const uint8_t * frame, size_t len);
+
+// Complete state of one bitstream decoder. Decoders are independent of each
+// other, but each one must only be fed from a single producer and drained
+// from a single consumer. msgRing points into the struct, so don't copy or
+// move a decoder after amrDecoderInit.
+struct AmrDecoder {
+    AmrPhase phases[2]; //! Decoder state for both Manchester alignments
+    uint8_t phaseIdx; //! Phase the next received bit belongs to
+    uint8_t prevRxBit;
+    uint32_t chipCnt; //! Chips received, wraps around
+    uint8_t earlyCrc; //! Drop frames failing their CRC before they reach msgRing
+    uint8_t msgMask; //! AMR_MSG_MASK bits of the types delivered
+    uint8_t preambleMask; //! AMR_MSG_MASK bits of the preambles compared
+    const AmrIdFilter * idFilter; //! Meter ID filter, NULL passes every meter
+    AmrDedup * dedup; //! Duplicate suppression, NULL delivers every copy
+    AmrDecoderFrameTap frameTap; //! Sees every frame taken from msgRing
+    void * frameTapUser;
+    AmrDecoderStats stats;
+    Ring msgRing;
+    uint8_t msgRingData[AMR_DECODER_RING_SIZE];
+    AmrScmMsg scmMsg;
+    AmrScmPlusMsg scmPlusMsg;
+    AmrIdmMsg idmMsg;
+    AmrDecoderMsgCallback msgCallback;
+    AmrDecoderBatchCallback batchCallback; //! Replaces msgCallback when set
+    AmrTaggedMsg * batchMsgs; //! Caller array batches are collected in
+    size_t batchMax;
+    void * user; //! Passed through untouched for the callbacks
+};
+
+// Decode a byte aligned frame that passed its CRC into out. These only read
+// frame and write out, so they are safe to call from any thread. Return 0 when
+// frame or out is NULL.
+uint8_t amrParseScm(const uint8_t * frame, AmrScmMsg * out);
+uint8_t amrParseScmPlus(const uint8_t * frame, AmrScmPlusMsg * out);
+uint8_t amrParseIdm(const uint8_t * frame, AmrIdmMsg * out);
+
+void amrDecoderInit(AmrDecoder * dec);
+// Process nbits chips packed MSB first
+void amrDecoderProcessBits(AmrDecoder * dec, const uint8_t * packed, size_t nbits);
+void amrDecoderProcessMsgs(AmrDecoder * dec);
+void amrDecoderRegisterMsgCallback(AmrDecoder * dec, AmrDecoderMsgCallback callback, void * user);
+// Deliver messages in batches instead of one msgCallback per message.
+// amrDecoderProcessMsgs collects up to maxMsgs messages in msgs and calls
+// callback each time the array fills and once more for the remainder. Pass a
+// NULL callback to go back to per message delivery.
+void amrDecoderRegisterBatchCallback(AmrDecoder * dec, AmrDecoderBatchCallback callback,
+        AmrTaggedMsg * msgs, size_t maxMsgs);
+// Drain up to maxMsgs valid messages into msgs without calling any callback.
+// Returns the number written, less than maxMsgs once the ring is empty.
+size_t amrDecoderDrainMsgs(AmrDecoder * dec, AmrTaggedMsg * msgs, size_t maxMsgs);
+// Check each frame's CRC as its bits arrive and only queue frames that pass,
+// which keeps noise out of msgRing. Off after amrDecoderInit.
+void amrDecoderSetEarlyCrc(AmrDecoder * dec, uint8_t enable);
+// Only deliver the message types in mask. Frames of other types are released
+// from msgRing before realignment and CRC. With filterPreambles their
+// preambles aren't compared either, so they never start a capture. All types
+// are delivered after amrDecoderInit.
+void amrDecoderSetMsgMask(AmrDecoder * dec, uint8_t mask, uint8_t filterPreambles);
+// Drop frames from meters that don't pass filter. The meter ID is checked as
+// soon as it is byte aligned, before the CRC and before the frame is parsed.
+// The filter isn't copied and must outlive its use, NULL removes it.
+void amrDecoderSetIdFilter(AmrDecoder * dec, const AmrIdFilter * filter);
+// Suppress copies of a frame that passed its CRC within the dedup window,
+// before they are parsed. Timestamps are the decoder's chip count, so the
+// window is in chips. The cache is updated from amrDecoderProcessMsgs and
+// must not be shared between decoders drained on different threads. NULL
+// removes it.
+void amrDecoderSetDedup(AmrDecoder * dec, AmrDedup * dedup);
+// Call tap with every frame amrDecoderProcessMsgs takes from msgRing, before
+// any check, e.g. to record them. NULL removes it.
+void amrDecoderSetFrameTap(AmrDecoder * dec, AmrDecoderFrameTap tap, void * user);
+// Queue a raw frame as if the bit decoder had captured it, e.g. to replay a
+// recording. Producer side, don't mix with amrDecoderProcessBits from another
+// thread. Returns 0 when msgRing is full or len is invalid.
+uint8_t amrDecoderInjectFrame(AmrDecoder * dec, const AmrMsgHeader * hdr,
+        const uint8_t * frame, size_t len);
+
+// Global API backed by a default decoder instance
 void amrInit();
+// The default decoder, for the amrDecoder* functions
+AmrDecoder * amrGetDecoder();
 void amrEnable(uint8_t enable);
 uint8_t amrRunning();
-static void amrProcessRxBit(uint8_t rxBit);
+// See amrDecoderSetEarlyCrc. Call after amrInit.
+void amrSetEarlyCrc(uint8_t enable);
+// Once a typed callback is registered, the default decoder only delivers
+// message types that have a callback: any type for registerAmrMsgCallback and
+// registerAmrBatchCallback, one type each for registerScmMsgCallback,
+// registerScmPlusMsgCallback and registerIdmMsgCallback. Without typed
+// callbacks every type is delivered, e.g. to amrDrainMsgs. With the preamble
+// filter enabled it doesn't look for the preambles of the other types either.
+// Call after amrInit.
+void amrSetPreambleFilter(uint8_t enable);
+// See amrDecoderSetIdFilter. Call after amrInit.
+void amrSetIdFilter(const AmrIdFilter * filter);
+// See amrDecoderSetDedup. Call after amrInit.
+void amrSetDedup(AmrDedup * dedup);
+// Process nbits chips packed MSB first. Produces the same messages as calling
+// amrProcessRxBit, the static inline per chip entry point in amr.c, for
+// every chip.
+void amrProcessRxBits(const uint8_t * packed, size_t nbits);
 void amrProcessMsgs();
 void printAmrMsg(const char* dateStr, const void * msg, AMR_MSG_TYPE msgType);
 void registerAmrMsgCallback(void (*callback)(const void * msg, AMR_MSG_TYPE msgType, const uint8_t * data));
+// See amrDecoderRegisterBatchCallback and amrDecoderDrainMsgs. Call after amrInit.
+void registerAmrBatchCallback(void (*callback)(const AmrTaggedMsg * msgs, size_t cnt),
+        AmrTaggedMsg * msgs, size_t maxMsgs);
+size_t amrDrainMsgs(AmrTaggedMsg * msgs, size_t maxMsgs);
 
 void printScmMsg(const char* dateStr, const AmrScmMsg * msg);
 void printScmPlusMsg(const char * dateStr, const AmrScmPlusMsg * msg);
@@ -0,0 +1,198 @@
+#include "amr_crc.h"
+#include "amr_crc_tables.h"
+#include <string.h>
+
+// The fold kernel moves 64-bit lanes in and out of general registers, which
+// only x86-64 can do. 32-bit x86 uses slicing.
+#if defined(__x86_64__)
+#define AMR_CRC_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRYPTO)
+#define AMR_CRC_PMULL 1
+#include <arm_neon.h>
+#endif
+
+typedef uint16_t (*AmrCrcKernel)(AMR_CRC poly, uint16_t crc, const uint8_t * data, size_t len);
+
+static uint16_t crcTable(AMR_CRC poly, uint16_t crc, const uint8_t * data, size_t len) {
+    const uint16_t * t = amrCrcTables[poly][0];
+    size_t i = 0;
+    for (; i < len; i++) {
+        crc = (uint16_t)(crc << 8) ^ t[(crc >> 8) ^ data[i]];
+    }
+    return crc;
+}
+
+// The register is xored into the first two bytes of each block, every byte
+// then goes through the table for its distance from the end of the block.
+static uint16_t crcSlice4(AMR_CRC poly, uint16_t crc, const uint8_t * data, size_t len) {
+    const uint16_t (*t)[256] = amrCrcTables[poly];
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        crc = t[3][(crc >> 8) ^ data[i]] ^ t[2][(crc & 0xff) ^ data[i+1]] ^
+                t[1][data[i+2]] ^ t[0][data[i+3]];
+    }
+    return crcTable(poly, crc, data + i, len - i);
+}
+
+static uint16_t crcSlice8(AMR_CRC poly, uint16_t crc, const uint8_t * data, size_t len) {
+    const uint16_t (*t)[256] = amrCrcTables[poly];
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        crc = t[7][(crc >> 8) ^ data[i]] ^ t[6][(crc & 0xff) ^ data[i+1]] ^
+                t[5][data[i+2]] ^ t[4][data[i+3]] ^ t[3][data[i+4]] ^
+                t[2][data[i+5]] ^ t[1][data[i+6]] ^ t[0][data[i+7]];
+    }
+    return crcSlice4(poly, crc, data + i, len - i);
+}
+
+// The folding kernels treat the input as a polynomial A over GF(2), register
+// included, and keep a 128-bit value congruent to A mod P. Each 16-byte block
+// folds the accumulator forward with t^128 and t^192 mod P. At the end it is
+// folded down to 64 bits and A * t^16 mod P taken with a Barrett reduction.
+#ifdef AMR_CRC_X86
+__attribute__((target("pclmul,sse4.1")))
+static inline uint64_t crcClmul64(uint64_t a, uint64_t b) {
+    return (uint64_t)_mm_cvtsi128_si64(_mm_clmulepi64_si128(
+            _mm_cvtsi64_si128((long long)a), _mm_cvtsi64_si128((long long)b), 0x00));
+}
+
+__attribute__((target("pclmul,sse4.1")))
+static uint16_t crcClmul(AMR_CRC poly, uint16_t crc, const uint8_t * data, size_t len) {
+    if (len < 16) {
+        return crcSlice8(poly, crc, data, len);
+    }
+
+    const AmrCrcFold * f = &amrCrcFolds[poly];
+    const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m128i k = _mm_set_epi64x((long long)f->k192, (long long)f->k128);
+    __m128i acc = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)data), bswap);
+    acc = _mm_xor_si128(acc, _mm_set_epi64x((long long)((uint64_t)crc << 48), 0));
+    size_t i = 16;
+    for (; i + 16 <= len; i += 16) {
+        __m128i w = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + i)), bswap);
+        acc = _mm_xor_si128(w, _mm_xor_si128(
+                _mm_clmulepi64_si128(acc, k, 0x11), _mm_clmulepi64_si128(acc, k, 0x00)));
+    }
+
+    uint64_t hi = (uint64_t)_mm_extract_epi64(acc, 1);
+    uint64_t v = (uint64_t)_mm_cvtsi128_si64(acc) ^
+            crcClmul64(hi >> 32, f->k96) ^ crcClmul64(hi & 0xffffffff, f->k64);
+    __m128i qv = _mm_clmulepi64_si128(_mm_cvtsi64_si128((long long)v),
+            _mm_cvtsi64_si128((long long)f->mu), 0x00);
+    uint64_t q = (uint64_t)_mm_extract_epi64(qv, 1) ^ v;
+    crc = (uint16_t)crcClmul64(q, f->poly);
+    return crcSlice8(poly, crc, data + i, len - i);
+}
+#endif
+
+#ifdef AMR_CRC_PMULL
+static inline uint64x2_t crcPmull(uint64_t a, uint64_t b) {
+    return vreinterpretq_u64_p128(vmull_p64((poly64_t)a, (poly64_t)b));
+}
+
+// Lane 0 holds the low 64 bits of the polynomial, lane 1 the high
+static inline uint64x2_t crcPmullLoad(const uint8_t * data) {
+    uint64x2_t w = vreinterpretq_u64_u8(vrev64q_u8(vld1q_u8(data)));
+    return vextq_u64(w, w, 1);
+}
+
+static uint16_t crcClmul(AMR_CRC poly, uint16_t crc, const uint8_t * data, size_t len) {
+    if (len < 16) {
+        return crcSlice8(poly, crc, data, len);
+    }
+
+    const AmrCrcFold * f = &amrCrcFolds[poly];
+    uint64x2_t acc = veorq_u64(crcPmullLoad(data),
+            vcombine_u64(vcreate_u64(0), vcreate_u64((uint64_t)crc << 48)));
+    size_t i = 16;
+    for (; i + 16 <= len; i += 16) {
+        acc = veorq_u64(crcPmullLoad(data + i), veorq_u64(
+                crcPmull(vgetq_lane_u64(acc, 1), f->k192),
+                crcPmull(vgetq_lane_u64(acc, 0), f->k128)));
+    }
+
+    uint64_t hi = vgetq_lane_u64(acc, 1);
+    uint64_t v = vgetq_lane_u64(acc, 0) ^
+            vgetq_lane_u64(crcPmull(hi >> 32, f->k96), 0) ^
+            vgetq_lane_u64(crcPmull(hi & 0xffffffff, f->k64), 0);
+    uint64_t q = vgetq_lane_u64(crcPmull(v, f->mu), 1) ^ v;
+    crc = (uint16_t)vgetq_lane_u64(crcPmull(q, f->poly), 0);
+    return crcSlice8(poly, crc, data + i, len - i);
+}
+#endif
+
+static const AmrCrcKernel crcKernels[AMR_CRC_IMPL_CNT] = {
+    crcTable,
+    crcSlice4,
+    crcSlice8,
+#if defined(AMR_CRC_X86) || defined(AMR_CRC_PMULL)
+    crcClmul,
+#else
+    NULL,
+#endif
+};
+
+static const char * const crcImplNames[AMR_CRC_IMPL_CNT] = {
+    "table", "slice4", "slice8", "clmul"};
+
+static AMR_CRC_IMPL crcImpl = AMR_CRC_IMPL_CNT; //! Unselected until first use
+
+uint8_t amrCrcImplSupported(AMR_CRC_IMPL impl) {
+    if (impl >= AMR_CRC_IMPL_CNT || crcKernels[impl] == NULL) {
+        return 0;
+    }
+
+#ifdef AMR_CRC_X86
+    if (impl == AMR_CRC_IMPL_CLMUL) {
+        return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+    }
+#endif
+    return 1;
+}
+
+// Selected with relaxed atomics like the Manchester kernel, engine workers
+// may get here first at the same time
+AMR_CRC_IMPL amrCrcImpl() {
+    AMR_CRC_IMPL impl = __atomic_load_n(&crcImpl, __ATOMIC_RELAXED);
+    if (impl == AMR_CRC_IMPL_CNT) {
+        // Preference order, fastest first
+        static const AMR_CRC_IMPL order[] = {
+            AMR_CRC_IMPL_CLMUL, AMR_CRC_IMPL_SLICE8, AMR_CRC_IMPL_SLICE4,
+            AMR_CRC_IMPL_TABLE};
+        size_t i = 0;
+        for (; i < sizeof(order)/sizeof(order[0]); ++i) {
+            if (amrCrcImplSupported(order[i])) {
+                impl = order[i];
+                break;
+            }
+        }
+        __atomic_store_n(&crcImpl, impl, __ATOMIC_RELAXED);
+    }
+    return impl;
+}
+
+uint8_t amrCrcSelectImpl(AMR_CRC_IMPL impl) {
+    if (!amrCrcImplSupported(impl)) {
+        return 0;
+    }
+    __atomic_store_n(&crcImpl, impl, __ATOMIC_RELAXED);
+    return 1;
+}
+
+const char * amrCrcImplName(AMR_CRC_IMPL impl) {
+    return impl < AMR_CRC_IMPL_CNT ? crcImplNames[impl] : "unknown";
+}
+
+const uint16_t * amrCrcTable(AMR_CRC poly) {
+    return poly < AMR_CRC_CNT ? amrCrcTables[poly][0] : NULL;
+}
+
+uint16_t amrCrc16(AMR_CRC poly, uint16_t crc, const uint8_t * data, size_t len) {
+    if (data == NULL || poly >= AMR_CRC_CNT) {
+        return crc;
+    }
+    return crcKernels[amrCrcImpl()](poly, crc, data, len);
+}
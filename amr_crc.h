@@ -0,0 +1,42 @@
+#ifndef AMR_CRC_H
+#define AMR_CRC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// CRC-16 polynomials used by ERT frames, MSB first without reflection
+typedef enum {
+    AMR_CRC_BCH = 0, //! 0x6f63, SCM
+    AMR_CRC_CCITT, //! 0x1021, SCM+ and IDM
+    AMR_CRC_CNT
+} AMR_CRC;
+
+typedef enum {
+    AMR_CRC_IMPL_TABLE = 0,
+    AMR_CRC_IMPL_SLICE4,
+    AMR_CRC_IMPL_SLICE8,
+    AMR_CRC_IMPL_CLMUL, //! PCLMULQDQ on x86, PMULL on ARMv8
+    AMR_CRC_IMPL_CNT
+} AMR_CRC_IMPL;
+
+// Feed len bytes into the CRC register crc and return the new register. The
+// caller seeds crc with the init value and compares the result against the
+// residual, so every kernel gives the same answer as a byte table walk.
+uint16_t amrCrc16(AMR_CRC poly, uint16_t crc, const uint8_t * data, size_t len);
+
+// Slicing tables generated from amr_crc.hpp, amrCrcTables[poly][0] is the
+// byte at a time table
+extern const uint16_t amrCrcTables[AMR_CRC_CNT][8][256];
+
+// Byte at a time table for poly, for callers updating a CRC incrementally
+const uint16_t * amrCrcTable(AMR_CRC poly);
+
+// Kernel used by amrCrc16. The fastest supported one is picked from CPUID on
+// first use.
+AMR_CRC_IMPL amrCrcImpl();
+uint8_t amrCrcImplSupported(AMR_CRC_IMPL impl);
+// Force a kernel, returns 0 when it isn't supported on this CPU
+uint8_t amrCrcSelectImpl(AMR_CRC_IMPL impl);
+const char * amrCrcImplName(AMR_CRC_IMPL impl);
+
+#endif
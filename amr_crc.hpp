@@ -0,0 +1,123 @@
+#ifndef AMR_CRC_HPP
+#define AMR_CRC_HPP
+
+// Header-only CRC parameterized on polynomial, width, init and residual, MSB
+// first without reflection. The byte and slicing tables are built by the
+// compiler, so C++ callers get inlined kernels with no table setup. The C
+// build gets the same tables through tools/crcgen, which prints them into
+// amr_crc_tables.h.
+
+#include <stddef.h>
+#include <stdint.h>
+
+template <typename T, unsigned Width, T Poly, T Init, T Residual, unsigned Slices = 8>
+struct AmrCrcSpec {
+    static_assert(Width % 8 == 0 && Width >= 8 && Width <= 8 * sizeof(T) && Width <= 32,
+            "width must be a whole number of bytes that fits T");
+    static_assert(Slices * 8 >= Width && Slices <= 8, "slices must cover the register");
+
+    typedef T Reg;
+    static constexpr unsigned width = Width;
+    static constexpr unsigned slices = Slices;
+    static constexpr T poly = Poly;
+    static constexpr T init = Init;
+    static constexpr T residual = Residual;
+    static constexpr T mask = (T)(((uint64_t)1 << Width) - 1);
+
+    struct Tables {
+        T t[Slices][256]; //! t[k][b] is the register after byte b and k zero bytes
+    };
+
+    static constexpr Tables makeTables() {
+        Tables tab = {};
+        for (unsigned b = 0; b < 256; b++) {
+            T crc = (T)(b << (Width - 8));
+            for (unsigned bit = 0; bit < 8; bit++) {
+                crc = (crc >> (Width - 1)) & 1 ? (T)((crc << 1) ^ Poly) : (T)(crc << 1);
+            }
+            tab.t[0][b] = (T)(crc & mask);
+        }
+        for (unsigned k = 1; k < Slices; k++) {
+            for (unsigned b = 0; b < 256; b++) {
+                T prev = tab.t[k-1][b];
+                tab.t[k][b] = (T)(((prev << 8) & mask) ^ tab.t[0][prev >> (Width - 8)]);
+            }
+        }
+        return tab;
+    }
+
+    static constexpr Tables tables = makeTables();
+
+    static constexpr T byte(T crc, uint8_t b) {
+        return (T)(((crc << 8) & mask) ^ tables.t[0][((crc >> (Width - 8)) ^ b) & 0xff]);
+    }
+
+    // Feed len bytes into the register, Slices at a time
+    static constexpr T update(T crc, const uint8_t * data, size_t len) {
+        size_t i = 0;
+        for (; i + Slices <= len; i += Slices) {
+            T next = 0;
+            for (unsigned j = 0; j < Slices; j++) {
+                uint8_t b = data[i + j];
+                if (j < Width / 8) {
+                    b ^= (uint8_t)(crc >> (Width - 8 * (j + 1)));
+                }
+                next ^= tables.t[Slices - 1 - j][b];
+            }
+            crc = next;
+        }
+        for (; i < len; i++) {
+            crc = byte(crc, data[i]);
+        }
+        return crc;
+    }
+
+    static constexpr T compute(const uint8_t * data, size_t len) {
+        return update(Init, data, len);
+    }
+
+    // True when data, trailing CRC included, leaves the residual
+    static constexpr bool check(const uint8_t * data, size_t len) {
+        return compute(data, len) == Residual;
+    }
+
+    // t^n mod P, the folding constants for carry-less multiply kernels
+    static constexpr uint64_t powMod(unsigned n) {
+        uint64_t r = 1;
+        for (; n; n--) {
+            r <<= 1;
+            if ((r >> Width) & 1) {
+                r ^= ((uint64_t)1 << Width) | Poly;
+            }
+        }
+        return r;
+    }
+
+    // floor(t^(64+Width) / P) without its t^64 term, for Barrett reduction
+    static constexpr uint64_t barrettMu() {
+        uint64_t r = 0, q = 0;
+        for (int i = 64 + Width; i >= 0; i--) {
+            r = (r << 1) | (i == 64 + (int)Width);
+            if ((r >> Width) & 1) {
+                r ^= ((uint64_t)1 << Width) | Poly;
+                if (i < 64) {
+                    q |= (uint64_t)1 << i;
+                }
+            }
+        }
+        return q;
+    }
+};
+
+template <typename T, unsigned Width, T Poly, T Init, T Residual, unsigned Slices>
+constexpr typename AmrCrcSpec<T, Width, Poly, Init, Residual, Slices>::Tables
+        AmrCrcSpec<T, Width, Poly, Init, Residual, Slices>::tables;
+
+typedef AmrCrcSpec<uint16_t, 16, 0x6f63, 0x0000, 0x0000> AmrCrcScm; //! BCH
+typedef AmrCrcSpec<uint16_t, 16, 0x1021, 0xffff, 0x1D0F> AmrCrcScmPlus; //! CCITT
+typedef AmrCrcScmPlus AmrCrcIdm;
+// IDM framing with ERT type 18 and NetIDM carry the same CCITT CRC
+typedef AmrCrcIdm AmrCrcIdm18;
+typedef AmrCrcIdm AmrCrcNetIdm;
+
+#endif
@@ -0,0 +1,475 @@
+// Generated by tools/crcgen from amr_crc.hpp, do not edit
+#ifndef AMR_CRC_TABLES_H
+#define AMR_CRC_TABLES_H
+
+#include "amr_crc.h"
+
+// amrCrcTables[poly][k][b] is the register after byte b followed by k zero bytes
+const uint16_t amrCrcTables[AMR_CRC_CNT][8][256] = {
+    { // AMR_CRC_BCH
+        {
+            0x0000,0x6f63,0xdec6,0xb1a5,0xd2ef,0xbd8c,0x0c29,0x634a,0xcabd,0xa5de,
+            0x147b,0x7b18,0x1852,0x7731,0xc694,0xa9f7,0xfa19,0x957a,0x24df,0x4bbc,
+            0x28f6,0x4795,0xf630,0x9953,0x30a4,0x5fc7,0xee62,0x8101,0xe24b,0x8d28,
+            0x3c8d,0x53ee,0x9b51,0xf432,0x4597,0x2af4,0x49be,0x26dd,0x9778,0xf81b,
+            0x51ec,0x3e8f,0x8f2a,0xe049,0x8303,0xec60,0x5dc5,0x32a6,0x6148,0x0e2b,
+            0xbf8e,0xd0ed,0xb3a7,0xdcc4,0x6d61,0x0202,0xabf5,0xc496,0x7533,0x1a50,
+            0x791a,0x1679,0xa7dc,0xc8bf,0x59c1,0x36a2,0x8707,0xe864,0x8b2e,0xe44d,
+            0x55e8,0x3a8b,0x937c,0xfc1f,0x4dba,0x22d9,0x4193,0x2ef0,0x9f55,0xf036,
+            0xa3d8,0xccbb,0x7d1e,0x127d,0x7137,0x1e54,0xaff1,0xc092,0x6965,0x0606,
+            0xb7a3,0xd8c0,0xbb8a,0xd4e9,0x654c,0x0a2f,0xc290,0xadf3,0x1c56,0x7335,
+            0x107f,0x7f1c,0xceb9,0xa1da,0x082d,0x674e,0xd6eb,0xb988,0xdac2,0xb5a1,
+            0x0404,0x6b67,0x3889,0x57ea,0xe64f,0x892c,0xea66,0x8505,0x34a0,0x5bc3,
+            0xf234,0x9d57,0x2cf2,0x4391,0x20db,0x4fb8,0xfe1d,0x917e,0xb382,0xdce1,
+            0x6d44,0x0227,0x616d,0x0e0e,0xbfab,0xd0c8,0x793f,0x165c,0xa7f9,0xc89a,
+            0xabd0,0xc4b3,0x7516,0x1a75,0x499b,0x26f8,0x975d,0xf83e,0x9b74,0xf417,
+            0x45b2,0x2ad1,0x8326,0xec45,0x5de0,0x3283,0x51c9,0x3eaa,0x8f0f,0xe06c,
+            0x28d3,0x47b0,0xf615,0x9976,0xfa3c,0x955f,0x24fa,0x4b99,0xe26e,0x8d0d,
+            0x3ca8,0x53cb,0x3081,0x5fe2,0xee47,0x8124,0xd2ca,0xbda9,0x0c0c,0x636f,
+            0x0025,0x6f46,0xdee3,0xb180,0x1877,0x7714,0xc6b1,0xa9d2,0xca98,0xa5fb,
+            0x145e,0x7b3d,0xea43,0x8520,0x3485,0x5be6,0x38ac,0x57cf,0xe66a,0x8909,
+            0x20fe,0x4f9d,0xfe38,0x915b,0xf211,0x9d72,0x2cd7,0x43b4,0x105a,0x7f39,
+            0xce9c,0xa1ff,0xc2b5,0xadd6,0x1c73,0x7310,0xdae7,0xb584,0x0421,0x6b42,
+            0x0808,0x676b,0xd6ce,0xb9ad,0x7112,0x1e71,0xafd4,0xc0b7,0xa3fd,0xcc9e,
+            0x7d3b,0x1258,0xbbaf,0xd4cc,0x6569,0x0a0a,0x6940,0x0623,0xb786,0xd8e5,
+            0x8b0b,0xe468,0x55cd,0x3aae,0x59e4,0x3687,0x8722,0xe841,0x41b6,0x2ed5,
+            0x9f70,0xf013,0x9359,0xfc3a,0x4d9f,0x22fc,
+        },
+        {
+            0x0000,0x0867,0x10ce,0x18a9,0x219c,0x29fb,0x3152,0x3935,0x4338,0x4b5f,
+            0x53f6,0x5b91,0x62a4,0x6ac3,0x726a,0x7a0d,0x8670,0x8e17,0x96be,0x9ed9,
+            0xa7ec,0xaf8b,0xb722,0xbf45,0xc548,0xcd2f,0xd586,0xdde1,0xe4d4,0xecb3,
+            0xf41a,0xfc7d,0x6383,0x6be4,0x734d,0x7b2a,0x421f,0x4a78,0x52d1,0x5ab6,
+            0x20bb,0x28dc,0x3075,0x3812,0x0127,0x0940,0x11e9,0x198e,0xe5f3,0xed94,
+            0xf53d,0xfd5a,0xc46f,0xcc08,0xd4a1,0xdcc6,0xa6cb,0xaeac,0xb605,0xbe62,
+            0x8757,0x8f30,0x9799,0x9ffe,0xc706,0xcf61,0xd7c8,0xdfaf,0xe69a,0xeefd,
+            0xf654,0xfe33,0x843e,0x8c59,0x94f0,0x9c97,0xa5a2,0xadc5,0xb56c,0xbd0b,
+            0x4176,0x4911,0x51b8,0x59df,0x60ea,0x688d,0x7024,0x7843,0x024e,0x0a29,
+            0x1280,0x1ae7,0x23d2,0x2bb5,0x331c,0x3b7b,0xa485,0xace2,0xb44b,0xbc2c,
+            0x8519,0x8d7e,0x95d7,0x9db0,0xe7bd,0xefda,0xf773,0xff14,0xc621,0xce46,
+            0xd6ef,0xde88,0x22f5,0x2a92,0x323b,0x3a5c,0x0369,0x0b0e,0x13a7,0x1bc0,
+            0x61cd,0x69aa,0x7103,0x7964,0x4051,0x4836,0x509f,0x58f8,0xe16f,0xe908,
+            0xf1a1,0xf9c6,0xc0f3,0xc894,0xd03d,0xd85a,0xa257,0xaa30,0xb299,0xbafe,
+            0x83cb,0x8bac,0x9305,0x9b62,0x671f,0x6f78,0x77d1,0x7fb6,0x4683,0x4ee4,
+            0x564d,0x5e2a,0x2427,0x2c40,0x34e9,0x3c8e,0x05bb,0x0ddc,0x1575,0x1d12,
+            0x82ec,0x8a8b,0x9222,0x9a45,0xa370,0xab17,0xb3be,0xbbd9,0xc1d4,0xc9b3,
+            0xd11a,0xd97d,0xe048,0xe82f,0xf086,0xf8e1,0x049c,0x0cfb,0x1452,0x1c35,
+            0x2500,0x2d67,0x35ce,0x3da9,0x47a4,0x4fc3,0x576a,0x5f0d,0x6638,0x6e5f,
+            0x76f6,0x7e91,0x2669,0x2e0e,0x36a7,0x3ec0,0x07f5,0x0f92,0x173b,0x1f5c,
+            0x6551,0x6d36,0x759f,0x7df8,0x44cd,0x4caa,0x5403,0x5c64,0xa019,0xa87e,
+            0xb0d7,0xb8b0,0x8185,0x89e2,0x914b,0x992c,0xe321,0xeb46,0xf3ef,0xfb88,
+            0xc2bd,0xcada,0xd273,0xda14,0x45ea,0x4d8d,0x5524,0x5d43,0x6476,0x6c11,
+            0x74b8,0x7cdf,0x06d2,0x0eb5,0x161c,0x1e7b,0x274e,0x2f29,0x3780,0x3fe7,
+            0xc39a,0xcbfd,0xd354,0xdb33,0xe206,0xea61,0xf2c8,0xfaaf,0x80a2,0x88c5,
+            0x906c,0x980b,0xa13e,0xa959,0xb1f0,0xb997,
+        },
+        {
+            0x0000,0xadbd,0x3419,0x99a4,0x6832,0xc58f,0x5c2b,0xf196,0xd064,0x7dd9,
+            0xe47d,0x49c0,0xb856,0x15eb,0x8c4f,0x21f2,0xcfab,0x6216,0xfbb2,0x560f,
+            0xa799,0x0a24,0x9380,0x3e3d,0x1fcf,0xb272,0x2bd6,0x866b,0x77fd,0xda40,
+            0x43e4,0xee59,0xf035,0x5d88,0xc42c,0x6991,0x9807,0x35ba,0xac1e,0x01a3,
+            0x2051,0x8dec,0x1448,0xb9f5,0x4863,0xe5de,0x7c7a,0xd1c7,0x3f9e,0x9223,
+            0x0b87,0xa63a,0x57ac,0xfa11,0x63b5,0xce08,0xeffa,0x4247,0xdbe3,0x765e,
+            0x87c8,0x2a75,0xb3d1,0x1e6c,0x8f09,0x22b4,0xbb10,0x16ad,0xe73b,0x4a86,
+            0xd322,0x7e9f,0x5f6d,0xf2d0,0x6b74,0xc6c9,0x375f,0x9ae2,0x0346,0xaefb,
+            0x40a2,0xed1f,0x74bb,0xd906,0x2890,0x852d,0x1c89,0xb134,0x90c6,0x3d7b,
+            0xa4df,0x0962,0xf8f4,0x5549,0xcced,0x6150,0x7f3c,0xd281,0x4b25,0xe698,
+            0x170e,0xbab3,0x2317,0x8eaa,0xaf58,0x02e5,0x9b41,0x36fc,0xc76a,0x6ad7,
+            0xf373,0x5ece,0xb097,0x1d2a,0x848e,0x2933,0xd8a5,0x7518,0xecbc,0x4101,
+            0x60f3,0xcd4e,0x54ea,0xf957,0x08c1,0xa57c,0x3cd8,0x9165,0x7171,0xdccc,
+            0x4568,0xe8d5,0x1943,0xb4fe,0x2d5a,0x80e7,0xa115,0x0ca8,0x950c,0x38b1,
+            0xc927,0x649a,0xfd3e,0x5083,0xbeda,0x1367,0x8ac3,0x277e,0xd6e8,0x7b55,
+            0xe2f1,0x4f4c,0x6ebe,0xc303,0x5aa7,0xf71a,0x068c,0xab31,0x3295,0x9f28,
+            0x8144,0x2cf9,0xb55d,0x18e0,0xe976,0x44cb,0xdd6f,0x70d2,0x5120,0xfc9d,
+            0x6539,0xc884,0x3912,0x94af,0x0d0b,0xa0b6,0x4eef,0xe352,0x7af6,0xd74b,
+            0x26dd,0x8b60,0x12c4,0xbf79,0x9e8b,0x3336,0xaa92,0x072f,0xf6b9,0x5b04,
+            0xc2a0,0x6f1d,0xfe78,0x53c5,0xca61,0x67dc,0x964a,0x3bf7,0xa253,0x0fee,
+            0x2e1c,0x83a1,0x1a05,0xb7b8,0x462e,0xeb93,0x7237,0xdf8a,0x31d3,0x9c6e,
+            0x05ca,0xa877,0x59e1,0xf45c,0x6df8,0xc045,0xe1b7,0x4c0a,0xd5ae,0x7813,
+            0x8985,0x2438,0xbd9c,0x1021,0x0e4d,0xa3f0,0x3a54,0x97e9,0x667f,0xcbc2,
+            0x5266,0xffdb,0xde29,0x7394,0xea30,0x478d,0xb61b,0x1ba6,0x8202,0x2fbf,
+            0xc1e6,0x6c5b,0xf5ff,0x5842,0xa9d4,0x0469,0x9dcd,0x3070,0x1182,0xbc3f,
+            0x259b,0x8826,0x79b0,0xd40d,0x4da9,0xe014,
+        },
+        {
+            0x0000,0xe2e2,0xaaa7,0x4845,0x3a2d,0xd8cf,0x908a,0x7268,0x745a,0x96b8,
+            0xdefd,0x3c1f,0x4e77,0xac95,0xe4d0,0x0632,0xe8b4,0x0a56,0x4213,0xa0f1,
+            0xd299,0x307b,0x783e,0x9adc,0x9cee,0x7e0c,0x3649,0xd4ab,0xa6c3,0x4421,
+            0x0c64,0xee86,0xbe0b,0x5ce9,0x14ac,0xf64e,0x8426,0x66c4,0x2e81,0xcc63,
+            0xca51,0x28b3,0x60f6,0x8214,0xf07c,0x129e,0x5adb,0xb839,0x56bf,0xb45d,
+            0xfc18,0x1efa,0x6c92,0x8e70,0xc635,0x24d7,0x22e5,0xc007,0x8842,0x6aa0,
+            0x18c8,0xfa2a,0xb26f,0x508d,0x1375,0xf197,0xb9d2,0x5b30,0x2958,0xcbba,
+            0x83ff,0x611d,0x672f,0x85cd,0xcd88,0x2f6a,0x5d02,0xbfe0,0xf7a5,0x1547,
+            0xfbc1,0x1923,0x5166,0xb384,0xc1ec,0x230e,0x6b4b,0x89a9,0x8f9b,0x6d79,
+            0x253c,0xc7de,0xb5b6,0x5754,0x1f11,0xfdf3,0xad7e,0x4f9c,0x07d9,0xe53b,
+            0x9753,0x75b1,0x3df4,0xdf16,0xd924,0x3bc6,0x7383,0x9161,0xe309,0x01eb,
+            0x49ae,0xab4c,0x45ca,0xa728,0xef6d,0x0d8f,0x7fe7,0x9d05,0xd540,0x37a2,
+            0x3190,0xd372,0x9b37,0x79d5,0x0bbd,0xe95f,0xa11a,0x43f8,0x26ea,0xc408,
+            0x8c4d,0x6eaf,0x1cc7,0xfe25,0xb660,0x5482,0x52b0,0xb052,0xf817,0x1af5,
+            0x689d,0x8a7f,0xc23a,0x20d8,0xce5e,0x2cbc,0x64f9,0x861b,0xf473,0x1691,
+            0x5ed4,0xbc36,0xba04,0x58e6,0x10a3,0xf241,0x8029,0x62cb,0x2a8e,0xc86c,
+            0x98e1,0x7a03,0x3246,0xd0a4,0xa2cc,0x402e,0x086b,0xea89,0xecbb,0x0e59,
+            0x461c,0xa4fe,0xd696,0x3474,0x7c31,0x9ed3,0x7055,0x92b7,0xdaf2,0x3810,
+            0x4a78,0xa89a,0xe0df,0x023d,0x040f,0xe6ed,0xaea8,0x4c4a,0x3e22,0xdcc0,
+            0x9485,0x7667,0x359f,0xd77d,0x9f38,0x7dda,0x0fb2,0xed50,0xa515,0x47f7,
+            0x41c5,0xa327,0xeb62,0x0980,0x7be8,0x990a,0xd14f,0x33ad,0xdd2b,0x3fc9,
+            0x778c,0x956e,0xe706,0x05e4,0x4da1,0xaf43,0xa971,0x4b93,0x03d6,0xe134,
+            0x935c,0x71be,0x39fb,0xdb19,0x8b94,0x6976,0x2133,0xc3d1,0xb1b9,0x535b,
+            0x1b1e,0xf9fc,0xffce,0x1d2c,0x5569,0xb78b,0xc5e3,0x2701,0x6f44,0x8da6,
+            0x6320,0x81c2,0xc987,0x2b65,0x590d,0xbbef,0xf3aa,0x1148,0x177a,0xf598,
+            0xbddd,0x5f3f,0x2d57,0xcfb5,0x87f0,0x6512,
+        },
+        {
+            0x0000,0x4dd4,0x9ba8,0xd67c,0x5833,0x15e7,0xc39b,0x8e4f,0xb066,0xfdb2,
+            0x2bce,0x661a,0xe855,0xa581,0x73fd,0x3e29,0x0faf,0x427b,0x9407,0xd9d3,
+            0x579c,0x1a48,0xcc34,0x81e0,0xbfc9,0xf21d,0x2461,0x69b5,0xe7fa,0xaa2e,
+            0x7c52,0x3186,0x1f5e,0x528a,0x84f6,0xc922,0x476d,0x0ab9,0xdcc5,0x9111,
+            0xaf38,0xe2ec,0x3490,0x7944,0xf70b,0xbadf,0x6ca3,0x2177,0x10f1,0x5d25,
+            0x8b59,0xc68d,0x48c2,0x0516,0xd36a,0x9ebe,0xa097,0xed43,0x3b3f,0x76eb,
+            0xf8a4,0xb570,0x630c,0x2ed8,0x3ebc,0x7368,0xa514,0xe8c0,0x668f,0x2b5b,
+            0xfd27,0xb0f3,0x8eda,0xc30e,0x1572,0x58a6,0xd6e9,0x9b3d,0x4d41,0x0095,
+            0x3113,0x7cc7,0xaabb,0xe76f,0x6920,0x24f4,0xf288,0xbf5c,0x8175,0xcca1,
+            0x1add,0x5709,0xd946,0x9492,0x42ee,0x0f3a,0x21e2,0x6c36,0xba4a,0xf79e,
+            0x79d1,0x3405,0xe279,0xafad,0x9184,0xdc50,0x0a2c,0x47f8,0xc9b7,0x8463,
+            0x521f,0x1fcb,0x2e4d,0x6399,0xb5e5,0xf831,0x767e,0x3baa,0xedd6,0xa002,
+            0x9e2b,0xd3ff,0x0583,0x4857,0xc618,0x8bcc,0x5db0,0x1064,0x7d78,0x30ac,
+            0xe6d0,0xab04,0x254b,0x689f,0xbee3,0xf337,0xcd1e,0x80ca,0x56b6,0x1b62,
+            0x952d,0xd8f9,0x0e85,0x4351,0x72d7,0x3f03,0xe97f,0xa4ab,0x2ae4,0x6730,
+            0xb14c,0xfc98,0xc2b1,0x8f65,0x5919,0x14cd,0x9a82,0xd756,0x012a,0x4cfe,
+            0x6226,0x2ff2,0xf98e,0xb45a,0x3a15,0x77c1,0xa1bd,0xec69,0xd240,0x9f94,
+            0x49e8,0x043c,0x8a73,0xc7a7,0x11db,0x5c0f,0x6d89,0x205d,0xf621,0xbbf5,
+            0x35ba,0x786e,0xae12,0xe3c6,0xddef,0x903b,0x4647,0x0b93,0x85dc,0xc808,
+            0x1e74,0x53a0,0x43c4,0x0e10,0xd86c,0x95b8,0x1bf7,0x5623,0x805f,0xcd8b,
+            0xf3a2,0xbe76,0x680a,0x25de,0xab91,0xe645,0x3039,0x7ded,0x4c6b,0x01bf,
+            0xd7c3,0x9a17,0x1458,0x598c,0x8ff0,0xc224,0xfc0d,0xb1d9,0x67a5,0x2a71,
+            0xa43e,0xe9ea,0x3f96,0x7242,0x5c9a,0x114e,0xc732,0x8ae6,0x04a9,0x497d,
+            0x9f01,0xd2d5,0xecfc,0xa128,0x7754,0x3a80,0xb4cf,0xf91b,0x2f67,0x62b3,
+            0x5335,0x1ee1,0xc89d,0x8549,0x0b06,0x46d2,0x90ae,0xdd7a,0xe353,0xae87,
+            0x78fb,0x352f,0xbb60,0xf6b4,0x20c8,0x6d1c,
+        },
+        {
+            0x0000,0xfaf0,0x9a83,0x6073,0x5a65,0xa095,0xc0e6,0x3a16,0xb4ca,0x4e3a,
+            0x2e49,0xd4b9,0xeeaf,0x145f,0x742c,0x8edc,0x06f7,0xfc07,0x9c74,0x6684,
+            0x5c92,0xa662,0xc611,0x3ce1,0xb23d,0x48cd,0x28be,0xd24e,0xe858,0x12a8,
+            0x72db,0x882b,0x0dee,0xf71e,0x976d,0x6d9d,0x578b,0xad7b,0xcd08,0x37f8,
+            0xb924,0x43d4,0x23a7,0xd957,0xe341,0x19b1,0x79c2,0x8332,0x0b19,0xf1e9,
+            0x919a,0x6b6a,0x517c,0xab8c,0xcbff,0x310f,0xbfd3,0x4523,0x2550,0xdfa0,
+            0xe5b6,0x1f46,0x7f35,0x85c5,0x1bdc,0xe12c,0x815f,0x7baf,0x41b9,0xbb49,
+            0xdb3a,0x21ca,0xaf16,0x55e6,0x3595,0xcf65,0xf573,0x0f83,0x6ff0,0x9500,
+            0x1d2b,0xe7db,0x87a8,0x7d58,0x474e,0xbdbe,0xddcd,0x273d,0xa9e1,0x5311,
+            0x3362,0xc992,0xf384,0x0974,0x6907,0x93f7,0x1632,0xecc2,0x8cb1,0x7641,
+            0x4c57,0xb6a7,0xd6d4,0x2c24,0xa2f8,0x5808,0x387b,0xc28b,0xf89d,0x026d,
+            0x621e,0x98ee,0x10c5,0xea35,0x8a46,0x70b6,0x4aa0,0xb050,0xd023,0x2ad3,
+            0xa40f,0x5eff,0x3e8c,0xc47c,0xfe6a,0x049a,0x64e9,0x9e19,0x37b8,0xcd48,
+            0xad3b,0x57cb,0x6ddd,0x972d,0xf75e,0x0dae,0x8372,0x7982,0x19f1,0xe301,
+            0xd917,0x23e7,0x4394,0xb964,0x314f,0xcbbf,0xabcc,0x513c,0x6b2a,0x91da,
+            0xf1a9,0x0b59,0x8585,0x7f75,0x1f06,0xe5f6,0xdfe0,0x2510,0x4563,0xbf93,
+            0x3a56,0xc0a6,0xa0d5,0x5a25,0x6033,0x9ac3,0xfab0,0x0040,0x8e9c,0x746c,
+            0x141f,0xeeef,0xd4f9,0x2e09,0x4e7a,0xb48a,0x3ca1,0xc651,0xa622,0x5cd2,
+            0x66c4,0x9c34,0xfc47,0x06b7,0x886b,0x729b,0x12e8,0xe818,0xd20e,0x28fe,
+            0x488d,0xb27d,0x2c64,0xd694,0xb6e7,0x4c17,0x7601,0x8cf1,0xec82,0x1672,
+            0x98ae,0x625e,0x022d,0xf8dd,0xc2cb,0x383b,0x5848,0xa2b8,0x2a93,0xd063,
+            0xb010,0x4ae0,0x70f6,0x8a06,0xea75,0x1085,0x9e59,0x64a9,0x04da,0xfe2a,
+            0xc43c,0x3ecc,0x5ebf,0xa44f,0x218a,0xdb7a,0xbb09,0x41f9,0x7bef,0x811f,
+            0xe16c,0x1b9c,0x9540,0x6fb0,0x0fc3,0xf533,0xcf25,0x35d5,0x55a6,0xaf56,
+            0x277d,0xdd8d,0xbdfe,0x470e,0x7d18,0x87e8,0xe79b,0x1d6b,0x93b7,0x6947,
+            0x0934,0xf3c4,0xc9d2,0x3322,0x5351,0xa9a1,
+        },
+        {
+            0x0000,0x6f70,0xdee0,0xb190,0xd2a3,0xbdd3,0x0c43,0x6333,0xca25,0xa555,
+            0x14c5,0x7bb5,0x1886,0x77f6,0xc666,0xa916,0xfb29,0x9459,0x25c9,0x4ab9,
+            0x298a,0x46fa,0xf76a,0x981a,0x310c,0x5e7c,0xefec,0x809c,0xe3af,0x8cdf,
+            0x3d4f,0x523f,0x9931,0xf641,0x47d1,0x28a1,0x4b92,0x24e2,0x9572,0xfa02,
+            0x5314,0x3c64,0x8df4,0xe284,0x81b7,0xeec7,0x5f57,0x3027,0x6218,0x0d68,
+            0xbcf8,0xd388,0xb0bb,0xdfcb,0x6e5b,0x012b,0xa83d,0xc74d,0x76dd,0x19ad,
+            0x7a9e,0x15ee,0xa47e,0xcb0e,0x5d01,0x3271,0x83e1,0xec91,0x8fa2,0xe0d2,
+            0x5142,0x3e32,0x9724,0xf854,0x49c4,0x26b4,0x4587,0x2af7,0x9b67,0xf417,
+            0xa628,0xc958,0x78c8,0x17b8,0x748b,0x1bfb,0xaa6b,0xc51b,0x6c0d,0x037d,
+            0xb2ed,0xdd9d,0xbeae,0xd1de,0x604e,0x0f3e,0xc430,0xab40,0x1ad0,0x75a0,
+            0x1693,0x79e3,0xc873,0xa703,0x0e15,0x6165,0xd0f5,0xbf85,0xdcb6,0xb3c6,
+            0x0256,0x6d26,0x3f19,0x5069,0xe1f9,0x8e89,0xedba,0x82ca,0x335a,0x5c2a,
+            0xf53c,0x9a4c,0x2bdc,0x44ac,0x279f,0x48ef,0xf97f,0x960f,0xba02,0xd572,
+            0x64e2,0x0b92,0x68a1,0x07d1,0xb641,0xd931,0x7027,0x1f57,0xaec7,0xc1b7,
+            0xa284,0xcdf4,0x7c64,0x1314,0x412b,0x2e5b,0x9fcb,0xf0bb,0x9388,0xfcf8,
+            0x4d68,0x2218,0x8b0e,0xe47e,0x55ee,0x3a9e,0x59ad,0x36dd,0x874d,0xe83d,
+            0x2333,0x4c43,0xfdd3,0x92a3,0xf190,0x9ee0,0x2f70,0x4000,0xe916,0x8666,
+            0x37f6,0x5886,0x3bb5,0x54c5,0xe555,0x8a25,0xd81a,0xb76a,0x06fa,0x698a,
+            0x0ab9,0x65c9,0xd459,0xbb29,0x123f,0x7d4f,0xccdf,0xa3af,0xc09c,0xafec,
+            0x1e7c,0x710c,0xe703,0x8873,0x39e3,0x5693,0x35a0,0x5ad0,0xeb40,0x8430,
+            0x2d26,0x4256,0xf3c6,0x9cb6,0xff85,0x90f5,0x2165,0x4e15,0x1c2a,0x735a,
+            0xc2ca,0xadba,0xce89,0xa1f9,0x1069,0x7f19,0xd60f,0xb97f,0x08ef,0x679f,
+            0x04ac,0x6bdc,0xda4c,0xb53c,0x7e32,0x1142,0xa0d2,0xcfa2,0xac91,0xc3e1,
+            0x7271,0x1d01,0xb417,0xdb67,0x6af7,0x0587,0x66b4,0x09c4,0xb854,0xd724,
+            0x851b,0xea6b,0x5bfb,0x348b,0x57b8,0x38c8,0x8958,0xe628,0x4f3e,0x204e,
+            0x91de,0xfeae,0x9d9d,0xf2ed,0x437d,0x2c0d,
+        },
+        {
+            0x0000,0x1b67,0x36ce,0x2da9,0x6d9c,0x76fb,0x5b52,0x4035,0xdb38,0xc05f,
+            0xedf6,0xf691,0xb6a4,0xadc3,0x806a,0x9b0d,0xd913,0xc274,0xefdd,0xf4ba,
+            0xb48f,0xafe8,0x8241,0x9926,0x022b,0x194c,0x34e5,0x2f82,0x6fb7,0x74d0,
+            0x5979,0x421e,0xdd45,0xc622,0xeb8b,0xf0ec,0xb0d9,0xabbe,0x8617,0x9d70,
+            0x067d,0x1d1a,0x30b3,0x2bd4,0x6be1,0x7086,0x5d2f,0x4648,0x0456,0x1f31,
+            0x3298,0x29ff,0x69ca,0x72ad,0x5f04,0x4463,0xdf6e,0xc409,0xe9a0,0xf2c7,
+            0xb2f2,0xa995,0x843c,0x9f5b,0xd5e9,0xce8e,0xe327,0xf840,0xb875,0xa312,
+            0x8ebb,0x95dc,0x0ed1,0x15b6,0x381f,0x2378,0x634d,0x782a,0x5583,0x4ee4,
+            0x0cfa,0x179d,0x3a34,0x2153,0x6166,0x7a01,0x57a8,0x4ccf,0xd7c2,0xcca5,
+            0xe10c,0xfa6b,0xba5e,0xa139,0x8c90,0x97f7,0x08ac,0x13cb,0x3e62,0x2505,
+            0x6530,0x7e57,0x53fe,0x4899,0xd394,0xc8f3,0xe55a,0xfe3d,0xbe08,0xa56f,
+            0x88c6,0x93a1,0xd1bf,0xcad8,0xe771,0xfc16,0xbc23,0xa744,0x8aed,0x918a,
+            0x0a87,0x11e0,0x3c49,0x272e,0x671b,0x7c7c,0x51d5,0x4ab2,0xc4b1,0xdfd6,
+            0xf27f,0xe918,0xa92d,0xb24a,0x9fe3,0x8484,0x1f89,0x04ee,0x2947,0x3220,
+            0x7215,0x6972,0x44db,0x5fbc,0x1da2,0x06c5,0x2b6c,0x300b,0x703e,0x6b59,
+            0x46f0,0x5d97,0xc69a,0xddfd,0xf054,0xeb33,0xab06,0xb061,0x9dc8,0x86af,
+            0x19f4,0x0293,0x2f3a,0x345d,0x7468,0x6f0f,0x42a6,0x59c1,0xc2cc,0xd9ab,
+            0xf402,0xef65,0xaf50,0xb437,0x999e,0x82f9,0xc0e7,0xdb80,0xf629,0xed4e,
+            0xad7b,0xb61c,0x9bb5,0x80d2,0x1bdf,0x00b8,0x2d11,0x3676,0x7643,0x6d24,
+            0x408d,0x5bea,0x1158,0x0a3f,0x2796,0x3cf1,0x7cc4,0x67a3,0x4a0a,0x516d,
+            0xca60,0xd107,0xfcae,0xe7c9,0xa7fc,0xbc9b,0x9132,0x8a55,0xc84b,0xd32c,
+            0xfe85,0xe5e2,0xa5d7,0xbeb0,0x9319,0x887e,0x1373,0x0814,0x25bd,0x3eda,
+            0x7eef,0x6588,0x4821,0x5346,0xcc1d,0xd77a,0xfad3,0xe1b4,0xa181,0xbae6,
+            0x974f,0x8c28,0x1725,0x0c42,0x21eb,0x3a8c,0x7ab9,0x61de,0x4c77,0x5710,
+            0x150e,0x0e69,0x23c0,0x38a7,0x7892,0x63f5,0x4e5c,0x553b,0xce36,0xd551,
+            0xf8f8,0xe39f,0xa3aa,0xb8cd,0x9564,0x8e03,
+        },
+    },
+    { // AMR_CRC_CCITT
+        {
+            0x0000,0x1021,0x2042,0x3063,0x4084,0x50a5,0x60c6,0x70e7,0x8108,0x9129,
+            0xa14a,0xb16b,0xc18c,0xd1ad,0xe1ce,0xf1ef,0x1231,0x0210,0x3273,0x2252,
+            0x52b5,0x4294,0x72f7,0x62d6,0x9339,0x8318,0xb37b,0xa35a,0xd3bd,0xc39c,
+            0xf3ff,0xe3de,0x2462,0x3443,0x0420,0x1401,0x64e6,0x74c7,0x44a4,0x5485,
+            0xa56a,0xb54b,0x8528,0x9509,0xe5ee,0xf5cf,0xc5ac,0xd58d,0x3653,0x2672,
+            0x1611,0x0630,0x76d7,0x66f6,0x5695,0x46b4,0xb75b,0xa77a,0x9719,0x8738,
+            0xf7df,0xe7fe,0xd79d,0xc7bc,0x48c4,0x58e5,0x6886,0x78a7,0x0840,0x1861,
+            0x2802,0x3823,0xc9cc,0xd9ed,0xe98e,0xf9af,0x8948,0x9969,0xa90a,0xb92b,
+            0x5af5,0x4ad4,0x7ab7,0x6a96,0x1a71,0x0a50,0x3a33,0x2a12,0xdbfd,0xcbdc,
+            0xfbbf,0xeb9e,0x9b79,0x8b58,0xbb3b,0xab1a,0x6ca6,0x7c87,0x4ce4,0x5cc5,
+            0x2c22,0x3c03,0x0c60,0x1c41,0xedae,0xfd8f,0xcdec,0xddcd,0xad2a,0xbd0b,
+            0x8d68,0x9d49,0x7e97,0x6eb6,0x5ed5,0x4ef4,0x3e13,0x2e32,0x1e51,0x0e70,
+            0xff9f,0xefbe,0xdfdd,0xcffc,0xbf1b,0xaf3a,0x9f59,0x8f78,0x9188,0x81a9,
+            0xb1ca,0xa1eb,0xd10c,0xc12d,0xf14e,0xe16f,0x1080,0x00a1,0x30c2,0x20e3,
+            0x5004,0x4025,0x7046,0x6067,0x83b9,0x9398,0xa3fb,0xb3da,0xc33d,0xd31c,
+            0xe37f,0xf35e,0x02b1,0x1290,0x22f3,0x32d2,0x4235,0x5214,0x6277,0x7256,
+            0xb5ea,0xa5cb,0x95a8,0x8589,0xf56e,0xe54f,0xd52c,0xc50d,0x34e2,0x24c3,
+            0x14a0,0x0481,0x7466,0x6447,0x5424,0x4405,0xa7db,0xb7fa,0x8799,0x97b8,
+            0xe75f,0xf77e,0xc71d,0xd73c,0x26d3,0x36f2,0x0691,0x16b0,0x6657,0x7676,
+            0x4615,0x5634,0xd94c,0xc96d,0xf90e,0xe92f,0x99c8,0x89e9,0xb98a,0xa9ab,
+            0x5844,0x4865,0x7806,0x6827,0x18c0,0x08e1,0x3882,0x28a3,0xcb7d,0xdb5c,
+            0xeb3f,0xfb1e,0x8bf9,0x9bd8,0xabbb,0xbb9a,0x4a75,0x5a54,0x6a37,0x7a16,
+            0x0af1,0x1ad0,0x2ab3,0x3a92,0xfd2e,0xed0f,0xdd6c,0xcd4d,0xbdaa,0xad8b,
+            0x9de8,0x8dc9,0x7c26,0x6c07,0x5c64,0x4c45,0x3ca2,0x2c83,0x1ce0,0x0cc1,
+            0xef1f,0xff3e,0xcf5d,0xdf7c,0xaf9b,0xbfba,0x8fd9,0x9ff8,0x6e17,0x7e36,
+            0x4e55,0x5e74,0x2e93,0x3eb2,0x0ed1,0x1ef0,
+        },
+        {
+            0x0000,0x3331,0x6662,0x5553,0xccc4,0xfff5,0xaaa6,0x9997,0x89a9,0xba98,
+            0xefcb,0xdcfa,0x456d,0x765c,0x230f,0x103e,0x0373,0x3042,0x6511,0x5620,
+            0xcfb7,0xfc86,0xa9d5,0x9ae4,0x8ada,0xb9eb,0xecb8,0xdf89,0x461e,0x752f,
+            0x207c,0x134d,0x06e6,0x35d7,0x6084,0x53b5,0xca22,0xf913,0xac40,0x9f71,
+            0x8f4f,0xbc7e,0xe92d,0xda1c,0x438b,0x70ba,0x25e9,0x16d8,0x0595,0x36a4,
+            0x63f7,0x50c6,0xc951,0xfa60,0xaf33,0x9c02,0x8c3c,0xbf0d,0xea5e,0xd96f,
+            0x40f8,0x73c9,0x269a,0x15ab,0x0dcc,0x3efd,0x6bae,0x589f,0xc108,0xf239,
+            0xa76a,0x945b,0x8465,0xb754,0xe207,0xd136,0x48a1,0x7b90,0x2ec3,0x1df2,
+            0x0ebf,0x3d8e,0x68dd,0x5bec,0xc27b,0xf14a,0xa419,0x9728,0x8716,0xb427,
+            0xe174,0xd245,0x4bd2,0x78e3,0x2db0,0x1e81,0x0b2a,0x381b,0x6d48,0x5e79,
+            0xc7ee,0xf4df,0xa18c,0x92bd,0x8283,0xb1b2,0xe4e1,0xd7d0,0x4e47,0x7d76,
+            0x2825,0x1b14,0x0859,0x3b68,0x6e3b,0x5d0a,0xc49d,0xf7ac,0xa2ff,0x91ce,
+            0x81f0,0xb2c1,0xe792,0xd4a3,0x4d34,0x7e05,0x2b56,0x1867,0x1b98,0x28a9,
+            0x7dfa,0x4ecb,0xd75c,0xe46d,0xb13e,0x820f,0x9231,0xa100,0xf453,0xc762,
+            0x5ef5,0x6dc4,0x3897,0x0ba6,0x18eb,0x2bda,0x7e89,0x4db8,0xd42f,0xe71e,
+            0xb24d,0x817c,0x9142,0xa273,0xf720,0xc411,0x5d86,0x6eb7,0x3be4,0x08d5,
+            0x1d7e,0x2e4f,0x7b1c,0x482d,0xd1ba,0xe28b,0xb7d8,0x84e9,0x94d7,0xa7e6,
+            0xf2b5,0xc184,0x5813,0x6b22,0x3e71,0x0d40,0x1e0d,0x2d3c,0x786f,0x4b5e,
+            0xd2c9,0xe1f8,0xb4ab,0x879a,0x97a4,0xa495,0xf1c6,0xc2f7,0x5b60,0x6851,
+            0x3d02,0x0e33,0x1654,0x2565,0x7036,0x4307,0xda90,0xe9a1,0xbcf2,0x8fc3,
+            0x9ffd,0xaccc,0xf99f,0xcaae,0x5339,0x6008,0x355b,0x066a,0x1527,0x2616,
+            0x7345,0x4074,0xd9e3,0xead2,0xbf81,0x8cb0,0x9c8e,0xafbf,0xfaec,0xc9dd,
+            0x504a,0x637b,0x3628,0x0519,0x10b2,0x2383,0x76d0,0x45e1,0xdc76,0xef47,
+            0xba14,0x8925,0x991b,0xaa2a,0xff79,0xcc48,0x55df,0x66ee,0x33bd,0x008c,
+            0x13c1,0x20f0,0x75a3,0x4692,0xdf05,0xec34,0xb967,0x8a56,0x9a68,0xa959,
+            0xfc0a,0xcf3b,0x56ac,0x659d,0x30ce,0x03ff,
+        },
+        {
+            0x0000,0x3730,0x6e60,0x5950,0xdcc0,0xebf0,0xb2a0,0x8590,0xa9a1,0x9e91,
+            0xc7c1,0xf0f1,0x7561,0x4251,0x1b01,0x2c31,0x4363,0x7453,0x2d03,0x1a33,
+            0x9fa3,0xa893,0xf1c3,0xc6f3,0xeac2,0xddf2,0x84a2,0xb392,0x3602,0x0132,
+            0x5862,0x6f52,0x86c6,0xb1f6,0xe8a6,0xdf96,0x5a06,0x6d36,0x3466,0x0356,
+            0x2f67,0x1857,0x4107,0x7637,0xf3a7,0xc497,0x9dc7,0xaaf7,0xc5a5,0xf295,
+            0xabc5,0x9cf5,0x1965,0x2e55,0x7705,0x4035,0x6c04,0x5b34,0x0264,0x3554,
+            0xb0c4,0x87f4,0xdea4,0xe994,0x1dad,0x2a9d,0x73cd,0x44fd,0xc16d,0xf65d,
+            0xaf0d,0x983d,0xb40c,0x833c,0xda6c,0xed5c,0x68cc,0x5ffc,0x06ac,0x319c,
+            0x5ece,0x69fe,0x30ae,0x079e,0x820e,0xb53e,0xec6e,0xdb5e,0xf76f,0xc05f,
+            0x990f,0xae3f,0x2baf,0x1c9f,0x45cf,0x72ff,0x9b6b,0xac5b,0xf50b,0xc23b,
+            0x47ab,0x709b,0x29cb,0x1efb,0x32ca,0x05fa,0x5caa,0x6b9a,0xee0a,0xd93a,
+            0x806a,0xb75a,0xd808,0xef38,0xb668,0x8158,0x04c8,0x33f8,0x6aa8,0x5d98,
+            0x71a9,0x4699,0x1fc9,0x28f9,0xad69,0x9a59,0xc309,0xf439,0x3b5a,0x0c6a,
+            0x553a,0x620a,0xe79a,0xd0aa,0x89fa,0xbeca,0x92fb,0xa5cb,0xfc9b,0xcbab,
+            0x4e3b,0x790b,0x205b,0x176b,0x7839,0x4f09,0x1659,0x2169,0xa4f9,0x93c9,
+            0xca99,0xfda9,0xd198,0xe6a8,0xbff8,0x88c8,0x0d58,0x3a68,0x6338,0x5408,
+            0xbd9c,0x8aac,0xd3fc,0xe4cc,0x615c,0x566c,0x0f3c,0x380c,0x143d,0x230d,
+            0x7a5d,0x4d6d,0xc8fd,0xffcd,0xa69d,0x91ad,0xfeff,0xc9cf,0x909f,0xa7af,
+            0x223f,0x150f,0x4c5f,0x7b6f,0x575e,0x606e,0x393e,0x0e0e,0x8b9e,0xbcae,
+            0xe5fe,0xd2ce,0x26f7,0x11c7,0x4897,0x7fa7,0xfa37,0xcd07,0x9457,0xa367,
+            0x8f56,0xb866,0xe136,0xd606,0x5396,0x64a6,0x3df6,0x0ac6,0x6594,0x52a4,
+            0x0bf4,0x3cc4,0xb954,0x8e64,0xd734,0xe004,0xcc35,0xfb05,0xa255,0x9565,
+            0x10f5,0x27c5,0x7e95,0x49a5,0xa031,0x9701,0xce51,0xf961,0x7cf1,0x4bc1,
+            0x1291,0x25a1,0x0990,0x3ea0,0x67f0,0x50c0,0xd550,0xe260,0xbb30,0x8c00,
+            0xe352,0xd462,0x8d32,0xba02,0x3f92,0x08a2,0x51f2,0x66c2,0x4af3,0x7dc3,
+            0x2493,0x13a3,0x9633,0xa103,0xf853,0xcf63,
+        },
+        {
+            0x0000,0x76b4,0xed68,0x9bdc,0xcaf1,0xbc45,0x2799,0x512d,0x85c3,0xf377,
+            0x68ab,0x1e1f,0x4f32,0x3986,0xa25a,0xd4ee,0x1ba7,0x6d13,0xf6cf,0x807b,
+            0xd156,0xa7e2,0x3c3e,0x4a8a,0x9e64,0xe8d0,0x730c,0x05b8,0x5495,0x2221,
+            0xb9fd,0xcf49,0x374e,0x41fa,0xda26,0xac92,0xfdbf,0x8b0b,0x10d7,0x6663,
+            0xb28d,0xc439,0x5fe5,0x2951,0x787c,0x0ec8,0x9514,0xe3a0,0x2ce9,0x5a5d,
+            0xc181,0xb735,0xe618,0x90ac,0x0b70,0x7dc4,0xa92a,0xdf9e,0x4442,0x32f6,
+            0x63db,0x156f,0x8eb3,0xf807,0x6e9c,0x1828,0x83f4,0xf540,0xa46d,0xd2d9,
+            0x4905,0x3fb1,0xeb5f,0x9deb,0x0637,0x7083,0x21ae,0x571a,0xccc6,0xba72,
+            0x753b,0x038f,0x9853,0xeee7,0xbfca,0xc97e,0x52a2,0x2416,0xf0f8,0x864c,
+            0x1d90,0x6b24,0x3a09,0x4cbd,0xd761,0xa1d5,0x59d2,0x2f66,0xb4ba,0xc20e,
+            0x9323,0xe597,0x7e4b,0x08ff,0xdc11,0xaaa5,0x3179,0x47cd,0x16e0,0x6054,
+            0xfb88,0x8d3c,0x4275,0x34c1,0xaf1d,0xd9a9,0x8884,0xfe30,0x65ec,0x1358,
+            0xc7b6,0xb102,0x2ade,0x5c6a,0x0d47,0x7bf3,0xe02f,0x969b,0xdd38,0xab8c,
+            0x3050,0x46e4,0x17c9,0x617d,0xfaa1,0x8c15,0x58fb,0x2e4f,0xb593,0xc327,
+            0x920a,0xe4be,0x7f62,0x09d6,0xc69f,0xb02b,0x2bf7,0x5d43,0x0c6e,0x7ada,
+            0xe106,0x97b2,0x435c,0x35e8,0xae34,0xd880,0x89ad,0xff19,0x64c5,0x1271,
+            0xea76,0x9cc2,0x071e,0x71aa,0x2087,0x5633,0xcdef,0xbb5b,0x6fb5,0x1901,
+            0x82dd,0xf469,0xa544,0xd3f0,0x482c,0x3e98,0xf1d1,0x8765,0x1cb9,0x6a0d,
+            0x3b20,0x4d94,0xd648,0xa0fc,0x7412,0x02a6,0x997a,0xefce,0xbee3,0xc857,
+            0x538b,0x253f,0xb3a4,0xc510,0x5ecc,0x2878,0x7955,0x0fe1,0x943d,0xe289,
+            0x3667,0x40d3,0xdb0f,0xadbb,0xfc96,0x8a22,0x11fe,0x674a,0xa803,0xdeb7,
+            0x456b,0x33df,0x62f2,0x1446,0x8f9a,0xf92e,0x2dc0,0x5b74,0xc0a8,0xb61c,
+            0xe731,0x9185,0x0a59,0x7ced,0x84ea,0xf25e,0x6982,0x1f36,0x4e1b,0x38af,
+            0xa373,0xd5c7,0x0129,0x779d,0xec41,0x9af5,0xcbd8,0xbd6c,0x26b0,0x5004,
+            0x9f4d,0xe9f9,0x7225,0x0491,0x55bc,0x2308,0xb8d4,0xce60,0x1a8e,0x6c3a,
+            0xf7e6,0x8152,0xd07f,0xa6cb,0x3d17,0x4ba3,
+        },
+        {
+            0x0000,0xaa51,0x4483,0xeed2,0x8906,0x2357,0xcd85,0x67d4,0x022d,0xa87c,
+            0x46ae,0xecff,0x8b2b,0x217a,0xcfa8,0x65f9,0x045a,0xae0b,0x40d9,0xea88,
+            0x8d5c,0x270d,0xc9df,0x638e,0x0677,0xac26,0x42f4,0xe8a5,0x8f71,0x2520,
+            0xcbf2,0x61a3,0x08b4,0xa2e5,0x4c37,0xe666,0x81b2,0x2be3,0xc531,0x6f60,
+            0x0a99,0xa0c8,0x4e1a,0xe44b,0x839f,0x29ce,0xc71c,0x6d4d,0x0cee,0xa6bf,
+            0x486d,0xe23c,0x85e8,0x2fb9,0xc16b,0x6b3a,0x0ec3,0xa492,0x4a40,0xe011,
+            0x87c5,0x2d94,0xc346,0x6917,0x1168,0xbb39,0x55eb,0xffba,0x986e,0x323f,
+            0xdced,0x76bc,0x1345,0xb914,0x57c6,0xfd97,0x9a43,0x3012,0xdec0,0x7491,
+            0x1532,0xbf63,0x51b1,0xfbe0,0x9c34,0x3665,0xd8b7,0x72e6,0x171f,0xbd4e,
+            0x539c,0xf9cd,0x9e19,0x3448,0xda9a,0x70cb,0x19dc,0xb38d,0x5d5f,0xf70e,
+            0x90da,0x3a8b,0xd459,0x7e08,0x1bf1,0xb1a0,0x5f72,0xf523,0x92f7,0x38a6,
+            0xd674,0x7c25,0x1d86,0xb7d7,0x5905,0xf354,0x9480,0x3ed1,0xd003,0x7a52,
+            0x1fab,0xb5fa,0x5b28,0xf179,0x96ad,0x3cfc,0xd22e,0x787f,0x22d0,0x8881,
+            0x6653,0xcc02,0xabd6,0x0187,0xef55,0x4504,0x20fd,0x8aac,0x647e,0xce2f,
+            0xa9fb,0x03aa,0xed78,0x4729,0x268a,0x8cdb,0x6209,0xc858,0xaf8c,0x05dd,
+            0xeb0f,0x415e,0x24a7,0x8ef6,0x6024,0xca75,0xada1,0x07f0,0xe922,0x4373,
+            0x2a64,0x8035,0x6ee7,0xc4b6,0xa362,0x0933,0xe7e1,0x4db0,0x2849,0x8218,
+            0x6cca,0xc69b,0xa14f,0x0b1e,0xe5cc,0x4f9d,0x2e3e,0x846f,0x6abd,0xc0ec,
+            0xa738,0x0d69,0xe3bb,0x49ea,0x2c13,0x8642,0x6890,0xc2c1,0xa515,0x0f44,
+            0xe196,0x4bc7,0x33b8,0x99e9,0x773b,0xdd6a,0xbabe,0x10ef,0xfe3d,0x546c,
+            0x3195,0x9bc4,0x7516,0xdf47,0xb893,0x12c2,0xfc10,0x5641,0x37e2,0x9db3,
+            0x7361,0xd930,0xbee4,0x14b5,0xfa67,0x5036,0x35cf,0x9f9e,0x714c,0xdb1d,
+            0xbcc9,0x1698,0xf84a,0x521b,0x3b0c,0x915d,0x7f8f,0xd5de,0xb20a,0x185b,
+            0xf689,0x5cd8,0x3921,0x9370,0x7da2,0xd7f3,0xb027,0x1a76,0xf4a4,0x5ef5,
+            0x3f56,0x9507,0x7bd5,0xd184,0xb650,0x1c01,0xf2d3,0x5882,0x3d7b,0x972a,
+            0x79f8,0xd3a9,0xb47d,0x1e2c,0xf0fe,0x5aaf,
+        },
+        {
+            0x0000,0x45a0,0x8b40,0xcee0,0x06a1,0x4301,0x8de1,0xc841,0x0d42,0x48e2,
+            0x8602,0xc3a2,0x0be3,0x4e43,0x80a3,0xc503,0x1a84,0x5f24,0x91c4,0xd464,
+            0x1c25,0x5985,0x9765,0xd2c5,0x17c6,0x5266,0x9c86,0xd926,0x1167,0x54c7,
+            0x9a27,0xdf87,0x3508,0x70a8,0xbe48,0xfbe8,0x33a9,0x7609,0xb8e9,0xfd49,
+            0x384a,0x7dea,0xb30a,0xf6aa,0x3eeb,0x7b4b,0xb5ab,0xf00b,0x2f8c,0x6a2c,
+            0xa4cc,0xe16c,0x292d,0x6c8d,0xa26d,0xe7cd,0x22ce,0x676e,0xa98e,0xec2e,
+            0x246f,0x61cf,0xaf2f,0xea8f,0x6a10,0x2fb0,0xe150,0xa4f0,0x6cb1,0x2911,
+            0xe7f1,0xa251,0x6752,0x22f2,0xec12,0xa9b2,0x61f3,0x2453,0xeab3,0xaf13,
+            0x7094,0x3534,0xfbd4,0xbe74,0x7635,0x3395,0xfd75,0xb8d5,0x7dd6,0x3876,
+            0xf696,0xb336,0x7b77,0x3ed7,0xf037,0xb597,0x5f18,0x1ab8,0xd458,0x91f8,
+            0x59b9,0x1c19,0xd2f9,0x9759,0x525a,0x17fa,0xd91a,0x9cba,0x54fb,0x115b,
+            0xdfbb,0x9a1b,0x459c,0x003c,0xcedc,0x8b7c,0x433d,0x069d,0xc87d,0x8ddd,
+            0x48de,0x0d7e,0xc39e,0x863e,0x4e7f,0x0bdf,0xc53f,0x809f,0xd420,0x9180,
+            0x5f60,0x1ac0,0xd281,0x9721,0x59c1,0x1c61,0xd962,0x9cc2,0x5222,0x1782,
+            0xdfc3,0x9a63,0x5483,0x1123,0xcea4,0x8b04,0x45e4,0x0044,0xc805,0x8da5,
+            0x4345,0x06e5,0xc3e6,0x8646,0x48a6,0x0d06,0xc547,0x80e7,0x4e07,0x0ba7,
+            0xe128,0xa488,0x6a68,0x2fc8,0xe789,0xa229,0x6cc9,0x2969,0xec6a,0xa9ca,
+            0x672a,0x228a,0xeacb,0xaf6b,0x618b,0x242b,0xfbac,0xbe0c,0x70ec,0x354c,
+            0xfd0d,0xb8ad,0x764d,0x33ed,0xf6ee,0xb34e,0x7dae,0x380e,0xf04f,0xb5ef,
+            0x7b0f,0x3eaf,0xbe30,0xfb90,0x3570,0x70d0,0xb891,0xfd31,0x33d1,0x7671,
+            0xb372,0xf6d2,0x3832,0x7d92,0xb5d3,0xf073,0x3e93,0x7b33,0xa4b4,0xe114,
+            0x2ff4,0x6a54,0xa215,0xe7b5,0x2955,0x6cf5,0xa9f6,0xec56,0x22b6,0x6716,
+            0xaf57,0xeaf7,0x2417,0x61b7,0x8b38,0xce98,0x0078,0x45d8,0x8d99,0xc839,
+            0x06d9,0x4379,0x867a,0xc3da,0x0d3a,0x489a,0x80db,0xc57b,0x0b9b,0x4e3b,
+            0x91bc,0xd41c,0x1afc,0x5f5c,0x971d,0xd2bd,0x1c5d,0x59fd,0x9cfe,0xd95e,
+            0x17be,0x521e,0x9a5f,0xdfff,0x111f,0x54bf,
+        },
+        {
+            0x0000,0xb861,0x60e3,0xd882,0xc1c6,0x79a7,0xa125,0x1944,0x93ad,0x2bcc,
+            0xf34e,0x4b2f,0x526b,0xea0a,0x3288,0x8ae9,0x377b,0x8f1a,0x5798,0xeff9,
+            0xf6bd,0x4edc,0x965e,0x2e3f,0xa4d6,0x1cb7,0xc435,0x7c54,0x6510,0xdd71,
+            0x05f3,0xbd92,0x6ef6,0xd697,0x0e15,0xb674,0xaf30,0x1751,0xcfd3,0x77b2,
+            0xfd5b,0x453a,0x9db8,0x25d9,0x3c9d,0x84fc,0x5c7e,0xe41f,0x598d,0xe1ec,
+            0x396e,0x810f,0x984b,0x202a,0xf8a8,0x40c9,0xca20,0x7241,0xaac3,0x12a2,
+            0x0be6,0xb387,0x6b05,0xd364,0xddec,0x658d,0xbd0f,0x056e,0x1c2a,0xa44b,
+            0x7cc9,0xc4a8,0x4e41,0xf620,0x2ea2,0x96c3,0x8f87,0x37e6,0xef64,0x5705,
+            0xea97,0x52f6,0x8a74,0x3215,0x2b51,0x9330,0x4bb2,0xf3d3,0x793a,0xc15b,
+            0x19d9,0xa1b8,0xb8fc,0x009d,0xd81f,0x607e,0xb31a,0x0b7b,0xd3f9,0x6b98,
+            0x72dc,0xcabd,0x123f,0xaa5e,0x20b7,0x98d6,0x4054,0xf835,0xe171,0x5910,
+            0x8192,0x39f3,0x8461,0x3c00,0xe482,0x5ce3,0x45a7,0xfdc6,0x2544,0x9d25,
+            0x17cc,0xafad,0x772f,0xcf4e,0xd60a,0x6e6b,0xb6e9,0x0e88,0xabf9,0x1398,
+            0xcb1a,0x737b,0x6a3f,0xd25e,0x0adc,0xb2bd,0x3854,0x8035,0x58b7,0xe0d6,
+            0xf992,0x41f3,0x9971,0x2110,0x9c82,0x24e3,0xfc61,0x4400,0x5d44,0xe525,
+            0x3da7,0x85c6,0x0f2f,0xb74e,0x6fcc,0xd7ad,0xcee9,0x7688,0xae0a,0x166b,
+            0xc50f,0x7d6e,0xa5ec,0x1d8d,0x04c9,0xbca8,0x642a,0xdc4b,0x56a2,0xeec3,
+            0x3641,0x8e20,0x9764,0x2f05,0xf787,0x4fe6,0xf274,0x4a15,0x9297,0x2af6,
+            0x33b2,0x8bd3,0x5351,0xeb30,0x61d9,0xd9b8,0x013a,0xb95b,0xa01f,0x187e,
+            0xc0fc,0x789d,0x7615,0xce74,0x16f6,0xae97,0xb7d3,0x0fb2,0xd730,0x6f51,
+            0xe5b8,0x5dd9,0x855b,0x3d3a,0x247e,0x9c1f,0x449d,0xfcfc,0x416e,0xf90f,
+            0x218d,0x99ec,0x80a8,0x38c9,0xe04b,0x582a,0xd2c3,0x6aa2,0xb220,0x0a41,
+            0x1305,0xab64,0x73e6,0xcb87,0x18e3,0xa082,0x7800,0xc061,0xd925,0x6144,
+            0xb9c6,0x01a7,0x8b4e,0x332f,0xebad,0x53cc,0x4a88,0xf2e9,0x2a6b,0x920a,
+            0x2f98,0x97f9,0x4f7b,0xf71a,0xee5e,0x563f,0x8ebd,0x36dc,0xbc35,0x0454,
+            0xdcd6,0x64b7,0x7df3,0xc592,0x1d10,0xa571,
+        },
+        {
+            0x0000,0x47d3,0x8fa6,0xc875,0x0f6d,0x48be,0x80cb,0xc718,0x1eda,0x5909,
+            0x917c,0xd6af,0x11b7,0x5664,0x9e11,0xd9c2,0x3db4,0x7a67,0xb212,0xf5c1,
+            0x32d9,0x750a,0xbd7f,0xfaac,0x236e,0x64bd,0xacc8,0xeb1b,0x2c03,0x6bd0,
+            0xa3a5,0xe476,0x7b68,0x3cbb,0xf4ce,0xb31d,0x7405,0x33d6,0xfba3,0xbc70,
+            0x65b2,0x2261,0xea14,0xadc7,0x6adf,0x2d0c,0xe579,0xa2aa,0x46dc,0x010f,
+            0xc97a,0x8ea9,0x49b1,0x0e62,0xc617,0x81c4,0x5806,0x1fd5,0xd7a0,0x9073,
+            0x576b,0x10b8,0xd8cd,0x9f1e,0xf6d0,0xb103,0x7976,0x3ea5,0xf9bd,0xbe6e,
+            0x761b,0x31c8,0xe80a,0xafd9,0x67ac,0x207f,0xe767,0xa0b4,0x68c1,0x2f12,
+            0xcb64,0x8cb7,0x44c2,0x0311,0xc409,0x83da,0x4baf,0x0c7c,0xd5be,0x926d,
+            0x5a18,0x1dcb,0xdad3,0x9d00,0x5575,0x12a6,0x8db8,0xca6b,0x021e,0x45cd,
+            0x82d5,0xc506,0x0d73,0x4aa0,0x9362,0xd4b1,0x1cc4,0x5b17,0x9c0f,0xdbdc,
+            0x13a9,0x547a,0xb00c,0xf7df,0x3faa,0x7879,0xbf61,0xf8b2,0x30c7,0x7714,
+            0xaed6,0xe905,0x2170,0x66a3,0xa1bb,0xe668,0x2e1d,0x69ce,0xfd81,0xba52,
+            0x7227,0x35f4,0xf2ec,0xb53f,0x7d4a,0x3a99,0xe35b,0xa488,0x6cfd,0x2b2e,
+            0xec36,0xabe5,0x6390,0x2443,0xc035,0x87e6,0x4f93,0x0840,0xcf58,0x888b,
+            0x40fe,0x072d,0xdeef,0x993c,0x5149,0x169a,0xd182,0x9651,0x5e24,0x19f7,
+            0x86e9,0xc13a,0x094f,0x4e9c,0x8984,0xce57,0x0622,0x41f1,0x9833,0xdfe0,
+            0x1795,0x5046,0x975e,0xd08d,0x18f8,0x5f2b,0xbb5d,0xfc8e,0x34fb,0x7328,
+            0xb430,0xf3e3,0x3b96,0x7c45,0xa587,0xe254,0x2a21,0x6df2,0xaaea,0xed39,
+            0x254c,0x629f,0x0b51,0x4c82,0x84f7,0xc324,0x043c,0x43ef,0x8b9a,0xcc49,
+            0x158b,0x5258,0x9a2d,0xddfe,0x1ae6,0x5d35,0x9540,0xd293,0x36e5,0x7136,
+            0xb943,0xfe90,0x3988,0x7e5b,0xb62e,0xf1fd,0x283f,0x6fec,0xa799,0xe04a,
+            0x2752,0x6081,0xa8f4,0xef27,0x7039,0x37ea,0xff9f,0xb84c,0x7f54,0x3887,
+            0xf0f2,0xb721,0x6ee3,0x2930,0xe145,0xa696,0x618e,0x265d,0xee28,0xa9fb,
+            0x4d8d,0x0a5e,0xc22b,0x85f8,0x42e0,0x0533,0xcd46,0x8a95,0x5357,0x1484,
+            0xdcf1,0x9b22,0x5c3a,0x1be9,0xd39c,0x944f,
+        },
+    },
+};
+
+// Folding constants t^n mod P and the Barrett reduction constant
+typedef struct {
+    uint64_t k64, k96, k128, k192;
+    uint64_t mu; //! floor(t^80 / P) - t^64
+    uint64_t poly; //! P - t^16
+} AmrCrcFold;
+
+static const AmrCrcFold amrCrcFolds[AMR_CRC_CNT] = {
+    {0x6f70, 0x1bdb, 0xacb8, 0xbd6f, 0x7d0b9ecc50d07d1full, 0x6f63}, // AMR_CRC_BCH
+    {0xb861, 0xd849, 0xaefc, 0x650b, 0x11303471a041b343ull, 0x1021}, // AMR_CRC_CCITT
+};
+
+#endif
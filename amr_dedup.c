@@ -0,0 +1,88 @@
+#include "amr_dedup.h"
+#include <string.h>
+
+// FNV-1a
+static inline uint32_t dedupHash(const uint8_t * data, size_t len) {
+    uint32_t h = 0x811c9dc5u;
+    size_t i = 0;
+    for (; i < len; ++i) {
+        h = (h ^ data[i]) * 0x01000193u;
+    }
+    return h;
+}
+
+// Set of a meter. All frames of a meter share it, so a new reading replaces
+// the old one before any other meter's entry. The top bits of the product are
+// the well mixed ones.
+static inline uint32_t amrDedupSetIdx(const AmrDedup * dedup, uint8_t type, uint32_t id) {
+    return (uint32_t)(((uint64_t)((id ^ type) * 0x9e3779b1u) << dedup->setBits) >> 32);
+}
+
+uint8_t amrDedupInit(AmrDedup * dedup, AmrDedupEntry * entries, size_t nentries, uint32_t window) {
+    if (dedup == NULL || entries == NULL || nentries < AMR_DEDUP_WAYS ||
+            (nentries & (nentries - 1)) != 0 || nentries / AMR_DEDUP_WAYS > 0x80000000u) {
+        return 0;
+    }
+
+    dedup->entries = entries;
+    dedup->setMask = (uint32_t)(nentries / AMR_DEDUP_WAYS - 1);
+    dedup->setBits = 0;
+    while ((dedup->setMask >> dedup->setBits) != 0) {
+        ++dedup->setBits;
+    }
+    dedup->window = window;
+    amrDedupClear(dedup);
+    return 1;
+}
+
+void amrDedupClear(AmrDedup * dedup) {
+    if (dedup == NULL) {
+        return;
+    }
+
+    memset(dedup->entries, 0,
+            ((size_t)dedup->setMask + 1) * AMR_DEDUP_WAYS * sizeof(dedup->entries[0]));
+    dedup->hits = 0;
+    dedup->misses = 0;
+}
+
+uint8_t amrDedupCheck(AmrDedup * dedup, uint8_t type, uint32_t id,
+        const uint8_t * frame, size_t len, uint32_t now) {
+    if (dedup == NULL || frame == NULL) {
+        return 0;
+    }
+
+    uint32_t hash = dedupHash(frame, len);
+    uint32_t setIdx = amrDedupSetIdx(dedup, type, id);
+    AmrDedupEntry * set = &dedup->entries[(size_t)setIdx * AMR_DEDUP_WAYS];
+    AmrDedupEntry * victim = &set[0];
+    uint8_t way = 0;
+    for (; way < AMR_DEDUP_WAYS; ++way) {
+        AmrDedupEntry * e = &set[way];
+        if (e->valid && e->id == id && e->hash == hash && e->type == type) {
+            // Timestamps wrap, compare the distance
+            uint8_t dup = (uint32_t)(now - e->time) <= dedup->window;
+            e->time = now;
+            if (dup) {
+                ++dedup->hits;
+                return 1;
+            }
+            ++dedup->misses;
+            return 0;
+        }
+        if (!e->valid) {
+            victim = e;
+        }
+        else if (victim->valid && (uint32_t)(now - e->time) > (uint32_t)(now - victim->time)) {
+            victim = e;
+        }
+    }
+
+    victim->id = id;
+    victim->hash = hash;
+    victim->time = now;
+    victim->type = type;
+    victim->valid = 1;
+    ++dedup->misses;
+    return 0;
+}
@@ -0,0 +1,42 @@
+#ifndef AMR_DEDUP_H
+#define AMR_DEDUP_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define AMR_DEDUP_WAYS 4 //! Entries per set
+
+typedef struct {
+    uint32_t id; //! Meter ID
+    uint32_t hash; //! Hash of the whole frame
+    uint32_t time; //! Timestamp of the last copy seen
+    uint8_t type; //! AMR_MSG_TYPE
+    uint8_t valid;
+} AmrDedupEntry;
+
+// Suppresses repeated copies of a frame: retransmissions and hits on both
+// Manchester phases. Frames are keyed on type, meter ID and a hash of the
+// frame bytes. A copy within window timestamp units of the last one seen is a
+// duplicate. The cache is set associative over caller provided storage and
+// evicts the oldest entry of a set. Not thread safe, use one per consumer.
+typedef struct {
+    AmrDedupEntry * entries;
+    uint32_t setMask; //! Set count - 1, the set count is a power of two
+    uint8_t setBits; //! log2 of the set count
+    uint32_t window;
+    uint32_t hits; //! Duplicates suppressed
+    uint32_t misses; //! Frames passed on
+} AmrDedup;
+
+// nentries must be a power of two and at least AMR_DEDUP_WAYS. window is in
+// the units of the timestamps passed to amrDedupCheck. Returns 0 on invalid
+// arguments.
+uint8_t amrDedupInit(AmrDedup * dedup, AmrDedupEntry * entries, size_t nentries, uint32_t window);
+// Forget every frame and reset the counters
+void amrDedupClear(AmrDedup * dedup);
+// Returns 1 when the frame is a duplicate. Either way the frame's entry is
+// refreshed to now, so a steady stream of copies stays suppressed.
+uint8_t amrDedupCheck(AmrDedup * dedup, uint8_t type, uint32_t id,
+        const uint8_t * frame, size_t len, uint32_t now);
+
+#endif
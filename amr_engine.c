@@ -0,0 +1,341 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "amr_engine.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define AMR_ENGINE_CACHE_LINE 64
+#define AMR_ENGINE_CHUNK_BITS 1024 //! Chips decoded between draining a decoder's ring
+
+// A decoder ring can't hold more frames than fit as SCM frames, which bounds
+// the messages each chunk can produce
+#define AMR_ENGINE_MSGS_PER_CHUNK \
+    (AMR_DECODER_RING_SIZE / (AMR_MSG_HDR_SIZE + AMR_MSG_SCM_RAW_SIZE + sizeof(RingPos_t)) + 1)
+#define AMR_ENGINE_MSGS_PER_BLOCK \
+    (AMR_ENGINE_MSGS_PER_CHUNK * (AMR_ENGINE_BLOCK_BYTES * 8 / AMR_ENGINE_CHUNK_BITS))
+
+#if AMR_ENGINE_BLOCK_BYTES * 8 % AMR_ENGINE_CHUNK_BITS != 0
+#error AMR_ENGINE_BLOCK_BYTES must hold a whole number of chunks
+#endif
+
+#define ENGINE_LOAD_ACQUIRE(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define ENGINE_STORE_RELEASE(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#define ENGINE_LOAD_RELAXED(ptr) __atomic_load_n((ptr), __ATOMIC_RELAXED)
+#define ENGINE_STORE_RELAXED(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_RELAXED)
+
+typedef struct {
+    uint32_t nbits;
+    uint8_t data[AMR_ENGINE_BLOCK_BYTES];
+} AmrEngineBlock;
+
+// Queue indices are free running and masked on access. Each index is written
+// by one side only and lives on its own cache line.
+typedef struct {
+    AmrDecoder dec;
+    uint16_t id;
+
+    uint32_t inHead __attribute__((aligned(AMR_ENGINE_CACHE_LINE))); //! Written by producer
+    uint8_t closed; //! Written by producer after its last push
+    uint32_t inTail __attribute__((aligned(AMR_ENGINE_CACHE_LINE))); //! Written by worker
+    uint32_t outHead; //! Written by worker, messages below are published
+    uint32_t outPending; //! Worker private, messages written so far
+    uint64_t watermark; //! Written by worker, every message up to here is in out
+    uint64_t chipPos; //! Worker private
+    uint8_t finished; //! Worker private
+    AmrEngineChannelStats stats; //! Written by worker
+    uint32_t outTail __attribute__((aligned(AMR_ENGINE_CACHE_LINE))); //! Written by consumer
+
+    AmrEngineBlock in[AMR_ENGINE_IN_SLOTS];
+    AmrEngineMsg out[AMR_ENGINE_OUT_SLOTS];
+} AmrEngineChannel;
+
+typedef struct {
+    AmrEngine * eng;
+    uint16_t idx;
+    pthread_t thread;
+} AmrEngineWorker;
+
+struct AmrEngine {
+    uint16_t channelCnt;
+    uint16_t workerCnt;
+    uint16_t workersStarted;
+    uint8_t pinWorkers;
+    uint8_t stop;
+    AmrEngineChannel * channels;
+    AmrEngineWorker * workers;
+};
+
+static void amrEngineMsgCallback(AmrDecoder * dec, const AmrMsgHeader * hdr,
+        const void * msg, const uint8_t * data) {
+    static const size_t msgSizes[] = {
+        sizeof(AmrScmMsg), sizeof(AmrScmPlusMsg), sizeof(AmrIdmMsg)};
+    static const size_t rawSizes[] = {
+        AMR_MSG_SCM_RAW_SIZE, AMR_MSG_SCM_PLUS_RAW_SIZE, AMR_MSG_IDM_RAW_SIZE};
+
+    if (hdr->type > AMR_MSG_TYPE_IDM) {
+        return;
+    }
+
+    // Space for a whole block of messages was reserved before decoding it
+    AmrEngineChannel * ch = (AmrEngineChannel *)dec->user;
+    AmrEngineMsg * out = &ch->out[ch->outPending & (AMR_ENGINE_OUT_SLOTS - 1)];
+    out->timestamp = ch->chipPos - (uint32_t)(dec->chipCnt - hdr->timestamp);
+    out->channel = ch->id;
+    out->type = hdr->type;
+    memcpy(&out->msg, msg, msgSizes[hdr->type]);
+    memcpy(out->data, data, rawSizes[hdr->type]);
+    ++ch->outPending;
+}
+
+static void amrEnginePublishStats(AmrEngineChannel * ch) {
+    ENGINE_STORE_RELAXED(&ch->stats.chipsIn, ch->chipPos);
+    ENGINE_STORE_RELAXED(&ch->stats.preambles, ch->dec.stats.preambles);
+    ENGINE_STORE_RELAXED(&ch->stats.crcPass, ch->dec.stats.crcPass);
+    ENGINE_STORE_RELAXED(&ch->stats.crcFail, ch->dec.stats.crcFail);
+    ENGINE_STORE_RELAXED(&ch->stats.dropped, ch->dec.stats.dropped);
+    ENGINE_STORE_RELAXED(&ch->stats.filtered, ch->dec.stats.filtered);
+}
+
+// Decode one queued block of a channel. Returns 1 if any work was done.
+static uint8_t amrEngineService(AmrEngineChannel * ch) {
+    if (ch->finished) {
+        return 0;
+    }
+
+    // Leave the block queued until its messages are guaranteed to fit
+    uint32_t outTail = ENGINE_LOAD_ACQUIRE(&ch->outTail);
+    if (AMR_ENGINE_OUT_SLOTS - (ch->outPending - outTail) < AMR_ENGINE_MSGS_PER_BLOCK) {
+        return 0;
+    }
+
+    // Read closed before the queue so the last block can't be missed
+    uint8_t closed = ENGINE_LOAD_ACQUIRE(&ch->closed);
+    uint32_t inHead = ENGINE_LOAD_ACQUIRE(&ch->inHead);
+    if (inHead == ch->inTail) {
+        if (closed) {
+            ch->finished = 1;
+            ENGINE_STORE_RELEASE(&ch->watermark, UINT64_MAX);
+        }
+        return 0;
+    }
+
+    const AmrEngineBlock * blk = &ch->in[ch->inTail & (AMR_ENGINE_IN_SLOTS - 1)];
+    uint32_t bit = 0;
+    for (; bit < blk->nbits; bit += AMR_ENGINE_CHUNK_BITS) {
+        uint32_t n = blk->nbits - bit;
+        if (n > AMR_ENGINE_CHUNK_BITS) {
+            n = AMR_ENGINE_CHUNK_BITS;
+        }
+        amrDecoderProcessBits(&ch->dec, blk->data + bit / 8, n);
+        ch->chipPos += n;
+        amrDecoderProcessMsgs(&ch->dec);
+    }
+
+    // Messages first, then the watermark that vouches for them
+    ENGINE_STORE_RELEASE(&ch->outHead, ch->outPending);
+    ENGINE_STORE_RELEASE(&ch->watermark, ch->chipPos);
+    ENGINE_STORE_RELEASE(&ch->inTail, ch->inTail + 1);
+    amrEnginePublishStats(ch);
+    return 1;
+}
+
+static void * amrEngineWorkerMain(void * arg) {
+    AmrEngineWorker * w = (AmrEngineWorker *)arg;
+    AmrEngine * eng = w->eng;
+
+#ifdef __linux__
+    if (eng->pinWorkers) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(w->idx % CPU_SETSIZE, &cpus);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    }
+#endif
+
+    while (!ENGINE_LOAD_ACQUIRE(&eng->stop)) {
+        uint8_t busy = 0;
+        uint16_t c = w->idx;
+        for (; c < eng->channelCnt; c += eng->workerCnt) {
+            busy |= amrEngineService(&eng->channels[c]);
+        }
+        if (!busy) {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+AmrEngine * amrEngineCreate(const AmrEngineConfig * cfg) {
+    if (cfg == NULL || cfg->channels == 0 || cfg->channels > AMR_ENGINE_MAX_CHANNELS) {
+        return NULL;
+    }
+
+    AmrEngine * eng = (AmrEngine *)calloc(1, sizeof(AmrEngine));
+    if (eng == NULL) {
+        return NULL;
+    }
+
+    eng->channelCnt = cfg->channels;
+    eng->workerCnt = cfg->workers == 0 || cfg->workers > cfg->channels ?
+        cfg->channels : cfg->workers;
+    eng->pinWorkers = cfg->pinWorkers;
+
+    void * channels = NULL;
+    if (posix_memalign(&channels, AMR_ENGINE_CACHE_LINE,
+                eng->channelCnt * sizeof(AmrEngineChannel)) != 0) {
+        free(eng);
+        return NULL;
+    }
+    eng->channels = (AmrEngineChannel *)channels;
+    memset(eng->channels, 0, eng->channelCnt * sizeof(AmrEngineChannel));
+
+    uint16_t c = 0;
+    for (; c < eng->channelCnt; ++c) {
+        AmrEngineChannel * ch = &eng->channels[c];
+        ch->id = c;
+        amrDecoderInit(&ch->dec);
+        amrDecoderRegisterMsgCallback(&ch->dec, amrEngineMsgCallback, ch);
+        amrDecoderSetEarlyCrc(&ch->dec, cfg->earlyCrc);
+        amrDecoderSetIdFilter(&ch->dec, cfg->idFilter);
+    }
+
+    eng->workers = (AmrEngineWorker *)calloc(eng->workerCnt, sizeof(AmrEngineWorker));
+    if (eng->workers == NULL) {
+        amrEngineDestroy(eng);
+        return NULL;
+    }
+
+    for (; eng->workersStarted < eng->workerCnt; ++eng->workersStarted) {
+        AmrEngineWorker * w = &eng->workers[eng->workersStarted];
+        w->eng = eng;
+        w->idx = eng->workersStarted;
+        if (pthread_create(&w->thread, NULL, amrEngineWorkerMain, w) != 0) {
+            amrEngineDestroy(eng);
+            return NULL;
+        }
+    }
+
+    return eng;
+}
+
+void amrEngineDestroy(AmrEngine * eng) {
+    if (eng == NULL) {
+        return;
+    }
+
+    ENGINE_STORE_RELEASE(&eng->stop, 1);
+    uint16_t w = 0;
+    for (; w < eng->workersStarted; ++w) {
+        pthread_join(eng->workers[w].thread, NULL);
+    }
+
+    free(eng->workers);
+    free(eng->channels);
+    free(eng);
+}
+
+size_t amrEnginePush(AmrEngine * eng, uint16_t channel, const uint8_t * packed, size_t nbits) {
+    if (eng == NULL || packed == NULL || channel >= eng->channelCnt) {
+        return 0;
+    }
+
+    AmrEngineChannel * ch = &eng->channels[channel];
+    uint32_t head = ch->inHead;
+    uint32_t tail = ENGINE_LOAD_ACQUIRE(&ch->inTail);
+    size_t done = 0;
+    while (done < nbits && head - tail < AMR_ENGINE_IN_SLOTS) {
+        size_t n = nbits - done;
+        if (n > AMR_ENGINE_BLOCK_BYTES * 8) {
+            n = AMR_ENGINE_BLOCK_BYTES * 8;
+        }
+        AmrEngineBlock * blk = &ch->in[head & (AMR_ENGINE_IN_SLOTS - 1)];
+        memcpy(blk->data, packed + done / 8, (n + 7) / 8);
+        blk->nbits = (uint32_t)n;
+        ++head;
+        done += n;
+    }
+
+    ENGINE_STORE_RELEASE(&ch->inHead, head);
+    return done;
+}
+
+void amrEngineClose(AmrEngine * eng, uint16_t channel) {
+    if (eng == NULL || channel >= eng->channelCnt) {
+        return;
+    }
+    ENGINE_STORE_RELEASE(&eng->channels[channel].closed, 1);
+}
+
+uint8_t amrEnginePoll(AmrEngine * eng, AmrEngineMsg * out) {
+    if (eng == NULL || out == NULL) {
+        return 0;
+    }
+
+    // A channel's messages are in timestamp order, and once it has no queued
+    // message its next one will be later than its watermark. The earliest
+    // queued message is next in the merged stream once it isn't later than
+    // the watermark of any channel with an empty output queue.
+    AmrEngineChannel * best = NULL;
+    uint64_t bestTs = UINT64_MAX;
+    uint64_t bound = UINT64_MAX;
+    uint16_t c = 0;
+    for (; c < eng->channelCnt; ++c) {
+        AmrEngineChannel * ch = &eng->channels[c];
+        // Watermark before the queue, so a message published after the read
+        // is always later than the watermark
+        uint64_t watermark = ENGINE_LOAD_ACQUIRE(&ch->watermark);
+        uint32_t head = ENGINE_LOAD_ACQUIRE(&ch->outHead);
+        if (head != ch->outTail) {
+            uint64_t ts = ch->out[ch->outTail & (AMR_ENGINE_OUT_SLOTS - 1)].timestamp;
+            if (ts < bestTs) {
+                bestTs = ts;
+                best = ch;
+            }
+        }
+        else if (watermark < bound) {
+            bound = watermark;
+        }
+    }
+
+    if (best == NULL || bestTs > bound) {
+        return 0;
+    }
+
+    memcpy(out, &best->out[best->outTail & (AMR_ENGINE_OUT_SLOTS - 1)], sizeof(*out));
+    ENGINE_STORE_RELEASE(&best->outTail, best->outTail + 1);
+    return 1;
+}
+
+uint8_t amrEngineDone(AmrEngine * eng) {
+    if (eng == NULL) {
+        return 1;
+    }
+
+    uint16_t c = 0;
+    for (; c < eng->channelCnt; ++c) {
+        AmrEngineChannel * ch = &eng->channels[c];
+        if (ENGINE_LOAD_ACQUIRE(&ch->watermark) != UINT64_MAX ||
+                ENGINE_LOAD_ACQUIRE(&ch->outHead) != ch->outTail) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void amrEngineChannelStats(AmrEngine * eng, uint16_t channel, AmrEngineChannelStats * stats) {
+    if (eng == NULL || stats == NULL || channel >= eng->channelCnt) {
+        return;
+    }
+
+    AmrEngineChannel * ch = &eng->channels[channel];
+    stats->chipsIn = ENGINE_LOAD_RELAXED(&ch->stats.chipsIn);
+    stats->preambles = ENGINE_LOAD_RELAXED(&ch->stats.preambles);
+    stats->crcPass = ENGINE_LOAD_RELAXED(&ch->stats.crcPass);
+    stats->crcFail = ENGINE_LOAD_RELAXED(&ch->stats.crcFail);
+    stats->dropped = ENGINE_LOAD_RELAXED(&ch->stats.dropped);
+    stats->filtered = ENGINE_LOAD_RELAXED(&ch->stats.filtered);
+}
@@ -0,0 +1,78 @@
+#ifndef AMR_ENGINE_H
+#define AMR_ENGINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "amr.h"
+
+// Multi-channel decode engine for host builds. Every channel (e.g. one ERT hop
+// channel of a channelized wideband capture) runs its own AmrDecoder. Channels
+// are statically assigned to worker threads and fed through lock-free
+// single-producer/single-consumer queues, so workers never share state and
+// throughput scales with the number of cores.
+//
+// Decoded messages are merged into a single stream ordered by timestamp. The
+// timestamp is the chip index, on the channel's own timeline, of the chip that
+// completed the frame. Channels of one capture share a chip clock, so for an
+// ordered merge the producer must feed all channels in roughly equal chip
+// increments.
+
+#define AMR_ENGINE_MAX_CHANNELS 256
+#define AMR_ENGINE_BLOCK_BYTES 512 //! Chip bytes per input queue slot
+#define AMR_ENGINE_IN_SLOTS 64 //! Input queue depth per channel, power of 2
+#define AMR_ENGINE_OUT_SLOTS 256 //! Output queue depth per channel, power of 2
+
+typedef struct {
+    uint64_t timestamp; //! Chip index of the chip that completed the frame
+    uint16_t channel;
+    AMR_MSG_TYPE type;
+    union {
+        AmrScmMsg scm;
+        AmrScmPlusMsg scmPlus;
+        AmrIdmMsg idm;
+    } msg;
+    uint8_t data[AMR_MAX_MSG_SIZE]; //! Raw frame
+} AmrEngineMsg;
+
+typedef struct {
+    uint64_t chipsIn; //! Chips decoded so far
+    uint32_t preambles;
+    uint32_t crcPass;
+    uint32_t crcFail;
+    uint32_t dropped;
+    uint32_t filtered; //! Frames from meters rejected by the ID filter
+} AmrEngineChannelStats;
+
+typedef struct {
+    uint16_t channels;
+    uint16_t workers; //! Worker threads, 0 for one per channel
+    uint8_t pinWorkers; //! Pin worker n to CPU n (Linux only)
+    uint8_t earlyCrc; //! See amrDecoderSetEarlyCrc
+    const AmrIdFilter * idFilter; //! Shared by all channels, see amrDecoderSetIdFilter
+} AmrEngineConfig;
+
+typedef struct AmrEngine AmrEngine;
+
+// Allocate the engine and start its workers. Returns NULL on failure.
+AmrEngine * amrEngineCreate(const AmrEngineConfig * cfg);
+// Stop and join the workers and free the engine
+void amrEngineDestroy(AmrEngine * eng);
+
+// Queue chips packed MSB first for a channel. Only one thread may push to a
+// given channel. Returns the number of chips accepted, which is less than
+// nbits when the channel's input queue is full. Every push except the last
+// one of a channel must be a multiple of 8 chips.
+size_t amrEnginePush(AmrEngine * eng, uint16_t channel, const uint8_t * packed, size_t nbits);
+// Mark the end of a channel's bitstream
+void amrEngineClose(AmrEngine * eng, uint16_t channel);
+
+// Pop the next message of the merged output stream. Must only be called from
+// one thread. Returns 1 when a message was written to out, 0 when the next
+// message isn't known yet.
+uint8_t amrEnginePoll(AmrEngine * eng, AmrEngineMsg * out);
+// Returns 1 once every channel is closed, fully decoded and polled
+uint8_t amrEngineDone(AmrEngine * eng);
+
+void amrEngineChannelStats(AmrEngine * eng, uint16_t channel, AmrEngineChannelStats * stats);
+
+#endif
@@ -0,0 +1,58 @@
+#include "amr_filter.h"
+#include <string.h>
+
+uint8_t amrIdFilterInit(AmrIdFilter * filter, uint32_t * slots, size_t nslots,
+        AMR_FILTER_MODE mode) {
+    if (filter == NULL || slots == NULL || nslots < 4 || nslots > 0x80000000u ||
+            (nslots & (nslots - 1)) != 0) {
+        return 0;
+    }
+
+    filter->slots = slots;
+    filter->mask = (uint32_t)(nslots - 1);
+    filter->shift = 32;
+    while (nslots > 1) {
+        --filter->shift;
+        nslots >>= 1;
+    }
+    filter->mode = mode;
+    amrIdFilterClear(filter);
+    return 1;
+}
+
+uint8_t amrIdFilterAdd(AmrIdFilter * filter, uint32_t id) {
+    if (filter == NULL) {
+        return 0;
+    }
+
+    if (amrIdFilterContains(filter, id)) {
+        return 1;
+    }
+    // Keep a quarter of the slots empty so probes stay short and terminate
+    if (filter->count + 1 > (filter->mask + 1) / 4 * 3) {
+        return 0;
+    }
+
+    ++filter->count;
+    if (id == 0) {
+        filter->hasZero = 1;
+        return 1;
+    }
+
+    uint32_t i = amrIdFilterSlot(filter, id);
+    while (filter->slots[i] != 0) {
+        i = (i + 1) & filter->mask;
+    }
+    filter->slots[i] = id;
+    return 1;
+}
+
+void amrIdFilterClear(AmrIdFilter * filter) {
+    if (filter == NULL) {
+        return;
+    }
+
+    memset(filter->slots, 0, ((size_t)filter->mask + 1) * sizeof(filter->slots[0]));
+    filter->hasZero = 0;
+    filter->count = 0;
+}
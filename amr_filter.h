@@ -0,0 +1,65 @@
+#ifndef AMR_FILTER_H
+#define AMR_FILTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum {
+    AMR_FILTER_OFF = 0, //! Every meter passes
+    AMR_FILTER_ALLOW, //! Only meters in the set pass
+    AMR_FILTER_DENY //! Meters in the set are dropped
+} AMR_FILTER_MODE;
+
+// Meter ID set for early rejection in the decode path: open addressing with
+// linear probing over caller provided storage. A zero slot is empty, ID 0 is
+// tracked separately. Lookups only read the struct, so one filter can be
+// shared by decoders on several threads as long as nobody adds to it.
+typedef struct {
+    uint32_t * slots;
+    uint32_t mask; //! Slot count - 1, the slot count is a power of two
+    uint8_t shift; //! 32 - log2(slot count), selects the hash bits
+    uint8_t hasZero;
+    uint8_t mode; //! AMR_FILTER_MODE
+    uint32_t count; //! IDs in the set, ID 0 included
+} AmrIdFilter;
+
+// nslots must be a power of two and at least 4. The set holds up to 3/4 of
+// nslots IDs. Returns 0 on invalid arguments.
+uint8_t amrIdFilterInit(AmrIdFilter * filter, uint32_t * slots, size_t nslots,
+        AMR_FILTER_MODE mode);
+// Returns 0 when the set is full
+uint8_t amrIdFilterAdd(AmrIdFilter * filter, uint32_t id);
+void amrIdFilterClear(AmrIdFilter * filter);
+
+// Home slot of id. Fibonacci hashing, the top bits of the product pick the slot.
+static inline uint32_t amrIdFilterSlot(const AmrIdFilter * filter, uint32_t id) {
+    return (id * 0x9e3779b1u) >> filter->shift;
+}
+
+static inline uint8_t amrIdFilterContains(const AmrIdFilter * filter, uint32_t id) {
+    if (id == 0) {
+        return filter->hasZero;
+    }
+
+    uint32_t i = amrIdFilterSlot(filter, id);
+    while (1) {
+        uint32_t slot = filter->slots[i];
+        if (slot == id) {
+            return 1;
+        }
+        if (slot == 0) {
+            return 0;
+        }
+        i = (i + 1) & filter->mask;
+    }
+}
+
+// Returns 1 when meter id passes filter. A NULL filter passes everything.
+static inline uint8_t amrIdFilterPass(const AmrIdFilter * filter, uint32_t id) {
+    if (filter == NULL || filter->mode == AMR_FILTER_OFF) {
+        return 1;
+    }
+    return amrIdFilterContains(filter, id) == (filter->mode == AMR_FILTER_ALLOW);
+}
+
+#endif
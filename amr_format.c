@@ -0,0 +1,353 @@
+#include "amr_format.h"
+#include <string.h>
+
+// Output cursor, end is pulled back to p on the first overflow so every later
+// append fails too and the encoder only checks once at the end
+typedef struct {
+    char * p;
+    char * end;
+    uint8_t ok;
+} FmtBuf;
+
+static const char fmtDigits[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static inline void fmtInit(FmtBuf * b, char * buf, size_t size) {
+    b->p = buf;
+    b->end = buf + size;
+    b->ok = buf != NULL;
+    if (buf == NULL) {
+        b->end = NULL;
+    }
+}
+
+static inline void fmtPut(FmtBuf * b, const char * s, size_t n) {
+    if ((size_t)(b->end - b->p) < n) {
+        b->end = b->p;
+        b->ok = 0;
+        return;
+    }
+    memcpy(b->p, s, n);
+    b->p += n;
+}
+
+#define fmtPutLit(b, s) fmtPut((b), (s), sizeof(s) - 1)
+
+static inline void fmtPutChar(FmtBuf * b, char c) {
+    fmtPut(b, &c, 1);
+}
+
+// Writes the digits of v right aligned ending at end, two at a time from the
+// pair table, and returns the first one
+static inline char * fmtU32(char * end, uint32_t v) {
+    while (v >= 100) {
+        uint32_t i = (v % 100) * 2;
+        v /= 100;
+        end -= 2;
+        memcpy(end, fmtDigits + i, 2);
+    }
+    if (v >= 10) {
+        end -= 2;
+        memcpy(end, fmtDigits + v * 2, 2);
+    }
+    else {
+        *--end = (char)('0' + v);
+    }
+    return end;
+}
+
+static inline char * fmtU64(char * end, uint64_t v) {
+    // Peel off 8 digit groups with 64-bit divides, the rest is 32-bit
+    while (v > 0xffffffffu) {
+        uint32_t lo = (uint32_t)(v % 100000000u);
+        char * stop = end - 8;
+        v /= 100000000u;
+        end = fmtU32(end, lo);
+        while (end > stop) {
+            *--end = '0';
+        }
+    }
+    return fmtU32(end, (uint32_t)v);
+}
+
+static inline void fmtPutU32(FmtBuf * b, uint32_t v) {
+    char tmp[10];
+    char * s = fmtU32(tmp + sizeof(tmp), v);
+    fmtPut(b, s, (size_t)(tmp + sizeof(tmp) - s));
+}
+
+static inline void fmtPutU64(FmtBuf * b, uint64_t v) {
+    char tmp[20];
+    char * s = fmtU64(tmp + sizeof(tmp), v);
+    fmtPut(b, s, (size_t)(tmp + sizeof(tmp) - s));
+}
+
+static inline void fmtPutList(FmtBuf * b, const uint16_t * vals, uint8_t cnt, char sep) {
+    uint8_t i = 0;
+    for (; i < cnt; ++i) {
+        if (i) {
+            fmtPutChar(b, sep);
+        }
+        fmtPutU32(b, vals[i]);
+    }
+}
+
+static inline size_t fmtDone(FmtBuf * b, char * buf) {
+    return b->ok ? (size_t)(b->p - buf) : 0;
+}
+
+size_t amrFormatJson(char * buf, size_t size, AMR_MSG_TYPE type, const void * msg, uint64_t time) {
+    FmtBuf b;
+    if (msg == NULL) {
+        return 0;
+    }
+
+    fmtInit(&b, buf, size);
+    fmtPutLit(&b, "{\"Time\":");
+    fmtPutU64(&b, time);
+    switch (type) {
+        case AMR_MSG_TYPE_SCM: {
+            const AmrScmMsg * scm = (const AmrScmMsg *)msg;
+            fmtPutLit(&b, ",\"Type\":\"SCM\",\"Message\":{\"ID\":");
+            fmtPutU32(&b, scm->id);
+            fmtPutLit(&b, ",\"Type\":");
+            fmtPutU32(&b, scm->type);
+            fmtPutLit(&b, ",\"TamperPhy\":");
+            fmtPutU32(&b, scm->tamper_phy);
+            fmtPutLit(&b, ",\"TamperEnc\":");
+            fmtPutU32(&b, scm->tamper_enc);
+            fmtPutLit(&b, ",\"Consumption\":");
+            fmtPutU32(&b, scm->consumption);
+            fmtPutLit(&b, ",\"ChecksumVal\":");
+            fmtPutU32(&b, scm->crc);
+        }
+        break;
+        case AMR_MSG_TYPE_SCM_PLUS: {
+            const AmrScmPlusMsg * scmPlus = (const AmrScmPlusMsg *)msg;
+            fmtPutLit(&b, ",\"Type\":\"SCM+\",\"Message\":{\"FrameSync\":");
+            fmtPutU32(&b, scmPlus->frameSync);
+            fmtPutLit(&b, ",\"ProtocolID\":");
+            fmtPutU32(&b, scmPlus->protocolId);
+            fmtPutLit(&b, ",\"EndpointType\":");
+            fmtPutU32(&b, scmPlus->endpointType);
+            fmtPutLit(&b, ",\"EndpointID\":");
+            fmtPutU32(&b, scmPlus->endpointId);
+            fmtPutLit(&b, ",\"Consumption\":");
+            fmtPutU32(&b, scmPlus->consumption);
+            fmtPutLit(&b, ",\"Tamper\":");
+            fmtPutU32(&b, scmPlus->tamper);
+            fmtPutLit(&b, ",\"PacketCRC\":");
+            fmtPutU32(&b, scmPlus->crc);
+        }
+        break;
+        case AMR_MSG_TYPE_IDM: {
+            const AmrIdmMsg * idm = (const AmrIdmMsg *)msg;
+            fmtPutLit(&b, ",\"Type\":\"IDM\",\"Message\":{\"ERTType\":");
+            fmtPutU32(&b, idm->ertType);
+            fmtPutLit(&b, ",\"ERTSerialNumber\":");
+            fmtPutU32(&b, idm->ertId);
+            fmtPutLit(&b, ",\"ConsumptionIntervalCount\":");
+            fmtPutU32(&b, idm->consumptionIntervalCount);
+            if (idm->ertType == 0x18) {
+                fmtPutLit(&b, ",\"LastConsumptionCount\":");
+                fmtPutU32(&b, idm->data.x18.lastConsumption);
+                fmtPutLit(&b, ",\"LastExcess\":");
+                fmtPutU32(&b, idm->data.x18.lastExcess);
+                fmtPutLit(&b, ",\"LastResidual\":");
+                fmtPutU32(&b, idm->data.x18.lastResidual);
+                fmtPutLit(&b, ",\"LastConsumptionHighRes\":");
+                fmtPutU32(&b, idm->data.x18.lastConsumptionHighRes);
+                fmtPutLit(&b, ",\"DifferentialConsumptionIntervals\":[");
+                fmtPutList(&b, idm->data.x18.differentialConsumption, 27, ',');
+            }
+            else {
+                fmtPutLit(&b, ",\"ModuleProgrammingState\":");
+                fmtPutU32(&b, idm->data.std.moduleProgrammingState);
+                fmtPutLit(&b, ",\"LastConsumptionCount\":");
+                fmtPutU32(&b, idm->data.std.lastConsumption);
+                fmtPutLit(&b, ",\"DifferentialConsumptionIntervals\":[");
+                fmtPutList(&b, idm->data.std.differentialConsumption, 47, ',');
+            }
+            fmtPutLit(&b, "],\"TransmitTimeOffset\":");
+            fmtPutU32(&b, idm->txTimeOffset);
+            fmtPutLit(&b, ",\"SerialNumberCRC\":");
+            fmtPutU32(&b, idm->serialNumberCRC);
+            fmtPutLit(&b, ",\"PacketCRC\":");
+            fmtPutU32(&b, idm->pktCRC);
+        }
+        break;
+        default:
+            return 0;
+    }
+    fmtPutLit(&b, "}}\n");
+    return fmtDone(&b, buf);
+}
+
+size_t amrFormatCsv(char * buf, size_t size, AMR_MSG_TYPE type, const void * msg, uint64_t time) {
+    FmtBuf b;
+    if (msg == NULL) {
+        return 0;
+    }
+
+    fmtInit(&b, buf, size);
+    fmtPutU64(&b, time);
+    switch (type) {
+        case AMR_MSG_TYPE_SCM: {
+            const AmrScmMsg * scm = (const AmrScmMsg *)msg;
+            fmtPutLit(&b, ",SCM,");
+            fmtPutU32(&b, scm->id);
+            fmtPutChar(&b, ',');
+            fmtPutU32(&b, scm->type);
+            fmtPutChar(&b, ',');
+            fmtPutU32(&b, scm->consumption);
+            fmtPutChar(&b, ',');
+            fmtPutU32(&b, ((uint32_t)scm->tamper_phy << 2) | scm->tamper_enc);
+            fmtPutChar(&b, ',');
+        }
+        break;
+        case AMR_MSG_TYPE_SCM_PLUS: {
+            const AmrScmPlusMsg * scmPlus = (const AmrScmPlusMsg *)msg;
+            fmtPutLit(&b, ",SCM+,");
+            fmtPutU32(&b, scmPlus->endpointId);
+            fmtPutChar(&b, ',');
+            fmtPutU32(&b, scmPlus->endpointType);
+            fmtPutChar(&b, ',');
+            fmtPutU32(&b, scmPlus->consumption);
+            fmtPutChar(&b, ',');
+            fmtPutU32(&b, scmPlus->tamper);
+            fmtPutChar(&b, ',');
+        }
+        break;
+        case AMR_MSG_TYPE_IDM: {
+            const AmrIdmMsg * idm = (const AmrIdmMsg *)msg;
+            uint8_t x18 = idm->ertType == 0x18;
+            fmtPutLit(&b, ",IDM,");
+            fmtPutU32(&b, idm->ertId);
+            fmtPutChar(&b, ',');
+            fmtPutU32(&b, idm->ertType);
+            fmtPutChar(&b, ',');
+            fmtPutU32(&b, x18 ? idm->data.x18.lastConsumption : idm->data.std.lastConsumption);
+            fmtPutLit(&b, ",,");
+            if (x18) {
+                fmtPutList(&b, idm->data.x18.differentialConsumption, 27, ' ');
+            }
+            else {
+                fmtPutList(&b, idm->data.std.differentialConsumption, 47, ' ');
+            }
+        }
+        break;
+        default:
+            return 0;
+    }
+    fmtPutChar(&b, '\n');
+    return fmtDone(&b, buf);
+}
+
+static inline void putLe16(uint8_t * p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void putLe32(uint8_t * p, uint32_t v) {
+    putLe16(p, (uint16_t)v);
+    putLe16(p + 2, (uint16_t)(v >> 16));
+}
+
+static inline void putLe64(uint8_t * p, uint64_t v) {
+    putLe32(p, (uint32_t)v);
+    putLe32(p + 4, (uint32_t)(v >> 32));
+}
+
+static inline void putRecordHeader(uint8_t * p, AMR_MSG_TYPE type, size_t size,
+        uint32_t meterId, uint64_t time) {
+    p[offsetof(AmrRecordHeader, version)] = AMR_RECORD_VERSION;
+    p[offsetof(AmrRecordHeader, type)] = (uint8_t)type;
+    putLe16(p + offsetof(AmrRecordHeader, size), (uint16_t)size);
+    putLe32(p + offsetof(AmrRecordHeader, meterId), meterId);
+    putLe64(p + offsetof(AmrRecordHeader, time), time);
+}
+
+size_t amrFormatBinary(uint8_t * buf, size_t size, AMR_MSG_TYPE type, const void * msg, uint64_t time) {
+    const size_t hdrLen = sizeof(AmrRecordHeader);
+    uint8_t * p;
+    size_t len;
+    if (buf == NULL || msg == NULL) {
+        return 0;
+    }
+    p = buf + hdrLen;
+
+    switch (type) {
+        case AMR_MSG_TYPE_SCM: {
+            const AmrScmMsg * scm = (const AmrScmMsg *)msg;
+            len = hdrLen + sizeof(AmrScmRecord);
+            if (size < len) {
+                return 0;
+            }
+            putRecordHeader(buf, type, len, scm->id, time);
+            putLe32(p + offsetof(AmrScmRecord, consumption), scm->consumption);
+            p[offsetof(AmrScmRecord, ertType)] = scm->type;
+            p[offsetof(AmrScmRecord, tamperPhy)] = scm->tamper_phy;
+            p[offsetof(AmrScmRecord, tamperEnc)] = scm->tamper_enc;
+            p[offsetof(AmrScmRecord, reserved)] = 0;
+        }
+        break;
+        case AMR_MSG_TYPE_SCM_PLUS: {
+            const AmrScmPlusMsg * scmPlus = (const AmrScmPlusMsg *)msg;
+            len = hdrLen + sizeof(AmrScmPlusRecord);
+            if (size < len) {
+                return 0;
+            }
+            putRecordHeader(buf, type, len, scmPlus->endpointId, time);
+            putLe32(p + offsetof(AmrScmPlusRecord, consumption), scmPlus->consumption);
+            putLe16(p + offsetof(AmrScmPlusRecord, tamper), scmPlus->tamper);
+            p[offsetof(AmrScmPlusRecord, protocolId)] = scmPlus->protocolId;
+            p[offsetof(AmrScmPlusRecord, endpointType)] = scmPlus->endpointType;
+        }
+        break;
+        case AMR_MSG_TYPE_IDM: {
+            const AmrIdmMsg * idm = (const AmrIdmMsg *)msg;
+            uint8_t x18 = idm->ertType == 0x18;
+            const uint16_t * diff = x18 ? idm->data.x18.differentialConsumption :
+                    idm->data.std.differentialConsumption;
+            uint8_t cnt = x18 ? 27 : 47;
+            uint8_t * out = p + offsetof(AmrIdmRecord, differentialConsumption);
+            uint8_t i = 0;
+            len = hdrLen + sizeof(AmrIdmRecord);
+            if (size < len) {
+                return 0;
+            }
+            putRecordHeader(buf, type, len, idm->ertId, time);
+            putLe32(p + offsetof(AmrIdmRecord, lastConsumption),
+                    x18 ? idm->data.x18.lastConsumption : idm->data.std.lastConsumption);
+            putLe16(p + offsetof(AmrIdmRecord, txTimeOffset), idm->txTimeOffset);
+            p[offsetof(AmrIdmRecord, ertType)] = idm->ertType;
+            p[offsetof(AmrIdmRecord, intervalCount)] = idm->consumptionIntervalCount;
+            p[offsetof(AmrIdmRecord, intervals)] = cnt;
+            memset(p + offsetof(AmrIdmRecord, reserved), 0, sizeof(((AmrIdmRecord *)0)->reserved));
+            for (; i < cnt; ++i) {
+                putLe16(out + 2 * i, diff[i]);
+            }
+            memset(out + 2 * cnt, 0, 2 * (47 - cnt));
+        }
+        break;
+        default:
+            return 0;
+    }
+    return len;
+}
+
+size_t amrFormat(AMR_FORMAT fmt, uint8_t * buf, size_t size, AMR_MSG_TYPE type,
+        const void * msg, uint64_t time) {
+    switch (fmt) {
+        case AMR_FORMAT_JSON:
+            return amrFormatJson((char *)buf, size, type, msg, time);
+        case AMR_FORMAT_CSV:
+            return amrFormatCsv((char *)buf, size, type, msg, time);
+        case AMR_FORMAT_BINARY:
+            return amrFormatBinary(buf, size, type, msg, time);
+        default:
+            return 0;
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef AMR_FORMAT_H
+#define AMR_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "amr.h"
+
+// Message encoders that render into a caller buffer. Integers are converted
+// by hand, there is no printf, locale or allocation, so they are safe to call
+// from any thread. Each returns the number of bytes written, or 0 when the
+// message doesn't fit in size bytes or type is unknown. Text output is not
+// NUL terminated. time is caller defined, e.g. a Unix time in ms or the
+// header timestamp, and is written as is.
+
+#define AMR_FORMAT_MAX_LEN 1024 //! Buffer size that fits any message in any format
+
+typedef enum {
+    AMR_FORMAT_JSON = 0,
+    AMR_FORMAT_CSV,
+    AMR_FORMAT_BINARY,
+    AMR_FORMAT_CNT
+} AMR_FORMAT;
+
+// One JSON object per line, shaped like rtlamr output:
+// {"Time":T,"Type":"SCM","Message":{...}}\n
+size_t amrFormatJson(char * buf, size_t size, AMR_MSG_TYPE type, const void * msg, uint64_t time);
+
+// One row per message under AMR_FORMAT_CSV_HEADER. ert_type is the endpoint
+// type for SCM+. SCM tamper is (phy << 2) | enc. intervals holds the IDM
+// differential consumption intervals separated by spaces.
+#define AMR_FORMAT_CSV_HEADER "time,type,id,ert_type,consumption,tamper,intervals\n"
+size_t amrFormatCsv(char * buf, size_t size, AMR_MSG_TYPE type, const void * msg, uint64_t time);
+
+// Fixed width little endian record, AmrRecordHeader followed by the payload
+// struct of the message type. Records can be read back by casting on little
+// endian hosts.
+#define AMR_RECORD_VERSION 1
+
+#pragma pack(push, 1)
+typedef struct {
+    uint8_t version; //! AMR_RECORD_VERSION
+    uint8_t type; //! AMR_MSG_TYPE
+    uint16_t size; //! Record bytes, header included
+    uint32_t meterId;
+    uint64_t time;
+} AmrRecordHeader;
+
+typedef struct {
+    uint32_t consumption;
+    uint8_t ertType;
+    uint8_t tamperPhy;
+    uint8_t tamperEnc;
+    uint8_t reserved;
+} AmrScmRecord;
+
+typedef struct {
+    uint32_t consumption;
+    uint16_t tamper;
+    uint8_t protocolId;
+    uint8_t endpointType;
+} AmrScmPlusRecord;
+
+typedef struct {
+    uint32_t lastConsumption;
+    uint16_t txTimeOffset;
+    uint8_t ertType;
+    uint8_t intervalCount; //! consumptionIntervalCount of the message
+    uint8_t intervals; //! Valid entries of differentialConsumption, 47 or 27 for type 0x18
+    uint8_t reserved[3];
+    uint16_t differentialConsumption[47];
+} AmrIdmRecord;
+#pragma pack(pop)
+
+size_t amrFormatBinary(uint8_t * buf, size_t size, AMR_MSG_TYPE type, const void * msg, uint64_t time);
+
+// Dispatch to the encoder for fmt
+size_t amrFormat(AMR_FORMAT fmt, uint8_t * buf, size_t size, AMR_MSG_TYPE type,
+        const void * msg, uint64_t time);
+
+#endif
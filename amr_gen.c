@@ -0,0 +1,265 @@
+#include "amr_gen.h"
+#include "amr_crc.h"
+#include <math.h>
+#include <string.h>
+
+static inline uint64_t genRand(AmrGen * gen) {
+    // xorshift64*
+    gen->rng ^= gen->rng >> 12;
+    gen->rng ^= gen->rng << 25;
+    gen->rng ^= gen->rng >> 27;
+    return gen->rng * 0x2545f4914f6cdd1dull;
+}
+
+// Uniform in (0, 1]
+static inline double genUniform(AmrGen * gen) {
+    return ((genRand(gen) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+static inline void genPut32(uint8_t * p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static inline void genPut16(uint8_t * p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+size_t amrGenScm(uint8_t * f, uint32_t id, uint8_t ertType, uint8_t tamper, uint32_t consumption) {
+    memset(f, 0, AMR_MSG_SCM_RAW_SIZE);
+    f[0] = 0xf9;
+    f[1] = 0x53;
+    f[2] = ((id >> 23) & 0x6) | 0x01;
+    f[3] = (uint8_t)((((tamper >> 2) & 0x3) << 6) | ((ertType & 0xf) << 2) | (tamper & 0x3));
+    f[4] = (uint8_t)(consumption >> 16);
+    f[5] = (uint8_t)(consumption >> 8);
+    f[6] = (uint8_t)consumption;
+    f[7] = (uint8_t)(id >> 16);
+    f[8] = (uint8_t)(id >> 8);
+    f[9] = (uint8_t)id;
+    genPut16(f + 10, amrCrc16(AMR_CRC_BCH, 0, f + 2, 8));
+    return AMR_MSG_SCM_RAW_SIZE;
+}
+
+size_t amrGenScmPlus(uint8_t * f, uint32_t id, uint8_t endpointType, uint16_t tamper, uint32_t consumption) {
+    f[0] = 0x16;
+    f[1] = 0xa3;
+    f[2] = 0x1e;
+    f[3] = endpointType;
+    genPut32(f + 4, id);
+    genPut32(f + 8, consumption);
+    genPut16(f + 12, tamper);
+    genPut16(f + 14, (uint16_t)~amrCrc16(AMR_CRC_CCITT, 0xffff, f + 2, 12));
+    return AMR_MSG_SCM_PLUS_RAW_SIZE;
+}
+
+size_t amrGenIdm(uint8_t * f, uint32_t id, uint8_t ertType, uint32_t lastConsumption,
+        const uint16_t * intervals) {
+    uint16_t n = 0;
+    memset(f, 0, AMR_MSG_IDM_RAW_SIZE);
+    f[0] = 0x55;
+    f[1] = 0x55;
+    f[2] = 0x16;
+    f[3] = 0xa3;
+    f[4] = 0x1c;
+    f[5] = 0x5c;
+    f[8] = ertType;
+    genPut32(f + 9, id);
+    genPut32(f + 29, lastConsumption);
+    // 47 differential intervals 9 bits wide
+    for (; intervals && n < 47; ++n) {
+        uint16_t b = 0;
+        for (; b < 9; ++b) {
+            uint16_t bit = n * 9 + b;
+            if (intervals[n] & (1u << (8 - b))) {
+                f[AMR_MSG_IDM_INTERVALS_OFFSET + bit / 8] |= (uint8_t)(0x80 >> (bit % 8));
+            }
+        }
+    }
+    genPut16(f + 90, (uint16_t)~amrCrc16(AMR_CRC_CCITT, 0xffff, f + 4, 86));
+    return AMR_MSG_IDM_RAW_SIZE;
+}
+
+static inline uint64_t genGap(AmrGen * gen) {
+    double gap = -log(genUniform(gen)) * gen->meanGap;
+    return gap < 1.0 ? 1 : gap > 1e18 ? (uint64_t)1e18 : (uint64_t)gap;
+}
+
+static inline uint64_t genErrorGap(AmrGen * gen) {
+    if (gen->errorScale <= 0) {
+        return UINT64_MAX / 2;
+    }
+    double gap = floor(-log(genUniform(gen)) * gen->errorScale) + 1;
+    return gap > 1e18 ? (uint64_t)1e18 : (uint64_t)gap;
+}
+
+// Pick, build and Manchester encode the next frame, 1 -> 10 and 0 -> 01
+static void genStartFrame(AmrGen * gen, uint64_t start) {
+    uint8_t f[AMR_MAX_MSG_SIZE];
+    AmrGenFrame truth;
+    AmrGenActive * a;
+    uint32_t pick = (uint32_t)(genRand(gen) % gen->weightSum);
+    uint64_t r = genRand(gen);
+    size_t len;
+    size_t i = 0;
+
+    truth.start = start;
+    if (pick < gen->cfg.weights[0]) {
+        truth.type = AMR_MSG_TYPE_SCM;
+        truth.id = (uint32_t)r & 0x3ffffff;
+        truth.consumption = (uint32_t)(r >> 32) & 0xffffff;
+        len = amrGenScm(f, truth.id, (uint8_t)(r >> 26) & 0xf, (uint8_t)(r >> 56) & 0xf,
+                truth.consumption);
+    }
+    else if (pick < (uint32_t)gen->cfg.weights[0] + gen->cfg.weights[1]) {
+        truth.type = AMR_MSG_TYPE_SCM_PLUS;
+        truth.id = (uint32_t)r;
+        truth.consumption = (uint32_t)genRand(gen);
+        len = amrGenScmPlus(f, truth.id, (uint8_t)(r >> 32), (uint16_t)(r >> 40), truth.consumption);
+    }
+    else {
+        uint16_t intervals[47];
+        for (; i < 47; ++i) {
+            intervals[i] = (uint16_t)(genRand(gen) >> 55);
+        }
+        truth.type = AMR_MSG_TYPE_IDM;
+        truth.id = (uint32_t)r;
+        truth.consumption = (uint32_t)(r >> 32);
+        len = amrGenIdm(f, truth.id, 0x07, truth.consumption, intervals);
+    }
+    truth.chips = (uint16_t)(len * 16);
+
+    // Reuse the slot of the oldest frame when all are busy
+    if (gen->nactive == AMR_GEN_MAX_ACTIVE) {
+        memmove(&gen->active[0], &gen->active[1], sizeof(gen->active[0]) * (AMR_GEN_MAX_ACTIVE - 1));
+        --gen->nactive;
+    }
+    a = &gen->active[gen->nactive++];
+    a->start = start;
+    a->chips = truth.chips;
+    memset(a->buf, 0, sizeof(a->buf));
+    for (i = 0; i < len; ++i) {
+        uint16_t chips = 0;
+        int b = 7;
+        for (; b >= 0; --b) {
+            chips = (uint16_t)((chips << 2) | (((f[i] >> b) & 1) ? 0x2 : 0x1));
+        }
+        a->buf[8 + 2 * i] = (uint8_t)(chips >> 8);
+        a->buf[8 + 2 * i + 1] = (uint8_t)chips;
+    }
+
+    ++gen->frames;
+    if (gen->callback) {
+        gen->callback(gen->user, &truth);
+    }
+}
+
+// Chips [pos, pos + 64) of a frame, chip pos in the MSB, zeros outside it
+static inline uint64_t genFrameWord(const AmrGenActive * a, int64_t pos) {
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+    size_t bit = (size_t)(pos + 64);
+    size_t byte = bit / 8;
+    uint8_t shift = bit % 8;
+    size_t i = 0;
+    for (; i < 8; ++i) {
+        hi = (hi << 8) | a->buf[byte + i];
+    }
+    lo = a->buf[byte + 8];
+    return shift ? (hi << shift) | (lo >> (8 - shift)) : hi;
+}
+
+// Mask of the word bits [from, to)
+static inline uint64_t genMask(int64_t from, int64_t to) {
+    uint64_t mask;
+    if (from < 0) {
+        from = 0;
+    }
+    if (to > 64) {
+        to = 64;
+    }
+    if (from >= to) {
+        return 0;
+    }
+    mask = to - from == 64 ? ~0ull : ((1ull << (to - from)) - 1) << (64 - to);
+    return mask;
+}
+
+static uint64_t genWord(AmrGen * gen) {
+    uint64_t base = gen->chip;
+    uint64_t word = gen->cfg.randomNoise ? genRand(gen) : 0;
+    uint8_t i = 0;
+
+    while (gen->nextFrame < base + 64) {
+        genStartFrame(gen, gen->nextFrame);
+        gen->nextFrame += genGap(gen);
+    }
+
+    // Later frames overwrite earlier ones where they overlap
+    while (i < gen->nactive) {
+        AmrGenActive * a = &gen->active[i];
+        int64_t from = (int64_t)(a->start - base);
+        int64_t to = from + a->chips;
+        if (a->start >= base + 64) {
+            ++i;
+            continue;
+        }
+        uint64_t mask = genMask(from, to);
+        word = (word & ~mask) | (genFrameWord(a, -from) & mask);
+        if (to <= 64) {
+            memmove(a, a + 1, sizeof(*a) * (gen->nactive - i - 1));
+            --gen->nactive;
+        }
+        else {
+            ++i;
+        }
+    }
+
+    while (gen->nextError < base + 64) {
+        word ^= 1ull << (63 - (gen->nextError - base));
+        gen->nextError += genErrorGap(gen);
+    }
+
+    gen->chip += 64;
+    return word;
+}
+
+uint8_t amrGenInit(AmrGen * gen, const AmrGenConfig * cfg, AmrGenFrameCallback callback, void * user) {
+    if (gen == NULL || cfg == NULL || !(cfg->framesPerSec > 0) ||
+            cfg->chipErrorRate < 0 || cfg->chipErrorRate >= 1) {
+        return 0;
+    }
+
+    memset(gen, 0, sizeof(*gen));
+    gen->cfg = *cfg;
+    if (gen->cfg.chipRate == 0) {
+        gen->cfg.chipRate = AMR_GEN_CHIP_RATE;
+    }
+    if (!gen->cfg.weights[0] && !gen->cfg.weights[1] && !gen->cfg.weights[2]) {
+        gen->cfg.weights[0] = gen->cfg.weights[1] = gen->cfg.weights[2] = 1;
+    }
+    gen->weightSum = (uint16_t)(gen->cfg.weights[0] + gen->cfg.weights[1] + gen->cfg.weights[2]);
+    gen->rng = cfg->seed ? cfg->seed : 0x9e3779b97f4a7c15ull;
+    gen->meanGap = gen->cfg.chipRate / cfg->framesPerSec;
+    gen->errorScale = cfg->chipErrorRate > 0 ? -1.0 / log1p(-cfg->chipErrorRate) : 0;
+    gen->callback = callback;
+    gen->user = user;
+    gen->nextFrame = genGap(gen);
+    gen->nextError = genErrorGap(gen) - 1;
+    return 1;
+}
+
+void amrGenFill(AmrGen * gen, uint8_t * packed, size_t nbits) {
+    size_t bit = 0;
+    for (; bit < nbits; bit += 64) {
+        uint64_t word = genWord(gen);
+        size_t n = nbits - bit < 64 ? (nbits - bit + 7) / 8 : 8;
+        size_t i = 0;
+        for (; i < n; ++i) {
+            packed[bit / 8 + i] = (uint8_t)(word >> (56 - 8 * i));
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef AMR_GEN_H
+#define AMR_GEN_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "amr.h"
+
+// Synthetic ERT chip stream for load and accuracy tests. Frames of random
+// meters with valid CRCs are Manchester encoded and start at Poisson
+// distributed chip positions, so both phases and every bit offset occur.
+// Between frames the stream is random chips or idle zeros. A frame starting
+// before the previous one ended overwrites it from there on, like a
+// collision on the air. Chip errors flip chips independently at a fixed rate.
+
+#define AMR_GEN_CHIP_RATE 32768 //! ERT chips per second
+#define AMR_GEN_MAX_ACTIVE 8 //! Overlapping frames tracked, older ones are cut off
+#define AMR_GEN_MAX_CHIPS (AMR_MAX_MSG_SIZE * 16)
+
+typedef struct {
+    uint64_t seed;
+    double framesPerSec; //! Mean frame rate
+    uint32_t chipRate; //! 0 for AMR_GEN_CHIP_RATE
+    uint8_t weights[3]; //! Relative share of SCM, SCM+ and IDM frames, all 0 for equal shares
+    double chipErrorRate; //! Probability of each chip being flipped
+    uint8_t randomNoise; //! Random chips between frames, otherwise zeros
+} AmrGenConfig;
+
+// Ground truth of a generated frame
+typedef struct {
+    uint64_t start; //! Index of the first chip
+    uint16_t chips; //! Length in chips
+    uint8_t type; //! AMR_MSG_TYPE
+    uint32_t id; //! Meter ID as amrParse* report it
+    uint32_t consumption; //! Consumption, last consumption for IDM
+} AmrGenFrame;
+
+typedef void (*AmrGenFrameCallback)(void * user, const AmrGenFrame * frame);
+
+typedef struct {
+    uint64_t start;
+    uint16_t chips;
+    uint8_t buf[(64 + AMR_GEN_MAX_CHIPS + 64) / 8]; //! Chips packed MSB first, padded with 64 zero chips each side
+} AmrGenActive;
+
+typedef struct {
+    AmrGenConfig cfg;
+    uint64_t rng;
+    uint64_t chip; //! Chips generated
+    uint64_t nextFrame; //! Start chip of the next frame
+    uint64_t nextError; //! Next chip flipped
+    double meanGap; //! Mean chips between frame starts
+    double errorScale; //! -1 / log(1 - chipErrorRate)
+    uint16_t weightSum;
+    uint8_t nactive;
+    AmrGenActive active[AMR_GEN_MAX_ACTIVE];
+    uint64_t frames; //! Frames generated
+    AmrGenFrameCallback callback;
+    void * user;
+} AmrGen;
+
+// Returns 0 on an invalid configuration. callback, if set, is called for
+// every frame as it starts.
+uint8_t amrGenInit(AmrGen * gen, const AmrGenConfig * cfg, AmrGenFrameCallback callback, void * user);
+// Generate the next nbits chips packed MSB first. nbits must be a multiple
+// of 64 except on the last call.
+void amrGenFill(AmrGen * gen, uint8_t * packed, size_t nbits);
+
+// Frame builders, return the frame length in bytes. The CRC is appended as
+// the decoder expects it.
+size_t amrGenScm(uint8_t * f, uint32_t id, uint8_t ertType, uint8_t tamper, uint32_t consumption);
+size_t amrGenScmPlus(uint8_t * f, uint32_t id, uint8_t endpointType, uint16_t tamper, uint32_t consumption);
+size_t amrGenIdm(uint8_t * f, uint32_t id, uint8_t ertType, uint32_t lastConsumption,
+        const uint16_t * intervals);
+
+#endif
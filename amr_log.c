@@ -0,0 +1,274 @@
+#include "amr_log.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define AMR_LOG_SUFFIX ".amrlog"
+
+uint8_t amrLogSegmentPath(char * buf, size_t size, const char * prefix, uint32_t segment) {
+    int len = snprintf(buf, size, "%s.%06u" AMR_LOG_SUFFIX, prefix, segment);
+    return len > 0 && (size_t)len < size;
+}
+
+// Number after the last existing segment of prefix, 0 for a new log
+static uint32_t logNextSegment(const char * prefix) {
+    const char * slash = strrchr(prefix, '/');
+    const char * base = slash ? slash + 1 : prefix;
+    size_t baseLen = strlen(base);
+    char dir[AMR_LOG_PATH_MAX];
+    uint32_t next = 0;
+    DIR * d;
+    struct dirent * ent;
+
+    if (slash) {
+        size_t dirLen = slash == prefix ? 1 : (size_t)(slash - prefix);
+        memcpy(dir, prefix, dirLen);
+        dir[dirLen] = '\0';
+    }
+    else {
+        strcpy(dir, ".");
+    }
+
+    d = opendir(dir);
+    if (d == NULL) {
+        return 0;
+    }
+    while ((ent = readdir(d)) != NULL) {
+        const char * name = ent->d_name;
+        char * end;
+        unsigned long segment;
+        if (strncmp(name, base, baseLen) != 0 || name[baseLen] != '.') {
+            continue;
+        }
+        segment = strtoul(name + baseLen + 1, &end, 10);
+        if (end == name + baseLen + 1 || strcmp(end, AMR_LOG_SUFFIX) != 0 ||
+                segment >= 0xffffffffu) {
+            continue;
+        }
+        if (segment + 1 > next) {
+            next = (uint32_t)segment + 1;
+        }
+    }
+    closedir(d);
+    return next;
+}
+
+static uint8_t logWrite(int fd, const uint8_t * data, size_t len) {
+    while (len) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return 0;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 1;
+}
+
+// Create segment log->segment and buffer its header
+static uint8_t logOpenSegment(AmrLogWriter * log) {
+    char path[AMR_LOG_PATH_MAX];
+    uint8_t * p = log->buf;
+    if (!amrLogSegmentPath(path, sizeof(path), log->prefix, log->segment)) {
+        return 0;
+    }
+
+    log->fd = open(path, O_WRONLY | O_CREAT | O_EXCL | O_APPEND, 0644);
+    if (log->fd < 0) {
+        return 0;
+    }
+
+    memcpy(p + offsetof(AmrLogSegmentHeader, magic), AMR_LOG_MAGIC, 4);
+    p[offsetof(AmrLogSegmentHeader, version)] = AMR_LOG_VERSION & 0xff;
+    p[offsetof(AmrLogSegmentHeader, version) + 1] = AMR_LOG_VERSION >> 8;
+    p[offsetof(AmrLogSegmentHeader, recordVersion)] = AMR_RECORD_VERSION & 0xff;
+    p[offsetof(AmrLogSegmentHeader, recordVersion) + 1] = AMR_RECORD_VERSION >> 8;
+    p[offsetof(AmrLogSegmentHeader, segment)] = (uint8_t)log->segment;
+    p[offsetof(AmrLogSegmentHeader, segment) + 1] = (uint8_t)(log->segment >> 8);
+    p[offsetof(AmrLogSegmentHeader, segment) + 2] = (uint8_t)(log->segment >> 16);
+    p[offsetof(AmrLogSegmentHeader, segment) + 3] = (uint8_t)(log->segment >> 24);
+    memset(p + offsetof(AmrLogSegmentHeader, reserved), 0, 4);
+    log->bufLen = sizeof(AmrLogSegmentHeader);
+    log->segmentBytes = sizeof(AmrLogSegmentHeader);
+    log->unsynced = 0;
+    return 1;
+}
+
+uint8_t amrLogOpen(AmrLogWriter * log, const char * prefix, uint64_t segmentMax, uint64_t syncBytes) {
+    size_t len;
+    if (log == NULL || prefix == NULL) {
+        return 0;
+    }
+
+    log->fd = -1;
+    len = strlen(prefix);
+    if (len == 0 || len >= sizeof(log->prefix) ||
+            segmentMax < sizeof(AmrLogSegmentHeader) + AMR_LOG_MAX_RECORD) {
+        return 0;
+    }
+
+    memcpy(log->prefix, prefix, len + 1);
+    log->segment = logNextSegment(prefix);
+    log->segmentMax = segmentMax;
+    log->syncBytes = syncBytes;
+    log->records = 0;
+    log->clock = amrLogRealTimeMs;
+    log->clockUser = NULL;
+    return logOpenSegment(log);
+}
+
+uint8_t amrLogFlush(AmrLogWriter * log) {
+    if (log == NULL || log->fd < 0) {
+        return 0;
+    }
+
+    if (log->bufLen) {
+        if (!logWrite(log->fd, log->buf, log->bufLen)) {
+            return 0;
+        }
+        log->unsynced += log->bufLen;
+        log->bufLen = 0;
+    }
+    if (log->syncBytes && log->unsynced >= log->syncBytes) {
+        if (fsync(log->fd) != 0) {
+            return 0;
+        }
+        log->unsynced = 0;
+    }
+    return 1;
+}
+
+uint8_t amrLogSync(AmrLogWriter * log) {
+    if (!amrLogFlush(log)) {
+        return 0;
+    }
+
+    if (fsync(log->fd) != 0) {
+        return 0;
+    }
+    log->unsynced = 0;
+    return 1;
+}
+
+uint8_t amrLogClose(AmrLogWriter * log) {
+    uint8_t ok;
+    if (log == NULL || log->fd < 0) {
+        return 0;
+    }
+
+    ok = amrLogSync(log);
+    ok &= close(log->fd) == 0;
+    log->fd = -1;
+    return ok;
+}
+
+uint8_t amrLogAppend(AmrLogWriter * log, AMR_MSG_TYPE type, const void * msg, uint64_t time) {
+    size_t len;
+    if (log == NULL || log->fd < 0) {
+        return 0;
+    }
+
+    if (log->bufLen + AMR_LOG_MAX_RECORD > sizeof(log->buf) && !amrLogFlush(log)) {
+        return 0;
+    }
+
+    // Encode straight into the buffer, the record only moves when it starts
+    // a new segment
+    len = amrFormatBinary(log->buf + log->bufLen, sizeof(log->buf) - log->bufLen, type, msg, time);
+    if (len == 0) {
+        return 0;
+    }
+
+    if (log->segmentBytes + len > log->segmentMax &&
+            log->segmentBytes > sizeof(AmrLogSegmentHeader)) {
+        uint8_t rec[AMR_LOG_MAX_RECORD];
+        memcpy(rec, log->buf + log->bufLen, len);
+        if (!amrLogClose(log)) {
+            return 0;
+        }
+        ++log->segment;
+        if (!logOpenSegment(log)) {
+            return 0;
+        }
+        memcpy(log->buf + log->bufLen, rec, len);
+    }
+
+    log->bufLen += len;
+    log->segmentBytes += len;
+    ++log->records;
+    return 1;
+}
+
+uint64_t amrLogRealTimeMs(void * user) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+void amrLogDecoderCallback(AmrDecoder * dec, const AmrMsgHeader * hdr,
+        const void * msg, const uint8_t * data) {
+    AmrLogWriter * log = (AmrLogWriter *)dec->user;
+    if (log == NULL || log->clock == NULL) {
+        return;
+    }
+    amrLogAppend(log, hdr->type, msg, log->clock(log->clockUser));
+}
+
+uint8_t amrLogMap(AmrLogSegment * seg, const char * path) {
+    struct stat st;
+    const AmrLogSegmentHeader * hdr;
+    void * base;
+    int fd;
+    if (seg == NULL || path == NULL) {
+        return 0;
+    }
+
+    seg->base = NULL;
+    seg->len = 0;
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(AmrLogSegmentHeader)) {
+        close(fd);
+        return 0;
+    }
+
+    base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return 0;
+    }
+
+    hdr = (const AmrLogSegmentHeader *)base;
+    if (memcmp(hdr->magic, AMR_LOG_MAGIC, 4) != 0 || hdr->version != AMR_LOG_VERSION ||
+            hdr->recordVersion != AMR_RECORD_VERSION) {
+        munmap(base, (size_t)st.st_size);
+        return 0;
+    }
+    madvise(base, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    seg->base = (const uint8_t *)base;
+    seg->len = (size_t)st.st_size;
+    return 1;
+}
+
+void amrLogUnmap(AmrLogSegment * seg) {
+    if (seg == NULL || seg->base == NULL) {
+        return;
+    }
+
+    munmap((void *)seg->base, seg->len);
+    seg->base = NULL;
+    seg->len = 0;
+}
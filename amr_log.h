@@ -0,0 +1,103 @@
+#ifndef AMR_LOG_H
+#define AMR_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "amr.h"
+#include "amr_format.h"
+
+// Append-only log of decoded messages for host builds. A log is a numbered
+// series of segment files, <prefix>.NNNNNN.amrlog, each one an
+// AmrLogSegmentHeader followed by amrFormatBinary records back to back.
+// Segments are never rewritten: opening a log starts a new segment after the
+// last existing one. Records are little endian and read in place from a
+// mapping, so the reader needs a little endian host.
+
+#define AMR_LOG_MAGIC "AMRL"
+#define AMR_LOG_VERSION 1
+#define AMR_LOG_BUF_SIZE 65536 //! Records buffered before a write
+#define AMR_LOG_PATH_MAX 256
+#define AMR_LOG_MAX_RECORD (sizeof(AmrRecordHeader) + sizeof(AmrIdmRecord))
+
+#pragma pack(push, 1)
+typedef struct {
+    char magic[4]; //! AMR_LOG_MAGIC
+    uint16_t version; //! AMR_LOG_VERSION
+    uint16_t recordVersion; //! AMR_RECORD_VERSION of the records
+    uint32_t segment; //! Segment number, matches the file name
+    uint32_t reserved;
+} AmrLogSegmentHeader;
+#pragma pack(pop)
+
+// Record time source of amrLogDecoderCallback
+typedef uint64_t (*AmrLogClock)(void * user);
+
+typedef struct {
+    int fd; //! Current segment, -1 when closed
+    uint32_t segment;
+    uint64_t segmentBytes; //! Bytes of the current segment, buffered ones included
+    uint64_t segmentMax; //! Start a new segment past this size
+    uint64_t syncBytes; //! fsync after this many bytes written, 0 on rotate and close only
+    uint64_t unsynced; //! Bytes written since the last fsync
+    uint64_t records; //! Records appended since open
+    AmrLogClock clock; //! amrLogRealTimeMs unless set after open
+    void * clockUser; //! Passed to clock
+    size_t bufLen;
+    uint8_t buf[AMR_LOG_BUF_SIZE];
+    char prefix[AMR_LOG_PATH_MAX];
+} AmrLogWriter;
+
+// Start a new segment after the last one existing for prefix. Returns 0 when
+// the arguments are invalid or the file can't be created.
+uint8_t amrLogOpen(AmrLogWriter * log, const char * prefix, uint64_t segmentMax, uint64_t syncBytes);
+// Buffer one message, writing out the buffer when it is full. Returns 0 on
+// I/O errors or an unknown type.
+uint8_t amrLogAppend(AmrLogWriter * log, AMR_MSG_TYPE type, const void * msg, uint64_t time);
+// Write out buffered records
+uint8_t amrLogFlush(AmrLogWriter * log);
+// Write out buffered records and fsync the segment
+uint8_t amrLogSync(AmrLogWriter * log);
+// Sync and close the current segment
+uint8_t amrLogClose(AmrLogWriter * log);
+// Unix time in ms from CLOCK_REALTIME, the default AmrLogClock
+uint64_t amrLogRealTimeMs(void * user);
+// AmrDecoderMsgCallback appending to the AmrLogWriter in dec->user, stamped
+// by log->clock. The header timestamp is a 32 bit chip count that wraps in
+// hours, so it isn't used as the record time.
+void amrLogDecoderCallback(AmrDecoder * dec, const AmrMsgHeader * hdr,
+        const void * msg, const uint8_t * data);
+
+// File name of a segment, returns 0 if it doesn't fit in size
+uint8_t amrLogSegmentPath(char * buf, size_t size, const char * prefix, uint32_t segment);
+
+typedef struct {
+    const uint8_t * base; //! Mapping, starts with the AmrLogSegmentHeader
+    size_t len;
+} AmrLogSegment;
+
+// Map a segment read only. Returns 0 when the file can't be mapped or isn't
+// a segment of this version.
+uint8_t amrLogMap(AmrLogSegment * seg, const char * path);
+void amrLogUnmap(AmrLogSegment * seg);
+
+// Record following prev, or the first one when prev is NULL. Returns NULL at
+// the end of the segment or at a torn record left by a crash.
+static inline const AmrRecordHeader * amrLogNext(const AmrLogSegment * seg,
+        const AmrRecordHeader * prev) {
+    const uint8_t * p = prev ? (const uint8_t *)prev + prev->size :
+            seg->base + sizeof(AmrLogSegmentHeader);
+    size_t left = (size_t)(seg->base + seg->len - p);
+    const AmrRecordHeader * rec = (const AmrRecordHeader *)p;
+    if (left < sizeof(AmrRecordHeader) || rec->size < sizeof(AmrRecordHeader) ||
+            rec->size > left || rec->version != AMR_RECORD_VERSION) {
+        return NULL;
+    }
+    return rec;
+}
+
+// Payload struct of a record, AmrScmRecord etc. as selected by rec->type
+static inline const void * amrLogPayload(const AmrRecordHeader * rec) {
+    return rec + 1;
+}
+
+#endif
@@ -0,0 +1,291 @@
+#include "amr_manch.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define AMR_MANCH_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define AMR_MANCH_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define MANCH_NTOH_64BIT(num) __builtin_bswap64((uint64_t)(num))
+#define MANCH_HTON_32BIT(num) __builtin_bswap32((uint32_t)(num))
+#else
+#define MANCH_NTOH_64BIT(num) (num)
+#define MANCH_HTON_32BIT(num) (num)
+#endif
+
+#define MANCH_PHASE0_MASK 0xaaaaaaaaaaaaaaaaull //! Chips 0, 2, ... of a word
+#define MANCH_PHASE1_MASK 0x5555555555555555ull //! Chips 1, 3, ... of a word
+
+typedef size_t (*AmrManchKernel)(const uint8_t * chips, size_t nbytes,
+        uint8_t prevChip, uint8_t * phase0, uint8_t * phase1);
+
+// Pack the even bits of x (bit 0, 2, ... 62) into the low 32 bits
+static inline uint32_t manchCompressEvenBits(uint64_t x) {
+    x &= 0x5555555555555555ull;
+    x = (x | (x >> 1)) & 0x3333333333333333ull;
+    x = (x | (x >> 2)) & 0x0f0f0f0f0f0f0f0full;
+    x = (x | (x >> 4)) & 0x00ff00ff00ff00ffull;
+    x = (x | (x >> 8)) & 0x0000ffff0000ffffull;
+    x = (x | (x >> 16)) & 0x00000000ffffffffull;
+    return (uint32_t)x;
+}
+
+// Decode 16 chips into one byte of each phase
+static inline void manchDecodePair(const uint8_t * chips, uint8_t prevChip,
+        uint8_t * phase0, uint8_t * phase1) {
+    uint16_t w = (uint16_t)((chips[0] << 8) | chips[1]);
+    uint16_t d = (uint16_t)(((w >> 1) | ((prevChip & 1) << 15)) & ~w);
+    *phase0 = (uint8_t)manchCompressEvenBits(d >> 1);
+    *phase1 = (uint8_t)manchCompressEvenBits(d);
+}
+
+// Kernels decode as many chips as they handle natively and return the number
+// of bytes consumed. The remainder is finished by the pairwise decoder.
+static size_t manchDecodeScalar(const uint8_t * chips, size_t nbytes,
+        uint8_t prevChip, uint8_t * phase0, uint8_t * phase1) {
+    size_t i = 0;
+    for (; i + 8 <= nbytes; i += 8) {
+        uint64_t w = 0;
+        memcpy(&w, chips + i, sizeof(w));
+        w = MANCH_NTOH_64BIT(w);
+        uint64_t d = ((w >> 1) | ((uint64_t)(prevChip & 1) << 63)) & ~w;
+        uint32_t p0 = MANCH_HTON_32BIT(manchCompressEvenBits(d >> 1));
+        uint32_t p1 = MANCH_HTON_32BIT(manchCompressEvenBits(d));
+        memcpy(phase0 + i/2, &p0, sizeof(p0));
+        memcpy(phase1 + i/2, &p1, sizeof(p1));
+        prevChip = w & 1;
+    }
+    return i;
+}
+
+#ifdef AMR_MANCH_X86
+__attribute__((target("bmi2")))
+static size_t manchDecodeBmi2(const uint8_t * chips, size_t nbytes,
+        uint8_t prevChip, uint8_t * phase0, uint8_t * phase1) {
+    size_t i = 0;
+    for (; i + 8 <= nbytes; i += 8) {
+        uint64_t w = 0;
+        memcpy(&w, chips + i, sizeof(w));
+        w = MANCH_NTOH_64BIT(w);
+        uint64_t d = ((w >> 1) | ((uint64_t)(prevChip & 1) << 63)) & ~w;
+        uint32_t p0 = MANCH_HTON_32BIT(_pext_u64(d, MANCH_PHASE0_MASK));
+        uint32_t p1 = MANCH_HTON_32BIT(_pext_u64(d, MANCH_PHASE1_MASK));
+        memcpy(phase0 + i/2, &p0, sizeof(p0));
+        memcpy(phase1 + i/2, &p1, sizeof(p1));
+        prevChip = w & 1;
+    }
+    return i;
+}
+
+// The vector kernels work on bytes in memory order. Each byte is decoded
+// against itself shifted by one chip with the LSB of the previous byte shifted
+// in, then the 4 bits of each phase are compressed into a nibble and pairs of
+// nibbles are packed into output bytes. SSE2 has no byte shifts, bits leaking
+// in from the neighbouring byte of a 16-bit shift are always masked off.
+static inline __m128i manchSse2Nibble(__m128i x) {
+    x = _mm_and_si128(x, _mm_set1_epi8(0x55));
+    x = _mm_and_si128(_mm_or_si128(x, _mm_srli_epi16(x, 1)), _mm_set1_epi8(0x33));
+    x = _mm_and_si128(_mm_or_si128(x, _mm_srli_epi16(x, 2)), _mm_set1_epi8(0x0f));
+    return x;
+}
+
+static inline __m128i manchSse2PackNibbles(__m128i x) {
+    x = _mm_or_si128(_mm_slli_epi16(x, 4), _mm_srli_epi16(x, 8));
+    return _mm_and_si128(x, _mm_set1_epi16(0x00ff));
+}
+
+__attribute__((target("sse2")))
+static size_t manchDecodeSse2(const uint8_t * chips, size_t nbytes,
+        uint8_t prevChip, uint8_t * phase0, uint8_t * phase1) {
+    if (nbytes < 2) {
+        return 0;
+    }
+
+    // Decode the first 16 chips separately so that every vector iteration can
+    // load its previous bytes from memory
+    manchDecodePair(chips, prevChip, phase0, phase1);
+    size_t i = 2;
+    for (; i + 16 <= nbytes; i += 16) {
+        __m128i b = _mm_loadu_si128((const __m128i *)(chips + i));
+        __m128i p = _mm_loadu_si128((const __m128i *)(chips + i - 1));
+        __m128i shifted = _mm_or_si128(
+                _mm_and_si128(_mm_srli_epi16(b, 1), _mm_set1_epi8(0x7f)),
+                _mm_and_si128(_mm_slli_epi16(p, 7), _mm_set1_epi8((char)0x80)));
+        __m128i d = _mm_andnot_si128(b, shifted);
+        __m128i p0 = manchSse2PackNibbles(manchSse2Nibble(_mm_srli_epi16(d, 1)));
+        __m128i p1 = manchSse2PackNibbles(manchSse2Nibble(d));
+        __m128i out = _mm_packus_epi16(p0, p1);
+        _mm_storel_epi64((__m128i *)(phase0 + i/2), out);
+        _mm_storel_epi64((__m128i *)(phase1 + i/2), _mm_srli_si128(out, 8));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static inline __m256i manchAvx2Nibble(__m256i x) {
+    x = _mm256_and_si256(x, _mm256_set1_epi8(0x55));
+    x = _mm256_and_si256(_mm256_or_si256(x, _mm256_srli_epi16(x, 1)), _mm256_set1_epi8(0x33));
+    x = _mm256_and_si256(_mm256_or_si256(x, _mm256_srli_epi16(x, 2)), _mm256_set1_epi8(0x0f));
+    return x;
+}
+
+__attribute__((target("avx2")))
+static inline __m256i manchAvx2PackNibbles(__m256i x) {
+    x = _mm256_or_si256(_mm256_slli_epi16(x, 4), _mm256_srli_epi16(x, 8));
+    return _mm256_and_si256(x, _mm256_set1_epi16(0x00ff));
+}
+
+__attribute__((target("avx2")))
+static size_t manchDecodeAvx2(const uint8_t * chips, size_t nbytes,
+        uint8_t prevChip, uint8_t * phase0, uint8_t * phase1) {
+    if (nbytes < 2) {
+        return 0;
+    }
+
+    manchDecodePair(chips, prevChip, phase0, phase1);
+    size_t i = 2;
+    for (; i + 32 <= nbytes; i += 32) {
+        __m256i b = _mm256_loadu_si256((const __m256i *)(chips + i));
+        __m256i p = _mm256_loadu_si256((const __m256i *)(chips + i - 1));
+        __m256i shifted = _mm256_or_si256(
+                _mm256_and_si256(_mm256_srli_epi16(b, 1), _mm256_set1_epi8(0x7f)),
+                _mm256_and_si256(_mm256_slli_epi16(p, 7), _mm256_set1_epi8((char)0x80)));
+        __m256i d = _mm256_andnot_si256(b, shifted);
+        __m256i p0 = manchAvx2PackNibbles(manchAvx2Nibble(_mm256_srli_epi16(d, 1)));
+        __m256i p1 = manchAvx2PackNibbles(manchAvx2Nibble(d));
+        // packus interleaves per 128-bit lane, restore phase0 | phase1 order
+        __m256i out = _mm256_permute4x64_epi64(_mm256_packus_epi16(p0, p1), 0xd8);
+        _mm_storeu_si128((__m128i *)(phase0 + i/2), _mm256_castsi256_si128(out));
+        _mm_storeu_si128((__m128i *)(phase1 + i/2), _mm256_extracti128_si256(out, 1));
+    }
+    return i;
+}
+#endif
+
+#ifdef AMR_MANCH_NEON
+static inline uint8x16_t manchNeonNibble(uint8x16_t x) {
+    x = vandq_u8(x, vdupq_n_u8(0x55));
+    x = vandq_u8(vorrq_u8(x, vshrq_n_u8(x, 1)), vdupq_n_u8(0x33));
+    x = vandq_u8(vorrq_u8(x, vshrq_n_u8(x, 2)), vdupq_n_u8(0x0f));
+    return x;
+}
+
+static inline uint8x8_t manchNeonPackNibbles(uint8x16_t x) {
+    uint16x8_t w = vreinterpretq_u16_u8(x);
+    return vmovn_u16(vorrq_u16(vshlq_n_u16(w, 4), vshrq_n_u16(w, 8)));
+}
+
+static size_t manchDecodeNeon(const uint8_t * chips, size_t nbytes,
+        uint8_t prevChip, uint8_t * phase0, uint8_t * phase1) {
+    if (nbytes < 2) {
+        return 0;
+    }
+
+    manchDecodePair(chips, prevChip, phase0, phase1);
+    size_t i = 2;
+    for (; i + 16 <= nbytes; i += 16) {
+        uint8x16_t b = vld1q_u8(chips + i);
+        uint8x16_t p = vld1q_u8(chips + i - 1);
+        uint8x16_t d = vbicq_u8(vorrq_u8(vshrq_n_u8(b, 1), vshlq_n_u8(p, 7)), b);
+        vst1_u8(phase0 + i/2, manchNeonPackNibbles(manchNeonNibble(vshrq_n_u8(d, 1))));
+        vst1_u8(phase1 + i/2, manchNeonPackNibbles(manchNeonNibble(d)));
+    }
+    return i;
+}
+#endif
+
+static const AmrManchKernel manchKernels[AMR_MANCH_IMPL_CNT] = {
+    manchDecodeScalar,
+#ifdef AMR_MANCH_X86
+    manchDecodeBmi2,
+    manchDecodeSse2,
+    manchDecodeAvx2,
+#else
+    NULL,
+    NULL,
+    NULL,
+#endif
+#ifdef AMR_MANCH_NEON
+    manchDecodeNeon,
+#else
+    NULL,
+#endif
+};
+
+static const char * const manchImplNames[AMR_MANCH_IMPL_CNT] = {
+    "scalar", "bmi2", "sse2", "avx2", "neon"};
+
+static AMR_MANCH_IMPL manchImpl = AMR_MANCH_IMPL_CNT; //! Unselected until first use
+
+uint8_t amrManchImplSupported(AMR_MANCH_IMPL impl) {
+    if (impl >= AMR_MANCH_IMPL_CNT || manchKernels[impl] == NULL) {
+        return 0;
+    }
+
+    switch (impl) {
+#ifdef AMR_MANCH_X86
+        case AMR_MANCH_IMPL_BMI2:
+            return __builtin_cpu_supports("bmi2") != 0;
+        case AMR_MANCH_IMPL_SSE2:
+            return __builtin_cpu_supports("sse2") != 0;
+        case AMR_MANCH_IMPL_AVX2:
+            return __builtin_cpu_supports("avx2") != 0;
+#endif
+        default:
+            return 1;
+    }
+}
+
+// Engine workers may make their first decode calls at the same time. Relaxed
+// atomics are enough since they all select the same kernel.
+AMR_MANCH_IMPL amrManchImpl() {
+    AMR_MANCH_IMPL impl = __atomic_load_n(&manchImpl, __ATOMIC_RELAXED);
+    if (impl == AMR_MANCH_IMPL_CNT) {
+        // Preference order, fastest first. PEXT is microcoded on older AMD
+        // parts so SSE2 goes before BMI2.
+        static const AMR_MANCH_IMPL order[] = {
+            AMR_MANCH_IMPL_AVX2, AMR_MANCH_IMPL_NEON, AMR_MANCH_IMPL_SSE2,
+            AMR_MANCH_IMPL_BMI2, AMR_MANCH_IMPL_SCALAR};
+        size_t i = 0;
+        for (; i < sizeof(order)/sizeof(order[0]); ++i) {
+            if (amrManchImplSupported(order[i])) {
+                impl = order[i];
+                break;
+            }
+        }
+        __atomic_store_n(&manchImpl, impl, __ATOMIC_RELAXED);
+    }
+    return impl;
+}
+
+uint8_t amrManchSelectImpl(AMR_MANCH_IMPL impl) {
+    if (!amrManchImplSupported(impl)) {
+        return 0;
+    }
+    __atomic_store_n(&manchImpl, impl, __ATOMIC_RELAXED);
+    return 1;
+}
+
+const char * amrManchImplName(AMR_MANCH_IMPL impl) {
+    return impl < AMR_MANCH_IMPL_CNT ? manchImplNames[impl] : "unknown";
+}
+
+void amrManchDecode(const uint8_t * chips, size_t nbytes, uint8_t prevChip,
+        uint8_t * phase0, uint8_t * phase1) {
+    if (chips == NULL || phase0 == NULL || phase1 == NULL) {
+        return;
+    }
+
+    nbytes &= ~(size_t)1;
+    size_t i = manchKernels[amrManchImpl()](chips, nbytes, prevChip, phase0, phase1);
+    for (; i < nbytes; i += 2) {
+        manchDecodePair(chips + i, i ? chips[i - 1] : prevChip,
+                phase0 + i/2, phase1 + i/2);
+    }
+}
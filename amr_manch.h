@@ -0,0 +1,31 @@
+#ifndef AMR_MANCH_H
+#define AMR_MANCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum {
+    AMR_MANCH_IMPL_SCALAR = 0,
+    AMR_MANCH_IMPL_BMI2,
+    AMR_MANCH_IMPL_SSE2,
+    AMR_MANCH_IMPL_AVX2,
+    AMR_MANCH_IMPL_NEON,
+    AMR_MANCH_IMPL_CNT
+} AMR_MANCH_IMPL;
+
+// Manchester decode nbytes of chips packed MSB first into both phase aligned
+// bitstreams. nbytes must be even. phase0 receives the bits decoded at chips
+// 0, 2, 4... and phase1 the bits decoded at chips 1, 3, 5..., nbytes/2 bytes
+// each packed MSB first. prevChip is the chip received before chips[0].
+void amrManchDecode(const uint8_t * chips, size_t nbytes, uint8_t prevChip,
+        uint8_t * phase0, uint8_t * phase1);
+
+// Kernel used by amrManchDecode. The fastest supported one is picked from
+// CPUID on first use.
+AMR_MANCH_IMPL amrManchImpl();
+uint8_t amrManchImplSupported(AMR_MANCH_IMPL impl);
+// Force a kernel, returns 0 when it isn't supported on this CPU
+uint8_t amrManchSelectImpl(AMR_MANCH_IMPL impl);
+const char * amrManchImplName(AMR_MANCH_IMPL impl);
+
+#endif
@@ -0,0 +1,327 @@
+#include "amr_replay.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+static inline void replayPutLe16(uint8_t * p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void replayPutLe32(uint8_t * p, uint32_t v) {
+    replayPutLe16(p, (uint16_t)v);
+    replayPutLe16(p + 2, (uint16_t)(v >> 16));
+}
+
+static inline void replayPutLe64(uint8_t * p, uint64_t v) {
+    replayPutLe32(p, (uint32_t)v);
+    replayPutLe32(p + 4, (uint32_t)(v >> 32));
+}
+
+static inline uint16_t replayGetLe16(const uint8_t * p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t replayGetLe32(const uint8_t * p) {
+    return replayGetLe16(p) | ((uint32_t)replayGetLe16(p + 2) << 16);
+}
+
+uint8_t amrRecorderOpen(AmrRecorder * rec, const char * path, AMR_REPLAY_KIND kind, uint32_t chipRate) {
+    uint8_t hdr[sizeof(AmrReplayFileHeader)] = {0};
+    if (rec == NULL || path == NULL || kind > AMR_REPLAY_FRAMES) {
+        return 0;
+    }
+
+    memset(rec, 0, sizeof(*rec));
+    rec->file = fopen(path, "wb");
+    if (rec->file == NULL) {
+        return 0;
+    }
+    setvbuf(rec->file, NULL, _IOFBF, 1 << 16);
+    rec->kind = kind;
+
+    memcpy(hdr + offsetof(AmrReplayFileHeader, magic), AMR_REPLAY_MAGIC, 4);
+    replayPutLe16(hdr + offsetof(AmrReplayFileHeader, version), AMR_REPLAY_VERSION);
+    hdr[offsetof(AmrReplayFileHeader, kind)] = (uint8_t)kind;
+    replayPutLe32(hdr + offsetof(AmrReplayFileHeader, chipRate), chipRate ? chipRate : AMR_REPLAY_CHIP_RATE);
+    if (fwrite(hdr, sizeof(hdr), 1, rec->file) != 1) {
+        fclose(rec->file);
+        rec->file = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+static uint8_t recorderFlushBlock(AmrRecorder * rec) {
+    uint8_t hdr[sizeof(AmrReplayChipBlock)];
+    if (rec->blockBits == 0) {
+        return 1;
+    }
+
+    replayPutLe64(hdr + offsetof(AmrReplayChipBlock, firstChip), rec->chips - rec->blockBits);
+    replayPutLe32(hdr + offsetof(AmrReplayChipBlock, nbits), rec->blockBits);
+    if (fwrite(hdr, sizeof(hdr), 1, rec->file) != 1 ||
+            fwrite(rec->block, (rec->blockBits + 7) / 8, 1, rec->file) != 1) {
+        return 0;
+    }
+    rec->blockBits = 0;
+    return 1;
+}
+
+static inline uint8_t recorderBit(AmrRecorder * rec, uint8_t bit) {
+    uint8_t * p = &rec->block[rec->blockBits >> 3];
+    uint8_t shift = 7 - (rec->blockBits & 7);
+    *p = (uint8_t)((*p & ~(1u << shift)) | ((bit != 0) << shift));
+    ++rec->blockBits;
+    ++rec->chips;
+    if (rec->blockBits == AMR_REPLAY_BLOCK_CHIPS) {
+        return recorderFlushBlock(rec);
+    }
+    return 1;
+}
+
+uint8_t amrRecorderRxBit(AmrRecorder * rec, uint8_t rxBit) {
+    if (rec == NULL || rec->file == NULL || rec->kind != AMR_REPLAY_CHIPS) {
+        return 0;
+    }
+
+    return recorderBit(rec, rxBit);
+}
+
+uint8_t amrRecorderChips(AmrRecorder * rec, const uint8_t * packed, size_t nbits) {
+    size_t bit = 0;
+    if (rec == NULL || rec->file == NULL || packed == NULL || rec->kind != AMR_REPLAY_CHIPS) {
+        return 0;
+    }
+
+    // Whole bytes while the block is byte aligned, single chips otherwise
+    while (bit < nbits) {
+        if ((rec->blockBits & 7) == 0 && nbits - bit >= 8) {
+            size_t n = (AMR_REPLAY_BLOCK_CHIPS - rec->blockBits) / 8;
+            if (n > (nbits - bit) / 8) {
+                n = (nbits - bit) / 8;
+            }
+            if ((bit & 7) == 0) {
+                memcpy(rec->block + rec->blockBits / 8, packed + bit / 8, n);
+            }
+            else {
+                // Source runs off byte boundaries, merge neighbouring bytes
+                const uint8_t * src = packed + bit / 8;
+                uint8_t * dst = rec->block + rec->blockBits / 8;
+                uint8_t shift = bit & 7;
+                size_t i = 0;
+                for (; i < n; ++i) {
+                    dst[i] = (uint8_t)((src[i] << shift) | (src[i + 1] >> (8 - shift)));
+                }
+            }
+            rec->blockBits += (uint32_t)(n * 8);
+            rec->chips += n * 8;
+            bit += n * 8;
+            if (rec->blockBits == AMR_REPLAY_BLOCK_CHIPS && !recorderFlushBlock(rec)) {
+                return 0;
+            }
+        }
+        else {
+            if (!recorderBit(rec, (packed[bit / 8] >> (7 - bit % 8)) & 1)) {
+                return 0;
+            }
+            ++bit;
+        }
+    }
+    return 1;
+}
+
+uint8_t amrRecorderFrame(AmrRecorder * rec, const AmrMsgHeader * hdr, const uint8_t * frame, size_t len) {
+    uint8_t out[sizeof(AmrReplayFrame)];
+    if (rec == NULL || rec->file == NULL || hdr == NULL || frame == NULL ||
+            rec->kind != AMR_REPLAY_FRAMES || len > 0xffff) {
+        return 0;
+    }
+
+    replayPutLe32(out + offsetof(AmrReplayFrame, timestamp), hdr->timestamp);
+    out[offsetof(AmrReplayFrame, type)] = (uint8_t)hdr->type;
+    out[offsetof(AmrReplayFrame, bitOffset)] = hdr->bitOffset;
+    replayPutLe16(out + offsetof(AmrReplayFrame, len), (uint16_t)len);
+    if (fwrite(out, sizeof(out), 1, rec->file) != 1 || fwrite(frame, len, 1, rec->file) != 1) {
+        return 0;
+    }
+    ++rec->frames;
+    return 1;
+}
+
+void amrRecorderFrameTap(AmrDecoder * dec, const AmrMsgHeader * hdr,
+        const uint8_t * frame, size_t len) {
+    amrRecorderFrame((AmrRecorder *)dec->frameTapUser, hdr, frame, len);
+}
+
+uint8_t amrRecorderClose(AmrRecorder * rec) {
+    uint8_t ok;
+    if (rec == NULL || rec->file == NULL) {
+        return 0;
+    }
+
+    ok = recorderFlushBlock(rec);
+    ok &= fclose(rec->file) == 0;
+    rec->file = NULL;
+    return ok;
+}
+
+static double replaySeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Sleep until chips have taken their time at rate since start
+static void replayPace(const struct timespec * start, uint64_t chips, uint32_t rate) {
+    struct timespec t = *start;
+    uint64_t ns = (chips % rate) * 1000000000ull / rate;
+    t.tv_sec += (time_t)(chips / rate);
+    t.tv_nsec += (long)ns;
+    if (t.tv_nsec >= 1000000000L) {
+        t.tv_nsec -= 1000000000L;
+        ++t.tv_sec;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL) == EINTR) {
+    }
+}
+
+static void replayChips(AmrDecoder * dec, const uint8_t * p, const uint8_t * end,
+        uint8_t realTime, const struct timespec * start, AmrReplayStats * stats) {
+    while ((size_t)(end - p) >= sizeof(AmrReplayChipBlock)) {
+        uint32_t nbits = replayGetLe32(p + offsetof(AmrReplayChipBlock, nbits));
+        const uint8_t * chips = p + sizeof(AmrReplayChipBlock);
+        size_t bytes = ((size_t)nbits + 7) / 8;
+        size_t pos = 0;
+        if ((size_t)(end - chips) < bytes) {
+            break;
+        }
+
+        for (; pos < nbits; pos += AMR_REPLAY_FEED_CHIPS) {
+            size_t n = nbits - pos < AMR_REPLAY_FEED_CHIPS ? nbits - pos : AMR_REPLAY_FEED_CHIPS;
+            if (realTime) {
+                replayPace(start, stats->chips + n, stats->chipRate);
+            }
+            amrDecoderProcessBits(dec, chips + pos / 8, n);
+            amrDecoderProcessMsgs(dec);
+            stats->chips += n;
+        }
+        p = chips + bytes;
+    }
+}
+
+static void replayFrames(AmrDecoder * dec, const uint8_t * p, const uint8_t * end,
+        uint8_t realTime, const struct timespec * start, AmrReplayStats * stats) {
+    uint32_t prevTime = 0;
+    while ((size_t)(end - p) >= sizeof(AmrReplayFrame)) {
+        uint32_t timestamp = replayGetLe32(p + offsetof(AmrReplayFrame, timestamp));
+        uint16_t len = replayGetLe16(p + offsetof(AmrReplayFrame, len));
+        const uint8_t * frame = p + sizeof(AmrReplayFrame);
+        AmrMsgHeader hdr;
+        uint8_t queued;
+        if ((size_t)(end - frame) < len) {
+            break;
+        }
+
+        // Timestamps are chip counts that wrap, only their deltas matter
+        if (stats->frames || stats->dropped) {
+            stats->chips += (uint32_t)(timestamp - prevTime);
+        }
+        prevTime = timestamp;
+        if (realTime) {
+            replayPace(start, stats->chips, stats->chipRate);
+        }
+
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.type = (AMR_MSG_TYPE)p[offsetof(AmrReplayFrame, type)];
+        hdr.timestamp = timestamp;
+        hdr.bitOffset = p[offsetof(AmrReplayFrame, bitOffset)];
+        // A full msgRing is drained and the frame queued again, a frame that
+        // still doesn't fit the empty ring has an invalid length
+        queued = amrDecoderInjectFrame(dec, &hdr, frame, len);
+        if (!queued) {
+            amrDecoderProcessMsgs(dec);
+            queued = amrDecoderInjectFrame(dec, &hdr, frame, len);
+        }
+        if (queued) {
+            ++stats->frames;
+        }
+        else {
+            ++stats->dropped;
+        }
+        if (realTime) {
+            amrDecoderProcessMsgs(dec);
+        }
+        p = frame + len;
+    }
+    amrDecoderProcessMsgs(dec);
+}
+
+uint8_t amrReplay(AmrDecoder * dec, const char * path, uint8_t realTime, AmrReplayStats * stats) {
+    AmrReplayStats local;
+    const uint8_t * hdr;
+    const uint8_t * records;
+    const uint8_t * end;
+    struct timespec start;
+    struct stat st;
+    void * map;
+    int fd;
+    uint8_t kind;
+    uint32_t chipRate;
+    double t0;
+    if (path == NULL) {
+        return 0;
+    }
+    if (dec == NULL) {
+        dec = amrGetDecoder();
+    }
+    if (stats == NULL) {
+        stats = &local;
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(AmrReplayFileHeader)) {
+        close(fd);
+        return 0;
+    }
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return 0;
+    }
+
+    hdr = (const uint8_t *)map;
+    kind = hdr[offsetof(AmrReplayFileHeader, kind)];
+    chipRate = replayGetLe32(hdr + offsetof(AmrReplayFileHeader, chipRate));
+    if (memcmp(hdr + offsetof(AmrReplayFileHeader, magic), AMR_REPLAY_MAGIC, 4) != 0 ||
+            replayGetLe16(hdr + offsetof(AmrReplayFileHeader, version)) != AMR_REPLAY_VERSION ||
+            kind > AMR_REPLAY_FRAMES || chipRate == 0) {
+        munmap(map, (size_t)st.st_size);
+        return 0;
+    }
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    stats->kind = (AMR_REPLAY_KIND)kind;
+    stats->chipRate = chipRate;
+    records = hdr + sizeof(AmrReplayFileHeader);
+    end = hdr + st.st_size;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    t0 = replaySeconds();
+    if (kind == AMR_REPLAY_CHIPS) {
+        replayChips(dec, records, end, realTime, &start, stats);
+    }
+    else {
+        replayFrames(dec, records, end, realTime, &start, stats);
+    }
+    stats->seconds = replaySeconds() - t0;
+    munmap(map, (size_t)st.st_size);
+    return 1;
+}
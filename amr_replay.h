@@ -0,0 +1,92 @@
+#ifndef AMR_REPLAY_H
+#define AMR_REPLAY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "amr.h"
+
+// Recording and deterministic replay of decoder input for host builds. A
+// recording holds either the raw chip stream, which replays through the whole
+// decoder, or the frames queued after preamble detection, which replay from
+// msgRing on and are much smaller. Files are an AmrReplayFileHeader followed
+// by records, all little endian:
+//   chips: AmrReplayChipBlock + (nbits + 7) / 8 chip bytes packed MSB first
+//   frames: AmrReplayFrame + len raw frame bytes, see AmrDecoderFrameTap
+
+#define AMR_REPLAY_MAGIC "AMRR"
+#define AMR_REPLAY_VERSION 1
+#define AMR_REPLAY_CHIP_RATE 32768 //! ERT chips per second
+#define AMR_REPLAY_BLOCK_CHIPS 4096 //! Chips per recorded block
+#define AMR_REPLAY_FEED_CHIPS 512 //! Chips decoded between amrDecoderProcessMsgs calls
+
+typedef enum {
+    AMR_REPLAY_CHIPS = 0,
+    AMR_REPLAY_FRAMES
+} AMR_REPLAY_KIND;
+
+#pragma pack(push, 1)
+typedef struct {
+    char magic[4]; //! AMR_REPLAY_MAGIC
+    uint16_t version; //! AMR_REPLAY_VERSION
+    uint8_t kind; //! AMR_REPLAY_KIND
+    uint8_t reserved;
+    uint32_t chipRate; //! Chips per second, for real time replay
+    uint32_t reserved2;
+} AmrReplayFileHeader;
+
+typedef struct {
+    uint64_t firstChip; //! Index of the first chip since recording started
+    uint32_t nbits;
+} AmrReplayChipBlock;
+
+typedef struct {
+    uint32_t timestamp; //! AmrMsgHeader fields
+    uint8_t type;
+    uint8_t bitOffset;
+    uint16_t len;
+} AmrReplayFrame;
+#pragma pack(pop)
+
+typedef struct {
+    FILE * file;
+    AMR_REPLAY_KIND kind;
+    uint64_t chips; //! Chips recorded
+    uint64_t frames; //! Frames recorded
+    uint32_t blockBits; //! Chips pending in block
+    uint8_t block[AMR_REPLAY_BLOCK_CHIPS / 8];
+} AmrRecorder;
+
+// Create a recording, chipRate 0 for AMR_REPLAY_CHIP_RATE. Returns 0 when the
+// file can't be created.
+uint8_t amrRecorderOpen(AmrRecorder * rec, const char * path, AMR_REPLAY_KIND kind, uint32_t chipRate);
+// Record chips packed MSB first, as passed to amrProcessRxBits
+uint8_t amrRecorderChips(AmrRecorder * rec, const uint8_t * packed, size_t nbits);
+// Record a single chip, as passed to amrProcessRxBit
+uint8_t amrRecorderRxBit(AmrRecorder * rec, uint8_t rxBit);
+// Record one raw frame
+uint8_t amrRecorderFrame(AmrRecorder * rec, const AmrMsgHeader * hdr, const uint8_t * frame, size_t len);
+// AmrDecoderFrameTap recording to the AmrRecorder passed as the tap's user
+void amrRecorderFrameTap(AmrDecoder * dec, const AmrMsgHeader * hdr,
+        const uint8_t * frame, size_t len);
+// Write out pending chips and close the file
+uint8_t amrRecorderClose(AmrRecorder * rec);
+
+typedef struct {
+    AMR_REPLAY_KIND kind;
+    uint32_t chipRate;
+    uint64_t chips; //! Chips replayed, or the span of the frame timestamps
+    uint64_t frames; //! Frames replayed
+    uint64_t dropped; //! Frames amrDecoderInjectFrame rejected, not in frames
+    double seconds; //! Wall time of the replay
+} AmrReplayStats;
+
+// Feed a recording to dec, the default decoder when NULL, and deliver its
+// messages through the decoder's callbacks. Chips go through
+// amrDecoderProcessBits, frames through amrDecoderInjectFrame. With realTime
+// the replay is paced at the recorded chip rate, otherwise it runs as fast as
+// possible. Returns 0 when the file isn't a valid recording, stats may be
+// NULL.
+uint8_t amrReplay(AmrDecoder * dec, const char * path, uint8_t realTime, AmrReplayStats * stats);
+
+#endif
@@ -0,0 +1,282 @@
+// Google Benchmark suite of the decoder hot paths, for tracking regressions
+// between releases. make json writes the results to amrbench.json.
+#include "../ring/ringbuf.c"
+#include "../amr.c"
+#include "../amr_crc.c"
+#include "../amr_manch.c"
+#include "../amr_dedup.c"
+#include "../amr_format.c"
+#include "../amr_gen.c"
+
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <vector>
+
+#define BENCH_CHIPS (1u << 22) //! Generated chips shared by the decode benchmarks
+#define BENCH_BLOCK 4096 //! Chips decoded between drains of the message ring
+#define BENCH_POOL 64 //! Distinct frames cycled through, power of two
+
+static std::vector<uint8_t> chips;
+static uint8_t frames[3][BENCH_POOL][AMR_MAX_MSG_SIZE];
+static AmrScmMsg scmPool[BENCH_POOL];
+static AmrScmPlusMsg scmPlusPool[BENCH_POOL];
+static AmrIdmMsg idmPool[BENCH_POOL];
+static const size_t frameSizes[] = {
+    AMR_MSG_SCM_RAW_SIZE, AMR_MSG_SCM_PLUS_RAW_SIZE, AMR_MSG_IDM_RAW_SIZE};
+
+// Live traffic at 10 frames/s with random chips between frames, and a pool
+// of valid frames of every type with their parsed messages
+static void benchSetup() {
+    AmrGenConfig cfg = {};
+    AmrGen gen;
+    uint32_t x = 0x2545f491;
+    size_t i = 0;
+
+    cfg.seed = 1;
+    cfg.framesPerSec = 10;
+    cfg.randomNoise = 1;
+    amrGenInit(&gen, &cfg, NULL, NULL);
+    chips.resize(BENCH_CHIPS / 8);
+    amrGenFill(&gen, chips.data(), BENCH_CHIPS);
+
+    for (; i < BENCH_POOL; ++i) {
+        uint16_t intervals[47];
+        size_t j = 0;
+        for (; j < 47; ++j) {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            intervals[j] = x & 0x1ff;
+        }
+        amrGenScm(frames[AMR_MSG_TYPE_SCM][i], x & 0x3ffffff, 7, 0, x >> 8);
+        amrGenScmPlus(frames[AMR_MSG_TYPE_SCM_PLUS][i], x, 0xab, 0, x >> 3);
+        amrGenIdm(frames[AMR_MSG_TYPE_IDM][i], x, 7, x >> 5, intervals);
+        amrParseScm(frames[AMR_MSG_TYPE_SCM][i], &scmPool[i]);
+        amrParseScmPlus(frames[AMR_MSG_TYPE_SCM_PLUS][i], &scmPlusPool[i]);
+        amrParseIdm(frames[AMR_MSG_TYPE_IDM][i], &idmPool[i]);
+    }
+}
+
+static void benchMsgCallback(const void * msg, AMR_MSG_TYPE msgType, const uint8_t * data) {
+    benchmark::DoNotOptimize(msg);
+}
+
+// Per-chip cost of the interrupt path, one call per chip as the HAL makes it
+static void BM_RxBit(benchmark::State & state) {
+    amrInit();
+    registerAmrMsgCallback(benchMsgCallback);
+    size_t pos = 0;
+    for (auto _ : state) {
+        const uint8_t * block = chips.data() + pos / 8;
+        size_t i = 0;
+        for (; i < BENCH_BLOCK; ++i) {
+            amrProcessRxBit((block[i / 8] >> (7 - i % 8)) & 1);
+        }
+        amrProcessMsgs();
+        pos = (pos + BENCH_BLOCK) % BENCH_CHIPS;
+    }
+    state.SetItemsProcessed(state.iterations() * BENCH_BLOCK);
+}
+BENCHMARK(BM_RxBit);
+
+// The same chips through the packed bulk path
+static void BM_RxBits(benchmark::State & state) {
+    amrInit();
+    registerAmrMsgCallback(benchMsgCallback);
+    size_t pos = 0;
+    for (auto _ : state) {
+        amrProcessRxBits(chips.data() + pos / 8, BENCH_BLOCK);
+        amrProcessMsgs();
+        pos = (pos + BENCH_BLOCK) % BENCH_CHIPS;
+    }
+    state.SetItemsProcessed(state.iterations() * BENCH_BLOCK);
+}
+BENCHMARK(BM_RxBits);
+
+// One frame of range(0) bytes pushed and popped
+static void BM_RingPushPop(benchmark::State & state) {
+    static uint8_t storage[4096];
+    uint8_t in[1024] = {0};
+    uint8_t out[1024];
+    Ring ring = ringInit(storage, sizeof(storage));
+    RingPos_t size = (RingPos_t)state.range(0);
+    for (auto _ : state) {
+        ringPush(&ring, in, size);
+        benchmark::DoNotOptimize(ringPop(&ring, out, sizeof(out)));
+    }
+    state.SetBytesProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_RingPushPop)->Arg(16)->Arg(64)->Arg(AMR_MSG_HDR_SIZE + AMR_MAX_MSG_SIZE)->Arg(256)->Arg(1024);
+
+// Ring filled to range(1) frames of range(0) bytes, then drained
+static void BM_RingFillDrain(benchmark::State & state) {
+    static uint8_t storage[8192];
+    uint8_t in[1024] = {0};
+    uint8_t out[1024];
+    Ring ring = ringInit(storage, sizeof(storage));
+    RingPos_t size = (RingPos_t)state.range(0);
+    int64_t cnt = state.range(1);
+    for (auto _ : state) {
+        int64_t i = 0;
+        for (; i < cnt; ++i) {
+            ringPush(&ring, in, size);
+        }
+        for (i = 0; i < cnt; ++i) {
+            benchmark::DoNotOptimize(ringPop(&ring, out, sizeof(out)));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * cnt);
+    state.SetBytesProcessed(state.iterations() * cnt * size);
+}
+BENCHMARK(BM_RingFillDrain)->Args({16, 64})->Args({100, 32})->Args({1024, 4});
+
+static void BM_BchCrc(benchmark::State & state) {
+    size_t i = 0;
+    for (auto _ : state) {
+        const uint8_t * f = frames[AMR_MSG_TYPE_SCM][i++ % BENCH_POOL];
+        benchmark::DoNotOptimize(computeBCHCRC(f + 2, AMR_MSG_SCM_RAW_SIZE - 2));
+    }
+    state.SetBytesProcessed(state.iterations() * (AMR_MSG_SCM_RAW_SIZE - 2));
+}
+BENCHMARK(BM_BchCrc);
+
+static void BM_CcittCrc(benchmark::State & state) {
+    size_t i = 0;
+    for (auto _ : state) {
+        const uint8_t * f = frames[AMR_MSG_TYPE_IDM][i++ % BENCH_POOL];
+        benchmark::DoNotOptimize(computeCCITTCRC(f + 4, AMR_MSG_IDM_RAW_SIZE - 4));
+    }
+    state.SetBytesProcessed(state.iterations() * (AMR_MSG_IDM_RAW_SIZE - 4));
+}
+BENCHMARK(BM_CcittCrc);
+
+// The 47 differential consumption intervals of a standard IDM frame, field
+// by field with extractBits against the word unpacker amrParseIdm uses
+static void BM_IdmUnpackExtractBits(benchmark::State & state) {
+    uint16_t out[47];
+    size_t i = 0;
+    for (auto _ : state) {
+        const uint8_t * f = frames[AMR_MSG_TYPE_IDM][i++ % BENCH_POOL];
+        uint16_t j = 0;
+        for (; j < 47; ++j) {
+            out[j] = (uint16_t)extractBits(f + AMR_MSG_IDM_INTERVALS_OFFSET, j * 9, 9);
+        }
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetItemsProcessed(state.iterations() * 47);
+}
+BENCHMARK(BM_IdmUnpackExtractBits);
+
+static void BM_IdmUnpackWords(benchmark::State & state) {
+    uint16_t out[47];
+    size_t i = 0;
+    for (auto _ : state) {
+        amrUnpack9x47(frames[AMR_MSG_TYPE_IDM][i++ % BENCH_POOL] + AMR_MSG_IDM_INTERVALS_OFFSET, out);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetItemsProcessed(state.iterations() * 47);
+}
+BENCHMARK(BM_IdmUnpackWords);
+
+static void BM_ParseIdm(benchmark::State & state) {
+    AmrIdmMsg msg;
+    size_t i = 0;
+    for (auto _ : state) {
+        amrParseIdm(frames[AMR_MSG_TYPE_IDM][i++ % BENCH_POOL], &msg);
+        benchmark::DoNotOptimize(msg);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ParseIdm);
+
+// Queued frames of type range(0) through CRC, parse and callback. A drain
+// is too short to bracket with PauseTiming, so it is timed by hand and the
+// refill isn't timed.
+static void BM_ProcessMsgs(benchmark::State & state) {
+    AMR_MSG_TYPE type = (AMR_MSG_TYPE)state.range(0);
+    AmrMsgHeader hdr = {};
+    size_t i = 0;
+    int64_t msgs = 0;
+    amrInit();
+    registerAmrMsgCallback(benchMsgCallback);
+    hdr.type = type;
+    for (auto _ : state) {
+        while (amrDecoderInjectFrame(amrGetDecoder(), &hdr, frames[type][i % BENCH_POOL], frameSizes[type])) {
+            ++i;
+            ++msgs;
+        }
+        auto start = std::chrono::steady_clock::now();
+        amrProcessMsgs();
+        auto end = std::chrono::steady_clock::now();
+        state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+    }
+    state.SetItemsProcessed(msgs);
+}
+BENCHMARK(BM_ProcessMsgs)->Arg(AMR_MSG_TYPE_SCM)->Arg(AMR_MSG_TYPE_SCM_PLUS)->Arg(AMR_MSG_TYPE_IDM)
+    ->UseManualTime();
+
+// The print*Msg formatters write to stdout, which is pointed at /dev/null
+// while they run
+static void BM_PrintAmrMsg(benchmark::State & state) {
+    AMR_MSG_TYPE type = (AMR_MSG_TYPE)state.range(0);
+    int saved;
+    int devNull = open("/dev/null", O_WRONLY);
+    size_t i = 0;
+    if (devNull < 0) {
+        state.SkipWithError("/dev/null");
+        return;
+    }
+    fflush(stdout);
+    saved = dup(STDOUT_FILENO);
+    dup2(devNull, STDOUT_FILENO);
+    for (auto _ : state) {
+        const void * msg = type == AMR_MSG_TYPE_SCM ? (const void *)&scmPool[i % BENCH_POOL] :
+                type == AMR_MSG_TYPE_SCM_PLUS ? (const void *)&scmPlusPool[i % BENCH_POOL] :
+                (const void *)&idmPool[i % BENCH_POOL];
+        printAmrMsg("2026-01-01T00:00:00", msg, type);
+        ++i;
+    }
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    close(devNull);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PrintAmrMsg)->Arg(AMR_MSG_TYPE_SCM)->Arg(AMR_MSG_TYPE_SCM_PLUS)->Arg(AMR_MSG_TYPE_IDM);
+
+// The buffer formatters of amr_format.h, format range(0) and message type
+// range(1)
+static void BM_Format(benchmark::State & state) {
+    AMR_FORMAT format = (AMR_FORMAT)state.range(0);
+    AMR_MSG_TYPE type = (AMR_MSG_TYPE)state.range(1);
+    uint8_t buf[AMR_FORMAT_MAX_LEN];
+    size_t bytes = 0;
+    size_t i = 0;
+    for (auto _ : state) {
+        const void * msg = type == AMR_MSG_TYPE_SCM ? (const void *)&scmPool[i % BENCH_POOL] :
+                type == AMR_MSG_TYPE_SCM_PLUS ? (const void *)&scmPlusPool[i % BENCH_POOL] :
+                (const void *)&idmPool[i % BENCH_POOL];
+        bytes += amrFormat(format, buf, sizeof(buf), type, msg, i);
+        benchmark::DoNotOptimize(buf);
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_Format)->ArgsProduct({
+    {AMR_FORMAT_JSON, AMR_FORMAT_CSV, AMR_FORMAT_BINARY},
+    {AMR_MSG_TYPE_SCM, AMR_MSG_TYPE_SCM_PLUS, AMR_MSG_TYPE_IDM}});
+
+int main(int argc, char ** argv) {
+    benchSetup();
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,65 @@
+// Frames/s of every CRC kernel supported by this CPU over the CRC span of
+// SCM (12 byte), SCM+ (16 byte) and IDM (92 byte) frames
+#include "../amr_crc.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_FRAMES (1u << 22)
+#define BENCH_POOL 256 //! Distinct frames cycled through, power of two
+
+static double benchSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static const struct {
+    const char * name;
+    size_t len; //! Frame length
+    size_t crcStart; //! First byte covered by the CRC
+    AMR_CRC poly;
+    uint16_t init;
+} benchFrames[] = {
+    {"scm", 12, 2, AMR_CRC_BCH, 0x0000},
+    {"scm+", 16, 2, AMR_CRC_CCITT, 0xffff},
+    {"idm", 92, 4, AMR_CRC_CCITT, 0xffff},
+};
+
+static uint8_t pool[BENCH_POOL][92];
+
+int main() {
+    uint32_t x = 0x12345678;
+    size_t i = 0;
+    for (; i < sizeof(pool); ++i) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        pool[i / sizeof(pool[0])][i % sizeof(pool[0])] = (uint8_t)x;
+    }
+
+    printf("default kernel: %s\n", amrCrcImplName(amrCrcImpl()));
+    printf("%-8s %-6s %14s %14s\n", "kernel", "frame", "frames/s", "bytes/s");
+    int impl = 0;
+    for (; impl < AMR_CRC_IMPL_CNT; ++impl) {
+        if (!amrCrcSelectImpl((AMR_CRC_IMPL)impl)) {
+            continue;
+        }
+        size_t f = 0;
+        for (; f < sizeof(benchFrames)/sizeof(benchFrames[0]); ++f) {
+            size_t span = benchFrames[f].len - benchFrames[f].crcStart;
+            volatile uint16_t sink = 0;
+            double t0 = benchSeconds();
+            for (i = 0; i < BENCH_FRAMES; ++i) {
+                sink ^= amrCrc16(benchFrames[f].poly, benchFrames[f].init,
+                        pool[i & (BENCH_POOL - 1)] + benchFrames[f].crcStart, span);
+            }
+            double dt = benchSeconds() - t0;
+            printf("%-8s %-6s %14.0f %14.0f\n", amrCrcImplName((AMR_CRC_IMPL)impl),
+                    benchFrames[f].name, BENCH_FRAMES / dt, (double)span * BENCH_FRAMES / dt);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+// Decode throughput of the multi-channel engine for 1..N worker threads
+#define _GNU_SOURCE
+#include "../ring/ringbuf.c"
+#include "../amr.c"
+#include "../amr_crc.c"
+#include "../amr_manch.c"
+#include "../amr_dedup.c"
+#include "../amr_engine.c"
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_CHANNELS 16
+#define BENCH_CHIPS_PER_CHANNEL (1u << 23)
+#define BENCH_PUSH_CHIPS (AMR_ENGINE_BLOCK_BYTES * 8 * 4)
+
+static double benchSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double benchRun(const uint8_t * packed, uint16_t workers) {
+    AmrEngineConfig cfg = {BENCH_CHANNELS, workers, 1, 0, NULL};
+    AmrEngine * eng = amrEngineCreate(&cfg);
+    if (eng == NULL) {
+        return 0;
+    }
+
+    size_t pos[BENCH_CHANNELS] = {0};
+    AmrEngineMsg msg;
+    double t0 = benchSeconds();
+    while (!amrEngineDone(eng)) {
+        uint16_t c = 0;
+        for (; c < BENCH_CHANNELS; ++c) {
+            if (pos[c] < BENCH_CHIPS_PER_CHANNEL) {
+                size_t n = BENCH_CHIPS_PER_CHANNEL - pos[c];
+                if (n > BENCH_PUSH_CHIPS) {
+                    n = BENCH_PUSH_CHIPS;
+                }
+                // Every channel decodes the same capture at its own offset
+                pos[c] += amrEnginePush(eng, c, packed + pos[c] / 8, n);
+                if (pos[c] == BENCH_CHIPS_PER_CHANNEL) {
+                    amrEngineClose(eng, c);
+                }
+            }
+        }
+        while (amrEnginePoll(eng, &msg)) {
+        }
+    }
+    double dt = benchSeconds() - t0;
+    amrEngineDestroy(eng);
+    return (double)BENCH_CHANNELS * BENCH_CHIPS_PER_CHANNEL / dt;
+}
+
+int main() {
+    uint8_t * packed = malloc(BENCH_CHIPS_PER_CHANNEL / 8);
+    if (!packed) {
+        return 1;
+    }
+
+    uint32_t x = 0x12345678;
+    size_t i = 0;
+    for (; i < BENCH_CHIPS_PER_CHANNEL / 8; ++i) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        packed[i] = (uint8_t)x;
+    }
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    printf("%-8s %14s\n", "workers", "chips/s");
+    uint16_t workers = 1;
+    for (; workers <= cpus && workers <= BENCH_CHANNELS; workers *= 2) {
+        printf("%-8u %14.0f\n", workers, benchRun(packed, workers));
+    }
+
+    free(packed);
+    return 0;
+}
@@ -0,0 +1,148 @@
+// Messages/s and bytes/s of every encoder for each message type, against an
+// snprintf rendering of the same JSON as the baseline
+#include "../amr_format.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_MSGS (1u << 20)
+#define BENCH_POOL 64 //! Distinct messages cycled through, power of two
+
+static double benchSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static AmrScmMsg scmPool[BENCH_POOL];
+static AmrScmPlusMsg scmPlusPool[BENCH_POOL];
+static AmrIdmMsg idmPool[BENCH_POOL];
+static char out[AMR_FORMAT_MAX_LEN];
+
+static uint32_t xorshift(uint32_t * x) {
+    *x ^= *x << 13;
+    *x ^= *x >> 17;
+    *x ^= *x << 5;
+    return *x;
+}
+
+static const void * poolMsg(AMR_MSG_TYPE type, size_t i) {
+    i &= BENCH_POOL - 1;
+    switch (type) {
+        case AMR_MSG_TYPE_SCM: return &scmPool[i];
+        case AMR_MSG_TYPE_SCM_PLUS: return &scmPlusPool[i];
+        default: return &idmPool[i];
+    }
+}
+
+static size_t snprintfJson(char * buf, size_t size, AMR_MSG_TYPE type, const void * msg, uint64_t time) {
+    int len = 0;
+    if (type == AMR_MSG_TYPE_SCM) {
+        const AmrScmMsg * scm = (const AmrScmMsg *)msg;
+        len = snprintf(buf, size, "{\"Time\":%llu,\"Type\":\"SCM\",\"Message\":{\"ID\":%u,"
+                "\"Type\":%u,\"TamperPhy\":%u,\"TamperEnc\":%u,\"Consumption\":%u,"
+                "\"ChecksumVal\":%u}}\n", (unsigned long long)time, scm->id, scm->type,
+                scm->tamper_phy, scm->tamper_enc, scm->consumption, scm->crc);
+    }
+    else if (type == AMR_MSG_TYPE_SCM_PLUS) {
+        const AmrScmPlusMsg * scmPlus = (const AmrScmPlusMsg *)msg;
+        len = snprintf(buf, size, "{\"Time\":%llu,\"Type\":\"SCM+\",\"Message\":{\"FrameSync\":%u,"
+                "\"ProtocolID\":%u,\"EndpointType\":%u,\"EndpointID\":%u,\"Consumption\":%u,"
+                "\"Tamper\":%u,\"PacketCRC\":%u}}\n", (unsigned long long)time,
+                scmPlus->frameSync, scmPlus->protocolId, scmPlus->endpointType,
+                scmPlus->endpointId, scmPlus->consumption, scmPlus->tamper, scmPlus->crc);
+    }
+    else {
+        const AmrIdmMsg * idm = (const AmrIdmMsg *)msg;
+        size_t i = 0;
+        len = snprintf(buf, size, "{\"Time\":%llu,\"Type\":\"IDM\",\"Message\":{\"ERTType\":%u,"
+                "\"ERTSerialNumber\":%u,\"ConsumptionIntervalCount\":%u,"
+                "\"ModuleProgrammingState\":%u,\"LastConsumptionCount\":%u,"
+                "\"DifferentialConsumptionIntervals\":[", (unsigned long long)time,
+                idm->ertType, idm->ertId, idm->consumptionIntervalCount,
+                idm->data.std.moduleProgrammingState, idm->data.std.lastConsumption);
+        for (; i < 47; ++i) {
+            len += snprintf(buf + len, size - len, i ? ",%u" : "%u",
+                    idm->data.std.differentialConsumption[i]);
+        }
+        len += snprintf(buf + len, size - len, "],\"TransmitTimeOffset\":%u,"
+                "\"SerialNumberCRC\":%u,\"PacketCRC\":%u}}\n",
+                idm->txTimeOffset, idm->serialNumberCRC, idm->pktCRC);
+    }
+    return len > 0 ? (size_t)len : 0;
+}
+
+static size_t benchJson(uint8_t * buf, size_t size, AMR_MSG_TYPE type, const void * msg, uint64_t time) {
+    return amrFormatJson((char *)buf, size, type, msg, time);
+}
+
+static size_t benchCsv(uint8_t * buf, size_t size, AMR_MSG_TYPE type, const void * msg, uint64_t time) {
+    return amrFormatCsv((char *)buf, size, type, msg, time);
+}
+
+static size_t benchSnprintf(uint8_t * buf, size_t size, AMR_MSG_TYPE type, const void * msg, uint64_t time) {
+    return snprintfJson((char *)buf, size, type, msg, time);
+}
+
+static const struct {
+    const char * name;
+    size_t (*format)(uint8_t * buf, size_t size, AMR_MSG_TYPE type, const void * msg, uint64_t time);
+} benchFormats[] = {
+    {"json", benchJson},
+    {"csv", benchCsv},
+    {"binary", amrFormatBinary},
+    {"snprintf", benchSnprintf},
+};
+
+static const char * typeNames[] = {"scm", "scm+", "idm"};
+
+int main() {
+    uint32_t x = 0x12345678;
+    size_t i = 0;
+    for (; i < BENCH_POOL; ++i) {
+        size_t j = 0;
+        scmPool[i].id = xorshift(&x) >> 6;
+        scmPool[i].type = xorshift(&x) & 0xf;
+        scmPool[i].tamper_phy = xorshift(&x) & 3;
+        scmPool[i].tamper_enc = xorshift(&x) & 3;
+        scmPool[i].consumption = xorshift(&x) >> 8;
+        scmPool[i].crc = (uint16_t)xorshift(&x);
+        scmPlusPool[i].frameSync = 0x16a3;
+        scmPlusPool[i].protocolId = 0x1e;
+        scmPlusPool[i].endpointType = (uint8_t)xorshift(&x);
+        scmPlusPool[i].endpointId = xorshift(&x);
+        scmPlusPool[i].consumption = xorshift(&x) >> 8;
+        scmPlusPool[i].tamper = (uint16_t)xorshift(&x);
+        scmPlusPool[i].crc = (uint16_t)xorshift(&x);
+        idmPool[i].ertType = 7;
+        idmPool[i].ertId = xorshift(&x);
+        idmPool[i].consumptionIntervalCount = (uint8_t)xorshift(&x);
+        idmPool[i].data.std.lastConsumption = xorshift(&x) >> 8;
+        for (; j < 47; ++j) {
+            idmPool[i].data.std.differentialConsumption[j] = xorshift(&x) >> 22;
+        }
+        idmPool[i].txTimeOffset = (uint16_t)xorshift(&x);
+        idmPool[i].serialNumberCRC = (uint16_t)xorshift(&x);
+        idmPool[i].pktCRC = (uint16_t)xorshift(&x);
+    }
+
+    printf("%-9s %-5s %14s %14s\n", "format", "msg", "msgs/s", "bytes/s");
+    size_t f = 0;
+    for (; f < sizeof(benchFormats)/sizeof(benchFormats[0]); ++f) {
+        int type = AMR_MSG_TYPE_SCM;
+        for (; type <= AMR_MSG_TYPE_IDM; ++type) {
+            uint64_t time = 1700000000000ull;
+            size_t bytes = 0;
+            double t0 = benchSeconds();
+            for (i = 0; i < BENCH_MSGS; ++i) {
+                bytes += benchFormats[f].format((uint8_t *)out, sizeof(out), (AMR_MSG_TYPE)type,
+                        poolMsg((AMR_MSG_TYPE)type, i), time++);
+            }
+            double dt = benchSeconds() - t0;
+            printf("%-9s %-5s %14.0f %14.0f\n", benchFormats[f].name, typeNames[type],
+                    BENCH_MSGS / dt, bytes / dt);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,146 @@
+// Decode rate, recall and false positives on generated traffic as the frame
+// rate and the chip error rate rise. Recall counts distinct frames decoded
+// out of all generated, collisions included. False positives are messages
+// that passed their CRC but match no generated frame.
+#include "../ring/ringbuf.c"
+#include "../amr.c"
+#include "../amr_crc.c"
+#include "../amr_manch.c"
+#include "../amr_dedup.c"
+#include "../amr_gen.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_SECONDS 600 //! Simulated air time per row
+#define BENCH_MIN_FRAMES 4000 //! Air time is extended until this many frames
+#define BENCH_BATCH 64
+
+typedef struct {
+    uint64_t key; //! Type, ID and consumption hashed together
+    uint8_t seen;
+} BenchTruth;
+
+static BenchTruth * truth;
+static size_t truthCnt;
+static size_t truthMax;
+static AmrTaggedMsg batch[BENCH_BATCH];
+
+static double benchSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static inline uint64_t benchKey(uint8_t type, uint32_t id, uint32_t consumption) {
+    uint64_t k = ((uint64_t)type << 62) ^ ((uint64_t)id << 32) ^ consumption;
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdull;
+    return k ^ (k >> 33);
+}
+
+static void benchFrame(void * user, const AmrGenFrame * frame) {
+    if (truthCnt == truthMax) {
+        truthMax = truthMax ? truthMax * 2 : 4096;
+        truth = (BenchTruth *)realloc(truth, truthMax * sizeof(*truth));
+    }
+    truth[truthCnt].key = benchKey(frame->type, frame->id, frame->consumption);
+    truth[truthCnt].seen = 0;
+    ++truthCnt;
+}
+
+static int benchCompare(const void * a, const void * b) {
+    uint64_t x = ((const BenchTruth *)a)->key;
+    uint64_t y = ((const BenchTruth *)b)->key;
+    return x < y ? -1 : x > y;
+}
+
+static BenchTruth * benchFind(uint64_t key) {
+    size_t lo = 0;
+    size_t hi = truthCnt;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (truth[mid].key < key) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo < truthCnt && truth[lo].key == key ? &truth[lo] : NULL;
+}
+
+static uint64_t msgKey(const AmrTaggedMsg * m) {
+    switch (m->hdr.type) {
+        case AMR_MSG_TYPE_SCM:
+            return benchKey(AMR_MSG_TYPE_SCM, m->msg.scm.id, m->msg.scm.consumption);
+        case AMR_MSG_TYPE_SCM_PLUS:
+            return benchKey(AMR_MSG_TYPE_SCM_PLUS, m->msg.scmPlus.endpointId, m->msg.scmPlus.consumption);
+        default:
+            return benchKey(AMR_MSG_TYPE_IDM, m->msg.idm.ertId, m->msg.idm.data.std.lastConsumption);
+    }
+}
+
+int main() {
+    static const double rates[] = {1, 5, 20, 50, 100, 200};
+    static const double errors[] = {0, 1e-4, 1e-3};
+    static AmrDecoder dec;
+    size_t r = 0;
+
+    printf("%8s %8s %8s %12s %8s %8s\n", "frames/s", "chip err", "frames", "chips/s", "recall", "false+");
+    for (; r < sizeof(rates) / sizeof(rates[0]); ++r) {
+        size_t e = 0;
+        for (; e < sizeof(errors) / sizeof(errors[0]); ++e) {
+            AmrGenConfig cfg = {0};
+            AmrGen gen;
+            double air = BENCH_SECONDS;
+            if (air * rates[r] < BENCH_MIN_FRAMES) {
+                air = BENCH_MIN_FRAMES / rates[r];
+            }
+            size_t nbits = ((size_t)(air * AMR_GEN_CHIP_RATE) + 63) & ~(size_t)63;
+            uint8_t * packed = (uint8_t *)malloc(nbits / 8);
+            size_t decoded = 0;
+            size_t matched = 0;
+            size_t falsePos = 0;
+            size_t i;
+
+            cfg.seed = 1 + r * 16 + e;
+            cfg.framesPerSec = rates[r];
+            cfg.chipErrorRate = errors[e];
+            cfg.randomNoise = 1;
+            truthCnt = 0;
+            amrGenInit(&gen, &cfg, benchFrame, NULL);
+            amrGenFill(&gen, packed, nbits);
+            qsort(truth, truthCnt, sizeof(*truth), benchCompare);
+
+            amrDecoderInit(&dec);
+            double t0 = benchSeconds();
+            for (i = 0; i < nbits; i += 512) {
+                size_t n;
+                amrDecoderProcessBits(&dec, packed + i / 8, nbits - i < 512 ? nbits - i : 512);
+                while ((n = amrDecoderDrainMsgs(&dec, batch, BENCH_BATCH)) > 0) {
+                    size_t m = 0;
+                    for (; m < n; ++m) {
+                        BenchTruth * t = benchFind(msgKey(&batch[m]));
+                        if (t == NULL) {
+                            ++falsePos;
+                        }
+                        else if (!t->seen) {
+                            t->seen = 1;
+                            ++matched;
+                        }
+                    }
+                    decoded += n;
+                }
+            }
+            double dt = benchSeconds() - t0;
+
+            printf("%8.0f %8.0e %8zu %12.0f %7.2f%% %8zu\n", rates[r], errors[e], truthCnt,
+                    nbits / dt, truthCnt ? 100.0 * matched / truthCnt : 0.0, falsePos);
+            free(packed);
+        }
+    }
+    free(truth);
+    return 0;
+}
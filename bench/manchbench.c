@@ -0,0 +1,55 @@
+// Chips/s of every Manchester decode kernel supported by this CPU
+#include "../amr_manch.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_BYTES (1u << 22)
+#define BENCH_ROUNDS 16
+
+static double benchSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main() {
+    uint8_t * chips = malloc(BENCH_BYTES);
+    uint8_t * phase0 = malloc(BENCH_BYTES / 2);
+    uint8_t * phase1 = malloc(BENCH_BYTES / 2);
+    if (!chips || !phase0 || !phase1) {
+        return 1;
+    }
+
+    uint32_t x = 0x12345678;
+    size_t i = 0;
+    for (; i < BENCH_BYTES; ++i) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        chips[i] = (uint8_t)x;
+    }
+
+    printf("default kernel: %s\n", amrManchImplName(amrManchImpl()));
+    printf("%-8s %14s\n", "kernel", "chips/s");
+    int impl = 0;
+    for (; impl < AMR_MANCH_IMPL_CNT; ++impl) {
+        if (!amrManchSelectImpl((AMR_MANCH_IMPL)impl)) {
+            continue;
+        }
+        double t0 = benchSeconds();
+        int r = 0;
+        for (; r < BENCH_ROUNDS; ++r) {
+            amrManchDecode(chips, BENCH_BYTES, r & 1, phase0, phase1);
+        }
+        double dt = benchSeconds() - t0;
+        printf("%-8s %14.0f\n", amrManchImplName((AMR_MANCH_IMPL)impl),
+                8.0 * BENCH_BYTES * BENCH_ROUNDS / dt);
+    }
+
+    free(chips);
+    free(phase0);
+    free(phase1);
+    return 0;
+}
@@ -0,0 +1,54 @@
+// Bytes/s of the old byte-at-a-time frame realignment against amrRealign for
+// IDM sized frames at every bit offset
+#include "../ring/ringbuf.c"
+#include "../amr.c"
+#include "../amr_crc.c"
+#include "../amr_manch.c"
+#include "../amr_dedup.c"
+
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_FRAMES (1u << 20)
+
+static double benchSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// The loop amrDecoderProcessMsgs used before amrRealign
+static void __attribute__((noinline)) benchByteRealign(uint8_t * data, size_t len, uint8_t offset) {
+    size_t i = 0;
+    for (; i < len; ++i) {
+        data[i] = (data[i] << offset) | (data[i+1] >> (8-offset));
+    }
+}
+
+static void __attribute__((noinline)) benchWordRealign(uint8_t * data, size_t len, uint8_t offset) {
+    amrRealign(data, len, data[len], offset);
+}
+
+static uint8_t frame[AMR_MSG_IDM_RAW_SIZE + 1];
+
+int main() {
+    size_t i = 0;
+    for (; i < sizeof(frame); ++i) {
+        frame[i] = (uint8_t)(i * 37);
+    }
+
+    printf("%-8s %14s\n", "path", "bytes/s");
+    const char * names[] = {"byte", "word"};
+    void (*funcs[])(uint8_t *, size_t, uint8_t) = {benchByteRealign, benchWordRealign};
+    int f = 0;
+    for (; f < 2; ++f) {
+        double t0 = benchSeconds();
+        for (i = 0; i < BENCH_FRAMES; ++i) {
+            funcs[f](frame, AMR_MSG_IDM_RAW_SIZE, 1 + i % 7);
+        }
+        double dt = benchSeconds() - t0;
+        printf("%-8s %14.0f\n", names[f], (double)AMR_MSG_IDM_RAW_SIZE * BENCH_FRAMES / dt);
+    }
+
+    return 0;
+}
@@ -0,0 +1,173 @@
+// Cycle count comparison of the amrProcessRxBit preamble correlator against
+// the previous byte reassembly implementation (kept below as legacyProcessRxBit)
+#include "../ring/ringbuf.c"
+#include "../amr.c"
+#include "../amr_crc.c"
+#include "../amr_manch.c"
+#include "../amr_dedup.c"
+
+#include <stdlib.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define BENCH_CHIPS (1u << 22)
+#define BENCH_DRAIN_INTERVAL 1024
+#define BENCH_FRAME_INTERVAL 4096
+
+/* Previous implementation of amrProcessRxBit */
+#define LEGACY_RX_BUF_SIZE (AMR_MSG_HDR_SIZE + 2*AMR_MAX_MSG_SIZE)
+
+static uint8_t legacyRxBuf0[LEGACY_RX_BUF_SIZE] = {0};
+static uint8_t legacyRxBuf1[LEGACY_RX_BUF_SIZE] = {0};
+static uint8_t *legacyRxBuf = legacyRxBuf0;
+static uint16_t legacyRxBufHeadBit = 0;
+static uintptr_t legacyXorRxBufPtr = 0;
+static uint8_t legacyPrevRxBit = 0;
+static Ring legacyRing;
+static uint8_t legacyRingData[AMR_DECODER_RING_SIZE] = {0};
+
+static inline void legacyPushMsg(uint8_t * data, AMR_MSG_TYPE type,
+        uint8_t bitOffset, RingPos_t size) {
+    AmrMsgHeader * hdr = (AmrMsgHeader *)(data - AMR_MSG_HDR_SIZE);
+    hdr->type = type;
+    hdr->bitOffset = bitOffset;
+    ringPush(&legacyRing, (uint8_t*)hdr, size + AMR_MSG_HDR_SIZE + 1);
+}
+
+static inline void legacyProcessRxBit(uint8_t rxBit) {
+    legacyRxBuf = (uint8_t*)(legacyXorRxBufPtr ^ (uintptr_t)legacyRxBuf);
+
+    uint8_t manchBit = legacyPrevRxBit && !rxBit;
+
+    uint8_t* bufHead = legacyRxBuf + AMR_MSG_HDR_SIZE + (legacyRxBufHeadBit / 8);
+    uint8_t bitOffset = (legacyRxBufHeadBit % 8);
+    uint8_t nthBit = 7 - bitOffset;
+
+    *bufHead = (*bufHead & (~(1u << nthBit))) | (manchBit << nthBit);
+    *(bufHead + AMR_MAX_MSG_SIZE) = *bufHead;
+
+    uint8_t* msgEnd = bufHead + AMR_MAX_MSG_SIZE;
+    uint8_t* scmData = msgEnd - AMR_MSG_SCM_RAW_SIZE;
+    uint8_t* idmData = msgEnd - AMR_MSG_IDM_RAW_SIZE;
+    uint8_t* scmPlusData = idmData;
+
+    uint32_t scmPre =
+        (scmData[0] << (24+bitOffset)) |
+        (scmData[1] << (16+bitOffset)) |
+        (scmData[2] << (8+bitOffset)) |
+        (scmData[3] << (0+bitOffset)) |
+        (scmData[4] >> (8-bitOffset));
+    uint32_t idmPre =
+        idmData[0] << (24+bitOffset) |
+        idmData[1] << (16+bitOffset) |
+        idmData[2] << (8+bitOffset) |
+        idmData[3] << (0+bitOffset) |
+        idmData[4] >> (8-bitOffset);
+    uint32_t scmPlusPre = idmPre;
+
+    if ((scmPre & SCM_PRE_32_MASK) == SCM_PRE_32) {
+        legacyPushMsg(scmData, AMR_MSG_TYPE_SCM, bitOffset, AMR_MSG_SCM_RAW_SIZE);
+    }
+    else if (idmPre == IDM_PRE_32) {
+        legacyPushMsg(idmData, AMR_MSG_TYPE_IDM, bitOffset, AMR_MSG_IDM_RAW_SIZE);
+    }
+    else if ((scmPlusPre & SCM_PLUS_PRE_32_MASK) == SCM_PLUS_PRE_32) {
+        legacyPushMsg(scmPlusData, AMR_MSG_TYPE_SCM_PLUS, bitOffset,
+                AMR_MSG_SCM_PLUS_RAW_SIZE);
+    }
+
+    legacyPrevRxBit = rxBit;
+
+    if (legacyRxBuf == legacyRxBuf1) {
+        legacyRxBufHeadBit = (legacyRxBufHeadBit + 1) % (AMR_MAX_MSG_SIZE*8);
+    }
+}
+
+static inline uint64_t benchCycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    // No portable cycle counter, report nanoseconds instead
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+}
+
+// Random chips with a Manchester encoded SCM or IDM preamble mixed in
+static void benchFillChips(uint8_t * chips, size_t n) {
+    static const uint8_t preambles[2][4] = {
+        {0xf9, 0x53, 0x00, 0x00}, {0x55, 0x55, 0x16, 0xa3}};
+    uint32_t x = 0x12345678;
+    size_t i = 0;
+    for (; i < n; ++i) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        chips[i] = x & 1;
+    }
+
+    size_t pos = 0;
+    uint8_t sel = 0;
+    for (; pos + 64 < n; pos += BENCH_FRAME_INTERVAL, sel ^= 1) {
+        uint8_t b = 0;
+        for (; b < 32; ++b) {
+            uint8_t bit = (preambles[sel][b / 8] >> (7 - b % 8)) & 1;
+            chips[pos + 2*b] = bit;
+            chips[pos + 2*b + 1] = !bit;
+        }
+    }
+}
+
+static uint32_t benchDrain(Ring * ring) {
+    uint32_t cnt = 0;
+    while (ringPop(ring, NULL, 0)) {
+        ++cnt;
+    }
+    return cnt;
+}
+
+int main() {
+    uint8_t * chips = malloc(BENCH_CHIPS);
+    if (!chips) {
+        return 1;
+    }
+    benchFillChips(chips, BENCH_CHIPS);
+
+    amrInit();
+    legacyRing = ringInit(legacyRingData, sizeof(legacyRingData));
+    legacyXorRxBufPtr = (uintptr_t)(legacyRxBuf0) ^ (uintptr_t)(legacyRxBuf1);
+
+    uint64_t legacyCycles = 0;
+    uint64_t newCycles = 0;
+    uint32_t legacyMsgs = 0;
+    uint32_t newMsgs = 0;
+    size_t i = 0;
+    for (; i < BENCH_CHIPS; i += BENCH_DRAIN_INTERVAL) {
+        size_t j = 0;
+        uint64_t t0 = benchCycles();
+        for (j = i; j < i + BENCH_DRAIN_INTERVAL; ++j) {
+            legacyProcessRxBit(chips[j]);
+        }
+        uint64_t t1 = benchCycles();
+        for (j = i; j < i + BENCH_DRAIN_INTERVAL; ++j) {
+            amrProcessRxBit(chips[j]);
+        }
+        uint64_t t2 = benchCycles();
+        legacyCycles += t1 - t0;
+        newCycles += t2 - t1;
+        legacyMsgs += benchDrain(&legacyRing);
+        newMsgs += benchDrain(&amrDefaultDecoder.msgRing);
+    }
+
+    printf("%-10s %10s %10s\n", "impl", "cycles/bit", "msgs");
+    printf("%-10s %10.2f %10u\n", "legacy",
+            (double)legacyCycles / BENCH_CHIPS, legacyMsgs);
+    printf("%-10s %10.2f %10u\n", "correlator",
+            (double)newCycles / BENCH_CHIPS, newMsgs);
+
+    free(chips);
+    return 0;
+}
@@ -0,0 +1,70 @@
+// Throughput of the per bit amrProcessRxBit path against the amrProcessRxBits
+// bulk path on the same packed chip stream
+#include "../ring/ringbuf.c"
+#include "../amr.c"
+#include "../amr_crc.c"
+#include "../amr_manch.c"
+#include "../amr_dedup.c"
+
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_CHIPS (1u << 25)
+#define BENCH_BLOCK_CHIPS 1024
+
+static double benchSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t benchMsgCnt = 0;
+
+static void benchMsgCallback(const void * msg, AMR_MSG_TYPE msgType, const uint8_t * data) {
+    ++benchMsgCnt;
+}
+
+int main() {
+    uint8_t * packed = malloc(BENCH_CHIPS / 8);
+    if (!packed) {
+        return 1;
+    }
+
+    uint32_t x = 0x12345678;
+    size_t i = 0;
+    for (; i < BENCH_CHIPS / 8; ++i) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        packed[i] = (uint8_t)x;
+    }
+
+    registerAmrMsgCallback(benchMsgCallback);
+
+    amrInit();
+    double t0 = benchSeconds();
+    for (i = 0; i < BENCH_CHIPS; ++i) {
+        amrProcessRxBit((packed[i / 8] >> (7 - i % 8)) & 1);
+        if (i % BENCH_BLOCK_CHIPS == BENCH_BLOCK_CHIPS - 1) {
+            amrProcessMsgs();
+        }
+    }
+    double bitTime = benchSeconds() - t0;
+    uint32_t bitMsgs = benchMsgCnt;
+
+    benchMsgCnt = 0;
+    amrInit();
+    t0 = benchSeconds();
+    for (i = 0; i < BENCH_CHIPS; i += BENCH_BLOCK_CHIPS) {
+        amrProcessRxBits(packed + i / 8, BENCH_BLOCK_CHIPS);
+        amrProcessMsgs();
+    }
+    double bulkTime = benchSeconds() - t0;
+
+    printf("%-10s %14s %10s\n", "path", "bits/s", "msgs");
+    printf("%-10s %14.0f %10u\n", "per-bit", BENCH_CHIPS / bitTime, bitMsgs);
+    printf("%-10s %14.0f %10u\n", "bulk", BENCH_CHIPS / bulkTime, benchMsgCnt);
+
+    free(packed);
+    return 0;
+}
@@ -0,0 +1,43 @@
+# Training run for AMR_PGO=GENERATE, see ../CMakeLists.txt. Decodes a capture
+# while recording its frames, then replays the recording through every
+# output format.
+#
+# -DAMRGEN=<path> -DAMRDUMP=<path> -DPGO_DIR=<dir> [-DCAPTURE=<file>] [-DPROFDATA=<llvm-profdata>]
+set(work ${PGO_DIR}/train)
+file(MAKE_DIRECTORY ${work})
+
+if(NOT CAPTURE)
+    # Ten minutes of traffic at 20 frames/s with a few chip errors
+    set(CAPTURE ${work}/capture.bin)
+    execute_process(COMMAND ${AMRGEN} -s 1 -f 20 -e 1e-4 -d 600 ${CAPTURE}
+        RESULT_VARIABLE result)
+    if(result)
+        message(FATAL_ERROR "amrgen failed: ${result}")
+    endif()
+endif()
+
+execute_process(COMMAND ${AMRDUMP} -w ${work}/frames.amrr ${CAPTURE}
+    OUTPUT_FILE ${work}/capture.json
+    RESULT_VARIABLE result)
+if(result)
+    message(FATAL_ERROR "amrdump failed on ${CAPTURE}: ${result}")
+endif()
+
+foreach(format json csv binary)
+    execute_process(COMMAND ${AMRDUMP} -r -o ${format} ${work}/frames.amrr
+        OUTPUT_FILE ${work}/replay.${format}
+        RESULT_VARIABLE result)
+    if(result)
+        message(FATAL_ERROR "amrdump replay failed: ${result}")
+    endif()
+endforeach()
+
+# Clang writes raw profiles that have to be merged first
+if(PROFDATA)
+    file(GLOB raw ${PGO_DIR}/*.profraw)
+    execute_process(COMMAND ${PROFDATA} merge -o ${PGO_DIR}/default.profdata ${raw}
+        RESULT_VARIABLE result)
+    if(result)
+        message(FATAL_ERROR "llvm-profdata merge failed: ${result}")
+    endif()
+endif()
@@ -0,0 +1,270 @@
+#include "amr_hal.h"
+#include "../../../amr.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define HAL_LOAD_ACQUIRE(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define HAL_STORE_RELEASE(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+
+static struct {
+    int fd; //! Source read in blocks, valid when haveFd is set
+    uint8_t haveFd;
+    const uint8_t * map; //! Mapped source
+    size_t mapLen;
+    AMR_HAL_FORMAT format;
+    pthread_t producer;
+    pthread_t consumer;
+    uint8_t started;
+    uint8_t stop; //! Set to end the run early
+    uint8_t producerDone;
+    uint8_t consumerDone;
+    uint32_t fed; //! Blocks fed, written by the producer
+    uint32_t drained; //! Blocks known drained, written by the consumer
+    uint64_t chips;
+    // Conversion of unpacked formats, producer only
+    uint8_t acc;
+    uint8_t accBits;
+    size_t stageLen;
+    uint8_t stage[AMR_HAL_STAGE_SIZE];
+    uint8_t readBuf[AMR_HAL_READ_SIZE];
+} amrHal;
+
+// Feed packed chips in blocks, staying at most one block ahead of the consumer
+static void halFeed(const uint8_t * packed, size_t nbits) {
+    size_t pos = 0;
+    for (; pos < nbits; pos += AMR_HAL_BLOCK_CHIPS) {
+        size_t n = nbits - pos < AMR_HAL_BLOCK_CHIPS ? nbits - pos : AMR_HAL_BLOCK_CHIPS;
+        while (amrHal.fed - HAL_LOAD_ACQUIRE(&amrHal.drained) > 1) {
+            sched_yield();
+        }
+        if (HAL_LOAD_ACQUIRE(&amrHal.stop)) {
+            return;
+        }
+        amrProcessRxBits(packed + pos / 8, n);
+        HAL_STORE_RELEASE(&amrHal.chips, amrHal.chips + n);
+        HAL_STORE_RELEASE(&amrHal.fed, amrHal.fed + 1);
+    }
+}
+
+static void halStageFlush(uint8_t final) {
+    size_t nbits = amrHal.stageLen * 8;
+    if (final && amrHal.accBits) {
+        amrHal.stage[amrHal.stageLen] = (uint8_t)(amrHal.acc << (8 - amrHal.accBits));
+        nbits += amrHal.accBits;
+        amrHal.acc = 0;
+        amrHal.accBits = 0;
+    }
+    halFeed(amrHal.stage, nbits);
+    amrHal.stageLen = 0;
+}
+
+static inline void halStageChip(uint8_t chip) {
+    amrHal.acc = (uint8_t)((amrHal.acc << 1) | chip);
+    if (++amrHal.accBits == 8) {
+        amrHal.stage[amrHal.stageLen++] = amrHal.acc;
+        amrHal.acc = 0;
+        amrHal.accBits = 0;
+        if (amrHal.stageLen == sizeof(amrHal.stage)) {
+            halStageFlush(0);
+        }
+    }
+}
+
+// Convert a chunk of the source and feed it. Returns the bytes consumed,
+// BITS input is taken 8 bytes at a time until final.
+static size_t halConvert(const uint8_t * data, size_t len, uint8_t final) {
+    size_t i = 0;
+    switch (amrHal.format) {
+        case AMR_HAL_FORMAT_PACKED:
+            halFeed(data, len * 8);
+            return len;
+        case AMR_HAL_FORMAT_BITS:
+            for (; i + 8 <= len; i += 8) {
+                uint64_t x;
+                memcpy(&x, data + i, sizeof(x));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+                x = __builtin_bswap64(x);
+#endif
+                // Gather the LSB of each byte, the first byte into bit 7
+                x &= 0x0101010101010101ull;
+                amrHal.stage[amrHal.stageLen++] = (uint8_t)((x * 0x8040201008040201ull) >> 56);
+                if (amrHal.stageLen == sizeof(amrHal.stage)) {
+                    halStageFlush(0);
+                }
+            }
+            if (final) {
+                for (; i < len; ++i) {
+                    halStageChip(data[i] & 1);
+                }
+            }
+            return i;
+        case AMR_HAL_FORMAT_ASCII:
+            for (; i < len; ++i) {
+                if (data[i] == '0' || data[i] == '1') {
+                    halStageChip(data[i] - '0');
+                }
+            }
+            return i;
+        default:
+            return len;
+    }
+}
+
+static void * halProducerMain(void * arg) {
+    if (amrHal.map) {
+        size_t pos = 0;
+        while (pos < amrHal.mapLen && !HAL_LOAD_ACQUIRE(&amrHal.stop)) {
+            size_t len = amrHal.mapLen - pos < AMR_HAL_READ_SIZE ? amrHal.mapLen - pos : AMR_HAL_READ_SIZE;
+            pos += halConvert(amrHal.map + pos, len, pos + len == amrHal.mapLen);
+        }
+    }
+    else {
+        size_t have = 0;
+        for (;;) {
+            ssize_t n;
+            if (HAL_LOAD_ACQUIRE(&amrHal.stop)) {
+                break;
+            }
+            n = read(amrHal.fd, amrHal.readBuf + have, sizeof(amrHal.readBuf) - have);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                halConvert(amrHal.readBuf, have, 1);
+                break;
+            }
+            have += (size_t)n;
+            size_t used = halConvert(amrHal.readBuf, have, 0);
+            memmove(amrHal.readBuf, amrHal.readBuf + used, have - used);
+            have -= used;
+        }
+    }
+    halStageFlush(1);
+    HAL_STORE_RELEASE(&amrHal.producerDone, 1);
+    return NULL;
+}
+
+static void * halConsumerMain(void * arg) {
+    for (;;) {
+        // Everything fed before producerDone was set is drained by the final pass
+        uint8_t done = HAL_LOAD_ACQUIRE(&amrHal.producerDone);
+        uint32_t fed = HAL_LOAD_ACQUIRE(&amrHal.fed);
+        amrProcessMsgs();
+        HAL_STORE_RELEASE(&amrHal.drained, fed);
+        if (done) {
+            break;
+        }
+        if (fed == HAL_LOAD_ACQUIRE(&amrHal.fed)) {
+            sched_yield();
+        }
+    }
+    HAL_STORE_RELEASE(&amrHal.consumerDone, 1);
+    return NULL;
+}
+
+static void halClose() {
+    if (amrHal.map) {
+        munmap((void *)amrHal.map, amrHal.mapLen);
+        amrHal.map = NULL;
+        amrHal.mapLen = 0;
+    }
+    if (amrHal.haveFd && amrHal.fd != STDIN_FILENO) {
+        close(amrHal.fd);
+    }
+    amrHal.haveFd = 0;
+    amrHal.chips = 0;
+}
+
+uint8_t amrHalSetSource(const char * path, AMR_HAL_FORMAT format) {
+    struct stat st;
+    int fd;
+    amrHalEnable(0);
+    halClose();
+    if (path == NULL) {
+        return 1;
+    }
+
+    amrHal.format = format;
+    if (strcmp(path, "-") == 0) {
+        amrHal.fd = STDIN_FILENO;
+        amrHal.haveFd = 1;
+        return 1;
+    }
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void * map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+            amrHal.map = (const uint8_t *)map;
+            amrHal.mapLen = (size_t)st.st_size;
+            close(fd);
+            return 1;
+        }
+    }
+    amrHal.fd = fd;
+    amrHal.haveFd = 1;
+    return 1;
+}
+
+void amrHalInit() {
+    amrHalEnable(0);
+}
+
+uint8_t amrHalRunning() {
+    return amrHal.started && !HAL_LOAD_ACQUIRE(&amrHal.consumerDone);
+}
+
+void amrHalWait() {
+    if (!amrHal.started) {
+        return;
+    }
+
+    pthread_join(amrHal.producer, NULL);
+    pthread_join(amrHal.consumer, NULL);
+    amrHal.started = 0;
+}
+
+void amrHalEnable(uint8_t enable) {
+    if (!enable) {
+        HAL_STORE_RELEASE(&amrHal.stop, 1);
+        amrHalWait();
+        return;
+    }
+
+    if (amrHal.started || (amrHal.map == NULL && !amrHal.haveFd)) {
+        return;
+    }
+
+    amrHal.stop = 0;
+    amrHal.producerDone = 0;
+    amrHal.consumerDone = 0;
+    amrHal.fed = 0;
+    amrHal.drained = 0;
+    amrHal.chips = 0;
+    amrHal.acc = 0;
+    amrHal.accBits = 0;
+    amrHal.stageLen = 0;
+    if (pthread_create(&amrHal.consumer, NULL, halConsumerMain, NULL) != 0) {
+        return;
+    }
+    if (pthread_create(&amrHal.producer, NULL, halProducerMain, NULL) != 0) {
+        HAL_STORE_RELEASE(&amrHal.producerDone, 1);
+        pthread_join(amrHal.consumer, NULL);
+        return;
+    }
+    amrHal.started = 1;
+}
+
+uint64_t amrHalChips() {
+    return HAL_LOAD_ACQUIRE(&amrHal.chips);
+}
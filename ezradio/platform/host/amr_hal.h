@@ -0,0 +1,37 @@
+#ifndef AMR_HAL_H
+#define AMR_HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Host HAL: replays a chip capture instead of the radio. Regular files are
+// mapped, pipes and stdin are read in large blocks. A producer thread feeds
+// the default decoder in blocks of AMR_HAL_BLOCK_CHIPS and a consumer thread
+// runs amrProcessMsgs, so callbacks are called from the consumer thread.
+
+#define AMR_HAL_BLOCK_CHIPS 512 //! Chips per amrProcessRxBits call, sized so msgRing can't overflow
+#define AMR_HAL_READ_SIZE (1 << 20) //! Bytes per read() from pipes and stdin
+#define AMR_HAL_STAGE_SIZE 65536 //! Packed bytes converted before they are fed
+
+typedef enum {
+    AMR_HAL_FORMAT_PACKED = 0, //! Chips packed MSB first, as for amrProcessRxBits
+    AMR_HAL_FORMAT_BITS, //! One chip per byte in the LSB
+    AMR_HAL_FORMAT_ASCII //! '0' and '1' characters, anything else is skipped
+} AMR_HAL_FORMAT;
+
+// Open the capture for the next run, "-" for stdin, NULL to close it. Call
+// before amrInit. Returns 0 when the capture can't be opened.
+uint8_t amrHalSetSource(const char * path, AMR_HAL_FORMAT format);
+void amrHalInit();
+// 1 while the capture is being decoded
+uint8_t amrHalRunning();
+// Start decoding the capture, or stop early and wait for the threads. Unlike
+// the radio HALs amrInit doesn't start it, call amrEnable(1) once the
+// callbacks are registered.
+void amrHalEnable(uint8_t enable);
+// Wait until the whole capture is decoded and every message delivered
+void amrHalWait();
+// Chips of the current source fed to the decoder so far
+uint64_t amrHalChips();
+
+#endif
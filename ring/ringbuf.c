@@ -5,14 +5,156 @@
 #include <stdio.h>
 #endif
 
+// head and tail are published with release stores and read with acquire loads
+// by the other side, so frame data and wrap markers written before a store are
+// visible to whoever observes the new position. The GCC builtins follow the
+// C11 memory model and also build when this file is compiled as C++.
+#define RING_LOAD_ACQUIRE(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define RING_STORE_RELEASE(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#define RING_LOAD_RELAXED(ptr) __atomic_load_n((ptr), __ATOMIC_RELAXED)
+#define RING_STORE_RELAXED(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_RELAXED)
+
+#ifdef RING_POW2
+
+// Frames start on a RingPos_t boundary so the size prefix or wrap marker always
+// fits in front of the end of storage
+#define RING_ALIGN(n) (((n) + sizeof(RingPos_t) - 1) & ~(RingPos_t)(sizeof(RingPos_t) - 1))
+
 Ring ringInit(uint8_t * buffer, RingPos_t size) {
-    Ring ring = {NULL, 0, 0, 0};
+    Ring ring = {NULL, 0, 0, 0, 0, 0, 0};
+    // Positions are masked on access, so the capacity must be a power of two
+    if (buffer == NULL || size < 2*sizeof(RingPos_t) || (size & (size - 1)) != 0) {
+        return ring;
+    }
+    ring.data = buffer;
+    ring.size = size;
+    memset(buffer, 0, size);
+
+#ifdef RINGBUF_DEBUG
+    printf("%s: Performed ring init. size=%u\n", __FUNCTION__, ring.size);
+#endif
+
+    return ring;
+}
+
+RingPos_t ringFree(Ring * ring) {
+    if (ring == NULL || ring->data == NULL || ring->size <= sizeof(RingPos_t)) {
+        return 0;
+    }
+
+    // The consumer only ever frees space, so a stale tail is conservative
+    RingPos_t head = RING_LOAD_RELAXED(&ring->head);
+    RingPos_t tail = RING_LOAD_ACQUIRE(&ring->tail);
+
+    // head and tail run freely, so their difference is the used space no
+    // matter which of them last wrapped
+    RingPos_t free = ring->size - (head - tail);
+    RingPos_t toEnd = ring->size - (head & (ring->size - 1));
+
+    // Largest frame fitting either in front of the end of storage or, after
+    // skipping to the front, in front of the tail
+    RingPos_t back = free < toEnd ? free : toEnd;
+    RingPos_t front = free > toEnd ? free - toEnd : 0;
+    RingPos_t best = back > front ? back : front;
+
+    return best > sizeof(RingPos_t) ? best - sizeof(RingPos_t) : 0;
+}
+
+RING_STATUS ringReserve(Ring * ring, RingPos_t size, uint8_t ** data) {
+    if (ring == NULL || data == NULL || size <= 0 || ring->data == NULL) {
+        return RING_STATUS_FAIL;
+    }
+
+    RingPos_t head = ring->head;
+    RingPos_t tail = RING_LOAD_ACQUIRE(&ring->tail);
+    RingPos_t free = ring->size - (head - tail);
+    RingPos_t toEnd = ring->size - (head & (ring->size - 1));
+    RingPos_t need = sizeof(RingPos_t) + RING_ALIGN(size);
+    // Skip to the front when the frame doesn't fit before the end of storage
+    RingPos_t pad = need > toEnd ? toEnd : 0;
+
+    if (size > ring->size - sizeof(RingPos_t) || pad + need > free) {
+#ifdef RINGBUF_DEBUG
+    printf("%s: Reserve failed, ring full. free: %u size: %3u head=%3u tail=%3u\n",
+            __FUNCTION__, ringFree(ring), size, ring->head, ring->tail);
+#endif
+        RING_STORE_RELAXED(&ring->overflow, (uint8_t)(ring->overflow + 1));
+        return RING_STATUS_FAIL;
+    }
+
+    if (pad) {
+        // Indicate that wrapping occurred by seting next size val to 0
+        memset(ring->data + (head & (ring->size - 1)), 0, sizeof(RingPos_t));
+        head += pad;
+    }
+
+    uint8_t * frame = ring->data + (head & (ring->size - 1));
+    memcpy(frame, &size, sizeof(size));
+    *data = frame + sizeof(RingPos_t);
+
+    // Nothing is visible to the consumer until ringCommit
+    ring->reserved = pad + need;
+
+    return RING_STATUS_OK;
+}
+
+RING_STATUS ringCommit(Ring * ring) {
+    if (ring == NULL || ring->reserved == 0) {
+        return RING_STATUS_FAIL;
+    }
+
+    // Publish the frame (and any wrap marker) to the consumer
+    RING_STORE_RELEASE(&ring->head, ring->head + ring->reserved);
+    ring->reserved = 0;
+#ifdef RINGBUF_DEBUG
+    printf("%s: Commit succeeded. free: %u newhead=%3u tail=%3u\n",
+            __FUNCTION__, ringFree(ring), ring->head, ring->tail);
+#endif
+    return RING_STATUS_OK;
+}
+
+// Find the oldest frame, skipping the wrap marker. Returns its size and
+// position or 0 when the ring is empty.
+static RingPos_t ringFront(Ring * ring, RingPos_t * pos) {
+    RingPos_t tail = ring->tail;
+    if (RING_LOAD_ACQUIRE(&ring->head) == tail) {
+        return 0;
+    }
+
+    RingPos_t size = 0;
+    memcpy(&size, ring->data + (tail & (ring->size - 1)), sizeof(size));
+
+    // Wrap tail to front when data size is 0
+    if (size == 0) {
+        tail += ring->size - (tail & (ring->size - 1));
+        memcpy(&size, ring->data, sizeof(size));
+    }
+
+    *pos = tail;
+    return size;
+}
+
+static inline uint8_t * ringAt(Ring * ring, RingPos_t pos) {
+    return ring->data + (pos & (ring->size - 1));
+}
+
+// Position following the frame at pos
+static inline RingPos_t ringNext(RingPos_t pos, RingPos_t size) {
+    return pos + sizeof(RingPos_t) + RING_ALIGN(size);
+}
+
+#else
+
+Ring ringInit(uint8_t * buffer, RingPos_t size) {
+    Ring ring = {NULL, 0, 0, 0, 0, 0, 0};
     if (buffer == NULL || size <= sizeof(RingPos_t)) {
         return ring;
     }
     ring.data = buffer;
     ring.size = size;
     ring.overflow = 0;
+    ring.overflowRead = 0;
+    ring.reserved = 0;
     memset(buffer, 0, size);
 
 #ifdef RINGBUF_DEBUG
@@ -30,25 +172,28 @@ RingPos_t ringFree(Ring * ring) {
     RingPos_t free_hi = 0;
     RingPos_t free_lo = 0;
     RingPos_t sizeAvail = ring->size;
+    // The consumer only ever frees space, so a stale tail is conservative
+    RingPos_t head = RING_LOAD_RELAXED(&ring->head);
+    RingPos_t tail = RING_LOAD_ACQUIRE(&ring->tail);
 
     // Can't fill back of buffer completely when tail is at 0
-    if (ring->tail == 0) {
+    if (tail == 0) {
         sizeAvail -= 1;
     }
 
     // Head in front of tail
-    if (ring->head >= ring->tail) {
+    if (head >= tail) {
         // Don't count space needed for RingPos_t
-        if (ring->head + sizeof(RingPos_t) <= sizeAvail) {
-            free_hi = sizeAvail - sizeof(RingPos_t) - ring->head;
+        if (head + sizeof(RingPos_t) <= sizeAvail) {
+            free_hi = sizeAvail - sizeof(RingPos_t) - head;
         }
         else {
             free_hi = 0;
         }
 
         // Don't count space needed for RingPos_t
-        if (ring->tail >= sizeof(RingPos_t) + 1) {
-            free_lo = ring->tail - sizeof(RingPos_t) - 1;
+        if (tail >= sizeof(RingPos_t) + 1) {
+            free_lo = tail - sizeof(RingPos_t) - 1;
         }
         else {
             free_lo = 0;
@@ -56,9 +201,10 @@ RingPos_t ringFree(Ring * ring) {
     }
     // Head behind tail
     else {
-        // Don't count space needed for RingPos_t
-        if (ring->tail >= ring->head + sizeof(RingPos_t)) {
-            free_hi = ring->tail - ring->head - sizeof(RingPos_t) - 1;
+        // Don't count space needed for RingPos_t or the byte that keeps
+        // head from catching up with tail
+        if (tail > head + sizeof(RingPos_t)) {
+            free_hi = tail - head - sizeof(RingPos_t) - 1;
         }
         else {
             free_hi = 0;
@@ -74,53 +220,122 @@ RingPos_t ringFree(Ring * ring) {
     return free;
 }
 
-RING_STATUS ringStatus(Ring * ring) {
-    if (ring == NULL || ring->data == NULL || ring->size <= sizeof(RingPos_t)) {
+RING_STATUS ringReserve(Ring * ring, RingPos_t size, uint8_t ** data) {
+    if (ring == NULL || data == NULL || size <= 0 || ring->data == NULL) {
         return RING_STATUS_FAIL;
     }
 
-    if (ring->head == ring->tail) {
-        return RING_STATUS_EMPTY;
+    if (size > ringFree(ring)) {
+#ifdef RINGBUF_DEBUG
+    printf("%s: Reserve failed, ring full. free: %u size: %3u head=%3u tail=%3u\n",
+            __FUNCTION__, ringFree(ring), size, ring->head, ring->tail);
+#endif
+        RING_STORE_RELAXED(&ring->overflow, (uint8_t)(ring->overflow + 1));
+        return RING_STATUS_FAIL;
+    }
+
+    RingPos_t head = ring->head;
+    RingPos_t newHead = (head + sizeof(RingPos_t) + size);
+
+    // Queue from front of ring when overflow would occur. A frame ending
+    // exactly at the back may only wrap if it also fits in front of the tail.
+    RingPos_t tail = RING_LOAD_ACQUIRE(&ring->tail);
+    if (newHead > ring->size || (newHead == ring->size &&
+                head >= tail && tail > sizeof(RingPos_t) + size)) {
+        // Indicate that wrapping occurred by seting next size val to 0
+        if (head + sizeof(RingPos_t) <= ring->size) {
+            memset(ring->data + head, 0, sizeof(RingPos_t));
+        }
+        head = 0;
+        newHead = (head + sizeof(RingPos_t) + size);
     }
 
+    memcpy(ring->data + head, &size, sizeof(size));
+    *data = ring->data + head + sizeof(RingPos_t);
+
+    // Nothing is visible to the consumer until ringCommit
+    ring->reserved = newHead;
+
     return RING_STATUS_OK;
 }
 
-RING_STATUS ringPush(Ring * ring, uint8_t * data, RingPos_t size) {
-    if (ring == NULL || data == NULL || size <= 0 || ring->data == NULL) {
+RING_STATUS ringCommit(Ring * ring) {
+    if (ring == NULL || ring->reserved == 0) {
         return RING_STATUS_FAIL;
     }
 
-    if (size > ringFree(ring)) {
+    // Publish the frame (and any wrap marker) to the consumer
+    RING_STORE_RELEASE(&ring->head, ring->reserved);
+    ring->reserved = 0;
 #ifdef RINGBUF_DEBUG
-    printf("%s: Push failed, ring full. free: %u size: %3u head=%3u tail=%3u\n",
-            __FUNCTION__, ringFree(ring), size, ring->head, ring->tail);
+    printf("%s: Commit succeeded. free: %u newhead=%3u tail=%3u\n",
+            __FUNCTION__, ringFree(ring), ring->head, ring->tail);
 #endif
-        ++(ring->overflow);
-        return RING_STATUS_FAIL;
+    return RING_STATUS_OK;
+}
+
+// Find the oldest frame, skipping the wrap marker or the unused bytes at the
+// back of the ring. Returns its size and position or 0 when the ring is empty.
+static RingPos_t ringFront(Ring * ring, RingPos_t * pos) {
+    RingPos_t tail = ring->tail;
+    if (RING_LOAD_ACQUIRE(&ring->head) == tail) {
+        return 0;
     }
 
-    RingPos_t newHead = (ring->head + sizeof(RingPos_t) + size);
+    if (tail + sizeof(RingPos_t) >= ring->size) {
+        tail = 0;
+    }
 
-    // Queue from front of ring when overflow would occur
-    if (newHead >= ring->size) {
-        // Indicate that wrapping occurred by seting next size val to 0
-        if (ring->head + sizeof(RingPos_t) <= ring->size) {
-            memset(ring->data + ring->head, 0, sizeof(RingPos_t));
-        }
-        ring->head = 0;
-        newHead = (ring->head + sizeof(RingPos_t) + size);
+    RingPos_t size = 0;
+    memcpy(&size, ring->data + tail, sizeof(size));
+
+    // Wrap tail to front when data size is 0
+    if (size == 0) {
+        tail = 0;
+        memcpy(&size, ring->data, sizeof(size));
     }
 
-    memcpy(ring->data + ring->head, &size, sizeof(size));
-    memcpy(ring->data + ring->head + sizeof(RingPos_t), data, size);
+    *pos = tail;
+    return size;
+}
+
+static inline uint8_t * ringAt(Ring * ring, RingPos_t pos) {
+    return ring->data + pos;
+}
+
+// Position following the frame at pos
+static inline RingPos_t ringNext(RingPos_t pos, RingPos_t size) {
+    return pos + sizeof(RingPos_t) + size;
+}
 
-    ring->head = newHead;
-#ifdef RINGBUF_DEBUG
-    printf("%s: Push succeeded. free: %u pushsize: %3u newhead=%3u tail=%3u\n",
-            __FUNCTION__, ringFree(ring), size, ring->head, ring->tail);
 #endif
-   return RING_STATUS_OK;
+
+RING_STATUS ringStatus(Ring * ring) {
+    if (ring == NULL || ring->data == NULL || ring->size <= sizeof(RingPos_t)) {
+        return RING_STATUS_FAIL;
+    }
+
+    if (RING_LOAD_ACQUIRE(&ring->head) == RING_LOAD_ACQUIRE(&ring->tail)) {
+        return RING_STATUS_EMPTY;
+    }
+
+    return RING_STATUS_OK;
+}
+
+RING_STATUS ringPush(Ring * ring, uint8_t * data, RingPos_t size) {
+    if (data == NULL) {
+        return RING_STATUS_FAIL;
+    }
+
+    uint8_t * dst = NULL;
+    RING_STATUS status = ringReserve(ring, size, &dst);
+    if (status != RING_STATUS_OK) {
+        return status;
+    }
+
+    memcpy(dst, data, size);
+
+    return ringCommit(ring);
 }
 
 RingPos_t ringPeek(Ring * ring, uint8_t ** data) {
@@ -129,20 +344,35 @@ RingPos_t ringPeek(Ring * ring, uint8_t ** data) {
         return 0;
     }
 
-    if (ringStatus(ring) == RING_STATUS_EMPTY) {
+    RingPos_t tail = 0;
+    RingPos_t size = ringFront(ring, &tail);
+    if (size == 0) {
         return 0;
     }
 
-    RingPos_t size = 0;
-    memcpy(&size, ring->data + ring->tail, sizeof(size));
-    if (size == 0) {
-        size = (RingPos_t)*(ring->data);
-        ring->tail = 0;
+    *data = ringAt(ring, tail) + sizeof(RingPos_t);
+
+    return size;
+}
+
+RING_STATUS ringRelease(Ring * ring) {
+    if (ring == NULL || ring->data == NULL || ring->size <= sizeof(RingPos_t)) {
+        return RING_STATUS_FAIL;
     }
 
-    *data = ring->data + ring->tail + sizeof(RingPos_t);
+    RingPos_t tail = 0;
+    RingPos_t size = ringFront(ring, &tail);
+    if (size == 0) {
+        return RING_STATUS_EMPTY;
+    }
 
-    return size;
+    // Hand the space back to the producer only once the frame is consumed
+    RING_STORE_RELEASE(&ring->tail, ringNext(tail, size));
+#ifdef RINGBUF_DEBUG
+    printf("%s: Release succeeded. free: %u size: %3u head=%3u newTail=%3u\n",
+            __FUNCTION__, ringFree(ring), size, ring->head, ring->tail);
+#endif
+    return RING_STATUS_OK;
 }
 
 RingPos_t ringPop(Ring * ring, uint8_t * outbuf, RingPos_t maxsize) {
@@ -150,8 +380,10 @@ RingPos_t ringPop(Ring * ring, uint8_t * outbuf, RingPos_t maxsize) {
         return 0;
     }
 
+    RingPos_t tail = 0;
+    RingPos_t size = ringFront(ring, &tail);
     // Empty ring
-    if (ring->head == ring->tail) {
+    if (size == 0) {
 #ifdef RINGBUF_DEBUG
     printf("%s: Pop failed. Ring empty. free: %u head=%3u tail=%3u\n",
             __FUNCTION__, ringFree(ring), ring->head, ring->tail);
@@ -159,27 +391,16 @@ RingPos_t ringPop(Ring * ring, uint8_t * outbuf, RingPos_t maxsize) {
         return 0;
     }
 
-    if (ring->tail + sizeof(RingPos_t) >= ring->size) {
-        ring->tail = 0;
-    }
-
-    RingPos_t size = 0;
-    memcpy(&size, ring->data + ring->tail, sizeof(size));
-
-    // Wrap tail to front when data size is 0
-    if (size == 0) {
-        size = (RingPos_t)*(ring->data);
-        ring->tail = 0;
-    }
     RingPos_t copySize = maxsize < size ? maxsize : size;
     if (!outbuf) {
         copySize = 0;
     }
 
     if (outbuf && copySize > 0) {
-        memcpy(outbuf, ring->data + ring->tail + sizeof(RingPos_t), copySize);
+        memcpy(outbuf, ringAt(ring, tail) + sizeof(RingPos_t), copySize);
     }
-    ring->tail = ring->tail + sizeof(RingPos_t) + size;
+    // Hand the space back to the producer only after the copy
+    RING_STORE_RELEASE(&ring->tail, ringNext(tail, size));
 #ifdef RINGBUF_DEBUG
     printf("%s: Pop succeeded. free: %u popsize: %3u head=%3u newTail=%3u\n",
             __FUNCTION__, ringFree(ring), size, ring->head, ring->tail);
@@ -192,8 +413,10 @@ uint8_t ringOverflowed(Ring * ring) {
         return 0;
     }
 
-    uint8_t cnt = ring->overflow;
-    ring->overflow = 0;
+    // The producer owns overflow, so report the change since the last call
+    uint8_t overflow = RING_LOAD_RELAXED(&ring->overflow);
+    uint8_t cnt = overflow - ring->overflowRead;
+    ring->overflowRead = overflow;
 
     return cnt;
 }
@@ -10,21 +10,44 @@ typedef enum RING_STATUS {
     RING_STATUS_FAIL
 } RING_STATUS;
 
+// Define RING_POW2 for 32-bit positions and capacities beyond 64 KiB. The
+// capacity must then be a power of two, head and tail run freely and are
+// masked on access, and frames are padded to a multiple of sizeof(RingPos_t).
+#ifdef RING_POW2
+typedef uint32_t RingPos_t;
+#else
 typedef uint16_t RingPos_t;
+#endif
 
+// Safe for one producer (ringPush) and one consumer (ringPeek, ringPop,
+// ringOverflowed) running concurrently, e.g. an ISR and the main loop or two
+// threads on different CPUs. head, reserved and overflow are only written by
+// the producer, tail and overflowRead only by the consumer.
 typedef struct Ring {
     uint8_t * data;
     RingPos_t size;
     RingPos_t head;
     RingPos_t tail;
+    RingPos_t reserved; // Pending ringReserve, 0 when none
     uint8_t overflow;
+    uint8_t overflowRead;
 } Ring;
 
 Ring ringInit(uint8_t * buffer, RingPos_t size);
-RingPos_t ringAvail(Ring * ring);
+// Largest frame ringPush or ringReserve can take right now
+RingPos_t ringFree(Ring * ring);
 RING_STATUS ringStatus(Ring * ring);
 RING_STATUS ringPush(Ring * ring, uint8_t * data, RingPos_t size);
 RingPos_t ringPeek(Ring * ring, uint8_t ** data);
+
+// Zero-copy producer side. ringReserve points data at size contiguous bytes of
+// ring storage which the consumer can't see until ringCommit. Reserving again
+// before committing discards the previous reservation.
+RING_STATUS ringReserve(Ring * ring, RingPos_t size, uint8_t ** data);
+RING_STATUS ringCommit(Ring * ring);
+// Zero-copy consumer side. Drops the frame returned by ringPeek, which stays
+// valid until then.
+RING_STATUS ringRelease(Ring * ring);
 RingPos_t ringPop(Ring * ring, uint8_t * outbuf, RingPos_t maxsize);
 uint8_t ringOverflowed(Ring * ring);
 
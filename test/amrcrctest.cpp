@@ -0,0 +1,122 @@
+#include "../amr_crc.c"
+#include "../amr_crc.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+
+// Bit at a time reference, independent of the generated tables
+static uint16_t refCrc(uint16_t poly, uint16_t crc, const uint8_t * data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)(data[i] << 8);
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ poly) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+class AmrCrcTest : public ::testing::TestWithParam<AMR_CRC_IMPL> {
+protected:
+    void SetUp() override {
+        if (!amrCrcImplSupported(GetParam())) {
+            GTEST_SKIP() << amrCrcImplName(GetParam()) << " not supported";
+        }
+        ASSERT_TRUE(amrCrcSelectImpl(GetParam()));
+    }
+};
+
+TEST_P(AmrCrcTest, MatchesReference) {
+    const uint16_t polys[AMR_CRC_CNT] = {0x6f63, 0x1021};
+    uint32_t x = 0xc0ffee;
+    for (size_t len = 0; len < 300; len++) {
+        std::vector<uint8_t> data(len);
+        for (uint8_t & d : data) {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            d = (uint8_t)x;
+        }
+        for (int p = 0; p < AMR_CRC_CNT; p++) {
+            uint16_t init = (uint16_t)(x >> 8);
+            ASSERT_EQ(refCrc(polys[p], init, data.data(), len),
+                    amrCrc16((AMR_CRC)p, init, data.data(), len))
+                    << "poly " << p << " len " << len;
+        }
+    }
+}
+
+TEST_P(AmrCrcTest, CheckValue) {
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    // CRC-16/CCITT-FALSE
+    EXPECT_EQ(0x29b1, amrCrc16(AMR_CRC_CCITT, 0xffff, check, sizeof(check)));
+}
+
+TEST_P(AmrCrcTest, Residual) {
+    // A frame followed by its own CRC leaves the residual in the register
+    std::vector<uint8_t> frame(88);
+    for (size_t i = 0; i < frame.size() - 2; i++) {
+        frame[i] = (uint8_t)(i * 37);
+    }
+    uint16_t crc = amrCrc16(AMR_CRC_CCITT, 0xffff, frame.data(), frame.size() - 2) ^ 0xffff;
+    frame[86] = (uint8_t)(crc >> 8);
+    frame[87] = (uint8_t)crc;
+    EXPECT_EQ(0x1d0f, amrCrc16(AMR_CRC_CCITT, 0xffff, frame.data(), frame.size()));
+
+    crc = amrCrc16(AMR_CRC_BCH, 0, frame.data(), 8);
+    frame[8] = (uint8_t)(crc >> 8);
+    frame[9] = (uint8_t)crc;
+    EXPECT_EQ(0x0000, amrCrc16(AMR_CRC_BCH, 0, frame.data(), 10));
+}
+
+INSTANTIATE_TEST_SUITE_P(Impls, AmrCrcTest, ::testing::Values(
+        AMR_CRC_IMPL_TABLE, AMR_CRC_IMPL_SLICE4, AMR_CRC_IMPL_SLICE8,
+        AMR_CRC_IMPL_CLMUL));
+
+TEST(AmrCrcSelect, Unsupported) {
+    EXPECT_FALSE(amrCrcSelectImpl(AMR_CRC_IMPL_CNT));
+    EXPECT_STREQ("unknown", amrCrcImplName(AMR_CRC_IMPL_CNT));
+    EXPECT_EQ(NULL, amrCrcTable(AMR_CRC_CNT));
+}
+
+// Tables and check values are available at compile time
+static constexpr uint8_t crcCheck[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+static_assert(AmrCrcScmPlus::compute(crcCheck, sizeof(crcCheck)) == 0x29b1, "CRC-16/CCITT-FALSE");
+static_assert(AmrCrcScm::tables.t[0][1] == 0x6f63, "BCH table");
+
+TEST(AmrCrcTemplate, MatchesGeneratedTables) {
+    for (unsigned k = 0; k < 8; k++) {
+        for (unsigned b = 0; b < 256; b++) {
+            ASSERT_EQ(AmrCrcScm::tables.t[k][b], amrCrcTables[AMR_CRC_BCH][k][b]);
+            ASSERT_EQ(AmrCrcScmPlus::tables.t[k][b], amrCrcTables[AMR_CRC_CCITT][k][b]);
+        }
+    }
+}
+
+TEST(AmrCrcTemplate, MatchesKernels) {
+    uint8_t data[92];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 37 + 11);
+    }
+    for (size_t len = 0; len <= sizeof(data); len++) {
+        ASSERT_EQ(amrCrc16(AMR_CRC_BCH, 0, data, len), AmrCrcScm::compute(data, len));
+        ASSERT_EQ(amrCrc16(AMR_CRC_CCITT, 0xffff, data, len), AmrCrcIdm::compute(data, len));
+    }
+}
+
+TEST(AmrCrcTemplate, Variants) {
+    // An IDM frame body with its inverted CRC appended checks for every
+    // variant sharing the IDM CRC
+    uint8_t frame[88] = {0x18};
+    uint16_t crc = (uint16_t)~AmrCrcIdm18::compute(frame, 86);
+    frame[86] = (uint8_t)(crc >> 8);
+    frame[87] = (uint8_t)crc;
+    EXPECT_TRUE(AmrCrcIdm18::check(frame, sizeof(frame)));
+    EXPECT_TRUE(AmrCrcNetIdm::check(frame, sizeof(frame)));
+    frame[10] ^= 0x40;
+    EXPECT_FALSE(AmrCrcIdm18::check(frame, sizeof(frame)));
+
+    // Other widths come from the same template
+    typedef AmrCrcSpec<uint32_t, 32, 0x04c11db7, 0xffffffff, 0xc704dd7b> Crc32Mpeg2;
+    EXPECT_EQ(0x0376e6e7u, Crc32Mpeg2::compute(crcCheck, sizeof(crcCheck)));
+    typedef AmrCrcSpec<uint8_t, 8, 0x07, 0x00, 0x00> Crc8;
+    EXPECT_EQ(0xf4, Crc8::compute(crcCheck, sizeof(crcCheck)));
+}
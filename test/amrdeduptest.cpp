@@ -0,0 +1,88 @@
+#include "../amr_dedup.c"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+class AmrDedupTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(amrDedupInit(&dedup, entries, 64, 100));
+        for (size_t i = 0; i < sizeof(frame); i++) {
+            frame[i] = (uint8_t)(i * 7);
+        }
+    }
+
+    AmrDedupEntry entries[64];
+    AmrDedup dedup;
+    uint8_t frame[12];
+};
+
+TEST_F(AmrDedupTest, InvalidArgs) {
+    EXPECT_FALSE(amrDedupInit(NULL, entries, 64, 100));
+    EXPECT_FALSE(amrDedupInit(&dedup, NULL, 64, 100));
+    EXPECT_FALSE(amrDedupInit(&dedup, entries, 2, 100));
+    EXPECT_FALSE(amrDedupInit(&dedup, entries, 48, 100));
+    EXPECT_FALSE(amrDedupCheck(NULL, 0, 1, frame, sizeof(frame), 0));
+}
+
+TEST_F(AmrDedupTest, Window) {
+    EXPECT_FALSE(amrDedupCheck(&dedup, 0, 1, frame, sizeof(frame), 1000));
+    EXPECT_TRUE(amrDedupCheck(&dedup, 0, 1, frame, sizeof(frame), 1050));
+    // Each copy refreshes the entry
+    EXPECT_TRUE(amrDedupCheck(&dedup, 0, 1, frame, sizeof(frame), 1150));
+    EXPECT_FALSE(amrDedupCheck(&dedup, 0, 1, frame, sizeof(frame), 1251));
+    EXPECT_EQ(2u, dedup.hits);
+    EXPECT_EQ(2u, dedup.misses);
+
+    // Window distances survive the timestamp wrapping
+    EXPECT_FALSE(amrDedupCheck(&dedup, 0, 2, frame, sizeof(frame), 0xffffffd0u));
+    EXPECT_TRUE(amrDedupCheck(&dedup, 0, 2, frame, sizeof(frame), 0x10));
+
+    amrDedupClear(&dedup);
+    EXPECT_EQ(0u, dedup.hits);
+    EXPECT_FALSE(amrDedupCheck(&dedup, 0, 1, frame, sizeof(frame), 1252));
+}
+
+TEST_F(AmrDedupTest, Key) {
+    EXPECT_FALSE(amrDedupCheck(&dedup, 0, 1, frame, sizeof(frame), 0));
+    // Another type, meter or payload is a new frame
+    EXPECT_FALSE(amrDedupCheck(&dedup, 1, 1, frame, sizeof(frame), 1));
+    EXPECT_FALSE(amrDedupCheck(&dedup, 0, 2, frame, sizeof(frame), 2));
+    frame[5] ^= 1;
+    EXPECT_FALSE(amrDedupCheck(&dedup, 0, 1, frame, sizeof(frame), 3));
+    frame[5] ^= 1;
+    EXPECT_TRUE(amrDedupCheck(&dedup, 0, 1, frame, sizeof(frame), 4));
+}
+
+TEST_F(AmrDedupTest, EvictsOldest) {
+    // Readings of one meter share a set, the fifth evicts the oldest
+    for (uint32_t i = 0; i < AMR_DEDUP_WAYS + 1; i++) {
+        frame[0] = (uint8_t)i;
+        EXPECT_FALSE(amrDedupCheck(&dedup, 0, 9, frame, sizeof(frame), i));
+    }
+    for (uint32_t i = AMR_DEDUP_WAYS; i > 0; i--) {
+        frame[0] = (uint8_t)i;
+        EXPECT_TRUE(amrDedupCheck(&dedup, 0, 9, frame, sizeof(frame), 10));
+    }
+    frame[0] = 0;
+    EXPECT_FALSE(amrDedupCheck(&dedup, 0, 9, frame, sizeof(frame), 10));
+}
+
+TEST_F(AmrDedupTest, LargeTableUsesEverySet) {
+    // 2^26 sets, the index alone is checked so no storage is needed
+    AmrDedup big = dedup;
+    big.setMask = (1u << 26) - 1;
+    big.setBits = 26;
+    uint32_t maxSet = 0;
+    for (uint32_t id = 0; id < 4096; id++) {
+        uint32_t set = amrDedupSetIdx(&big, 0, id);
+        ASSERT_LE(set, big.setMask);
+        maxSet = std::max(maxSet, set);
+    }
+    EXPECT_GE(maxSet, 1u << 25);
+
+    EXPECT_EQ(4u, dedup.setBits);
+    big.setMask = 0;
+    big.setBits = 0;
+    EXPECT_EQ(0u, amrDedupSetIdx(&big, 1, 12345));
+}
@@ -0,0 +1,211 @@
+#include "../ring/ringbuf.c"
+#include "../amr.c"
+#include "../amr_crc.c"
+#include "../amr_manch.c"
+#include "../amr_dedup.c"
+#include "../amr_engine.c"
+#include "amrframes.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+typedef std::tuple<uint64_t, uint16_t, AMR_MSG_TYPE, std::vector<uint8_t> > EngineTestMsg;
+
+static void refMsgCallback(AmrDecoder * dec, const AmrMsgHeader * hdr,
+        const void * msg, const uint8_t * data) {
+    static const size_t sizes[] = {
+        AMR_MSG_SCM_RAW_SIZE, AMR_MSG_SCM_PLUS_RAW_SIZE, AMR_MSG_IDM_RAW_SIZE};
+    std::pair<uint16_t, std::vector<EngineTestMsg> *> * ctx =
+        (std::pair<uint16_t, std::vector<EngineTestMsg> *> *)dec->user;
+    ctx->second->push_back(EngineTestMsg(hdr->timestamp, ctx->first, hdr->type,
+                std::vector<uint8_t>(data, data + sizes[hdr->type])));
+}
+
+static void runEngine(uint16_t channels, uint16_t workers) {
+    std::vector<std::vector<uint8_t> > chips(channels);
+    std::vector<std::vector<uint8_t> > packed(channels);
+    std::vector<EngineTestMsg> expected;
+    std::vector<uint32_t> expectedPass(channels);
+
+    for (uint16_t c = 0; c < channels; c++) {
+        chips[c] = buildMixedChips(0x1000 + c, 40);
+        packed[c] = packChips(chips[c]);
+
+        AmrDecoder dec;
+        std::vector<EngineTestMsg> msgs;
+        std::pair<uint16_t, std::vector<EngineTestMsg> *> ctx(c, &msgs);
+        amrDecoderInit(&dec);
+        amrDecoderRegisterMsgCallback(&dec, refMsgCallback, &ctx);
+        for (uint8_t chip : chips[c]) {
+            uint8_t bit = chip << 7;
+            amrDecoderProcessBits(&dec, &bit, 1);
+            amrDecoderProcessMsgs(&dec);
+        }
+        expectedPass[c] = dec.stats.crcPass;
+        expected.insert(expected.end(), msgs.begin(), msgs.end());
+    }
+    std::stable_sort(expected.begin(), expected.end(),
+            [](const EngineTestMsg & a, const EngineTestMsg & b) {
+                return std::make_pair(std::get<0>(a), std::get<1>(a)) <
+                    std::make_pair(std::get<0>(b), std::get<1>(b));
+            });
+
+    AmrEngineConfig cfg = {channels, workers, 0};
+    AmrEngine * eng = amrEngineCreate(&cfg);
+    ASSERT_TRUE(eng != NULL);
+
+    // Feed all channels in lockstep while draining the merged output
+    std::vector<size_t> pos(channels, 0);
+    std::vector<EngineTestMsg> merged;
+    AmrEngineMsg msg;
+    while (!amrEngineDone(eng)) {
+        for (uint16_t c = 0; c < channels; c++) {
+            if (pos[c] < chips[c].size()) {
+                size_t n = std::min<size_t>(3000 * 8, chips[c].size() - pos[c]);
+                pos[c] += amrEnginePush(eng, c, packed[c].data() + pos[c] / 8, n);
+                if (pos[c] == chips[c].size()) {
+                    amrEngineClose(eng, c);
+                }
+            }
+        }
+        while (amrEnginePoll(eng, &msg)) {
+            static const size_t sizes[] = {
+                AMR_MSG_SCM_RAW_SIZE, AMR_MSG_SCM_PLUS_RAW_SIZE, AMR_MSG_IDM_RAW_SIZE};
+            merged.push_back(EngineTestMsg(msg.timestamp, msg.channel, msg.type,
+                        std::vector<uint8_t>(msg.data, msg.data + sizes[msg.type])));
+        }
+    }
+
+    EXPECT_EQ(40u * channels, merged.size());
+    EXPECT_TRUE(expected == merged);
+
+    for (uint16_t c = 0; c < channels; c++) {
+        AmrEngineChannelStats stats;
+        amrEngineChannelStats(eng, c, &stats);
+        EXPECT_EQ(chips[c].size(), stats.chipsIn);
+        EXPECT_EQ(expectedPass[c], stats.crcPass);
+        EXPECT_LE(stats.crcPass, stats.preambles);
+        EXPECT_EQ(0u, stats.dropped);
+    }
+
+    amrEngineDestroy(eng);
+}
+
+TEST(AmrEngineTest, SingleWorker) {
+    runEngine(4, 1);
+}
+
+TEST(AmrEngineTest, WorkerPerChannel) {
+    runEngine(6, 0);
+}
+
+TEST(AmrEngineTest, SharedWorkers) {
+    runEngine(7, 3);
+}
+
+// Producer and poller on separate threads, with small pushes so that the
+// poller keeps reading slots right behind the workers
+TEST(AmrEngineTest, ConcurrentPoller) {
+    const uint16_t channels = 8;
+    std::vector<std::vector<uint8_t> > packed(channels);
+    std::vector<size_t> sizes(channels);
+    for (uint16_t c = 0; c < channels; c++) {
+        std::vector<uint8_t> chips = buildMixedChips(0x2000 + c, 200);
+        sizes[c] = chips.size();
+        packed[c] = packChips(chips);
+    }
+
+    for (int round = 0; round < 4; round++) {
+        AmrEngineConfig cfg = {channels, 3, 0};
+        AmrEngine * eng = amrEngineCreate(&cfg);
+        ASSERT_TRUE(eng != NULL);
+
+        std::thread producer([&]() {
+            std::vector<size_t> pos(channels, 0);
+            uint16_t open = channels;
+            while (open > 0) {
+                for (uint16_t c = 0; c < channels; c++) {
+                    if (pos[c] == sizes[c]) {
+                        continue;
+                    }
+                    size_t n = std::min<size_t>(512, sizes[c] - pos[c]);
+                    pos[c] += amrEnginePush(eng, c, packed[c].data() + pos[c] / 8, n);
+                    if (pos[c] == sizes[c]) {
+                        amrEngineClose(eng, c);
+                        --open;
+                    }
+                }
+            }
+        });
+
+        size_t cnt = 0;
+        uint64_t last = 0;
+        AmrEngineMsg msg;
+        while (!amrEngineDone(eng)) {
+            while (amrEnginePoll(eng, &msg)) {
+                EXPECT_LE(last, msg.timestamp);
+                EXPECT_TRUE(amrCheckCrc(msg.type, msg.data));
+                last = msg.timestamp;
+                ++cnt;
+            }
+        }
+        producer.join();
+        EXPECT_EQ(200u * channels, cnt);
+        amrEngineDestroy(eng);
+    }
+}
+
+// The workers make the first decode calls of the process, so they select
+// the Manchester and CRC kernels concurrently
+TEST(AmrEngineTest, WorkersSelectKernels) {
+    const uint16_t channels = 4;
+    manchImpl = AMR_MANCH_IMPL_CNT;
+    crcImpl = AMR_CRC_IMPL_CNT;
+    AmrEngineConfig cfg = {channels, 4, 0};
+    AmrEngine * eng = amrEngineCreate(&cfg);
+    ASSERT_TRUE(eng != NULL);
+
+    std::vector<std::vector<uint8_t> > packed(channels);
+    std::vector<size_t> pos(channels, 0);
+    for (uint16_t c = 0; c < channels; c++) {
+        packed[c] = packChips(buildMixedChips(0x3000 + c, 20));
+    }
+    size_t cnt = 0;
+    AmrEngineMsg msg;
+    while (!amrEngineDone(eng)) {
+        for (uint16_t c = 0; c < channels; c++) {
+            if (pos[c] < packed[c].size() * 8) {
+                pos[c] += amrEnginePush(eng, c, packed[c].data() + pos[c] / 8,
+                        packed[c].size() * 8 - pos[c]);
+                if (pos[c] == packed[c].size() * 8) {
+                    amrEngineClose(eng, c);
+                }
+            }
+        }
+        while (amrEnginePoll(eng, &msg)) {
+            ++cnt;
+        }
+    }
+    EXPECT_EQ(20u * channels, cnt);
+    EXPECT_NE(AMR_MANCH_IMPL_CNT, amrManchImpl());
+    EXPECT_NE(AMR_CRC_IMPL_CNT, amrCrcImpl());
+    amrEngineDestroy(eng);
+}
+
+TEST(AmrEngineTest, InvalidConfig) {
+    AmrEngineConfig cfg = {0, 0, 0};
+    EXPECT_TRUE(amrEngineCreate(&cfg) == NULL);
+    cfg.channels = AMR_ENGINE_MAX_CHANNELS + 1;
+    EXPECT_TRUE(amrEngineCreate(&cfg) == NULL);
+    EXPECT_TRUE(amrEngineCreate(NULL) == NULL);
+
+    cfg.channels = 1;
+    AmrEngine * eng = amrEngineCreate(&cfg);
+    ASSERT_TRUE(eng != NULL);
+    uint8_t chips[4] = {};
+    EXPECT_EQ(0u, amrEnginePush(eng, 1, chips, 32));
+    EXPECT_EQ(32u, amrEnginePush(eng, 0, chips, 32));
+    amrEngineDestroy(eng);
+}
@@ -0,0 +1,85 @@
+#include "../amr_filter.c"
+#include <gtest/gtest.h>
+#include <set>
+#include <vector>
+
+TEST(AmrIdFilterTest, InvalidArgs) {
+    AmrIdFilter filter;
+    uint32_t slots[16];
+    EXPECT_FALSE(amrIdFilterInit(NULL, slots, 16, AMR_FILTER_ALLOW));
+    EXPECT_FALSE(amrIdFilterInit(&filter, NULL, 16, AMR_FILTER_ALLOW));
+    EXPECT_FALSE(amrIdFilterInit(&filter, slots, 1, AMR_FILTER_ALLOW));
+    // Too small to hold any ID at 3/4 load
+    EXPECT_FALSE(amrIdFilterInit(&filter, slots, 2, AMR_FILTER_ALLOW));
+    EXPECT_FALSE(amrIdFilterInit(&filter, slots, 12, AMR_FILTER_ALLOW));
+    EXPECT_TRUE(amrIdFilterInit(&filter, slots, 16, AMR_FILTER_ALLOW));
+    EXPECT_FALSE(amrIdFilterAdd(NULL, 1));
+}
+
+TEST(AmrIdFilterTest, Capacity) {
+    AmrIdFilter filter;
+    uint32_t slots[16];
+    ASSERT_TRUE(amrIdFilterInit(&filter, slots, 16, AMR_FILTER_ALLOW));
+    for (uint32_t id = 0; id < 12; id++) {
+        EXPECT_TRUE(amrIdFilterAdd(&filter, id * 16));
+    }
+    EXPECT_FALSE(amrIdFilterAdd(&filter, 999));
+    // Adding an ID already present doesn't need room
+    EXPECT_TRUE(amrIdFilterAdd(&filter, 32));
+    EXPECT_EQ(12u, filter.count);
+
+    amrIdFilterClear(&filter);
+    EXPECT_EQ(0u, filter.count);
+    EXPECT_FALSE(amrIdFilterContains(&filter, 0));
+    EXPECT_FALSE(amrIdFilterContains(&filter, 32));
+
+    // The smallest table holds 3 IDs
+    ASSERT_TRUE(amrIdFilterInit(&filter, slots, 4, AMR_FILTER_ALLOW));
+    EXPECT_TRUE(amrIdFilterAdd(&filter, 1));
+    EXPECT_TRUE(amrIdFilterAdd(&filter, 2));
+    EXPECT_TRUE(amrIdFilterAdd(&filter, 3));
+    EXPECT_FALSE(amrIdFilterAdd(&filter, 4));
+    EXPECT_TRUE(amrIdFilterContains(&filter, 3));
+}
+
+TEST(AmrIdFilterTest, MatchesSet) {
+    AmrIdFilter filter;
+    std::vector<uint32_t> slots(1024);
+    ASSERT_TRUE(amrIdFilterInit(&filter, slots.data(), slots.size(), AMR_FILTER_ALLOW));
+    std::set<uint32_t> ref;
+    uint32_t x = 0x1234567;
+    for (int i = 0; i < 700; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        // Clustered IDs, as sequential meter serials are
+        uint32_t id = (i & 1) ? x : 30000000 + i;
+        ASSERT_TRUE(amrIdFilterAdd(&filter, id));
+        ref.insert(id);
+    }
+    ASSERT_TRUE(amrIdFilterAdd(&filter, 0));
+    ref.insert(0);
+    EXPECT_EQ(ref.size(), filter.count);
+
+    for (uint32_t id = 29999000; id < 30001000; id++) {
+        EXPECT_EQ(ref.count(id) != 0, amrIdFilterContains(&filter, id)) << id;
+    }
+    for (uint32_t id : ref) {
+        EXPECT_TRUE(amrIdFilterContains(&filter, id)) << id;
+    }
+}
+
+TEST(AmrIdFilterTest, Modes) {
+    AmrIdFilter filter;
+    uint32_t slots[8];
+    ASSERT_TRUE(amrIdFilterInit(&filter, slots, 8, AMR_FILTER_ALLOW));
+    amrIdFilterAdd(&filter, 42);
+    EXPECT_TRUE(amrIdFilterPass(&filter, 42));
+    EXPECT_FALSE(amrIdFilterPass(&filter, 43));
+    filter.mode = AMR_FILTER_DENY;
+    EXPECT_FALSE(amrIdFilterPass(&filter, 42));
+    EXPECT_TRUE(amrIdFilterPass(&filter, 43));
+    filter.mode = AMR_FILTER_OFF;
+    EXPECT_TRUE(amrIdFilterPass(&filter, 42));
+    EXPECT_TRUE(amrIdFilterPass(NULL, 42));
+}
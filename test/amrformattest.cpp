@@ -0,0 +1,188 @@
+#include "../amr_format.c"
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string>
+
+static AmrScmMsg testScm() {
+    AmrScmMsg scm = {};
+    scm.id = 12345678;
+    scm.type = 7;
+    scm.tamper_phy = 2;
+    scm.tamper_enc = 1;
+    scm.consumption = 4294967295u;
+    scm.crc = 0xbeef;
+    return scm;
+}
+
+static AmrIdmMsg testIdm(uint8_t ertType) {
+    AmrIdmMsg idm = {};
+    idm.ertType = ertType;
+    idm.ertId = 1550000001;
+    idm.consumptionIntervalCount = 42;
+    idm.txTimeOffset = 300;
+    idm.serialNumberCRC = 0x1234;
+    idm.pktCRC = 0x5678;
+    if (ertType == 0x18) {
+        idm.data.x18.lastConsumption = 900;
+        idm.data.x18.lastExcess = 1;
+        idm.data.x18.lastResidual = 2;
+        idm.data.x18.lastConsumptionHighRes = 3;
+        for (int i = 0; i < 27; i++) {
+            idm.data.x18.differentialConsumption[i] = (uint16_t)(i * 600);
+        }
+    }
+    else {
+        idm.data.std.moduleProgrammingState = 0x44;
+        idm.data.std.lastConsumption = 800;
+        for (int i = 0; i < 47; i++) {
+            idm.data.std.differentialConsumption[i] = (uint16_t)(i * 11);
+        }
+    }
+    return idm;
+}
+
+static std::string json(AMR_MSG_TYPE type, const void * msg, uint64_t time) {
+    char buf[AMR_FORMAT_MAX_LEN];
+    size_t len = amrFormatJson(buf, sizeof(buf), type, msg, time);
+    return std::string(buf, len);
+}
+
+static std::string csv(AMR_MSG_TYPE type, const void * msg, uint64_t time) {
+    char buf[AMR_FORMAT_MAX_LEN];
+    size_t len = amrFormatCsv(buf, sizeof(buf), type, msg, time);
+    return std::string(buf, len);
+}
+
+TEST(AmrFormatTest, Itoa) {
+    const uint64_t vals[] = {0, 1, 9, 10, 99, 100, 101, 999, 1000, 65535, 99999999,
+        100000000, 4294967295ull, 4294967296ull, 10000000000000000000ull,
+        18446744073709551615ull};
+    for (uint64_t v : vals) {
+        char tmp[20];
+        char ref[32];
+        snprintf(ref, sizeof(ref), "%llu", (unsigned long long)v);
+        char * s = fmtU64(tmp + sizeof(tmp), v);
+        EXPECT_EQ(std::string(ref), std::string(s, tmp + sizeof(tmp) - s));
+    }
+
+    uint32_t x = 0x12345678;
+    for (int i = 0; i < 10000; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        uint32_t v = x >> (i % 32);
+        char tmp[10];
+        char ref[16];
+        snprintf(ref, sizeof(ref), "%u", v);
+        char * s = fmtU32(tmp + sizeof(tmp), v);
+        ASSERT_EQ(std::string(ref), std::string(s, tmp + sizeof(tmp) - s));
+    }
+}
+
+TEST(AmrFormatTest, Json) {
+    AmrScmMsg scm = testScm();
+    EXPECT_EQ("{\"Time\":1700000000123,\"Type\":\"SCM\",\"Message\":{\"ID\":12345678,"
+            "\"Type\":7,\"TamperPhy\":2,\"TamperEnc\":1,\"Consumption\":4294967295,"
+            "\"ChecksumVal\":48879}}\n", json(AMR_MSG_TYPE_SCM, &scm, 1700000000123ull));
+
+    AmrScmPlusMsg scmPlus = {};
+    scmPlus.frameSync = 0x16a3;
+    scmPlus.protocolId = 0x1e;
+    scmPlus.endpointType = 0xab;
+    scmPlus.endpointId = 76543210;
+    scmPlus.consumption = 0;
+    scmPlus.tamper = 0x0102;
+    scmPlus.crc = 0xffff;
+    EXPECT_EQ("{\"Time\":0,\"Type\":\"SCM+\",\"Message\":{\"FrameSync\":5795,"
+            "\"ProtocolID\":30,\"EndpointType\":171,\"EndpointID\":76543210,"
+            "\"Consumption\":0,\"Tamper\":258,\"PacketCRC\":65535}}\n",
+            json(AMR_MSG_TYPE_SCM_PLUS, &scmPlus, 0));
+
+    AmrIdmMsg idm = testIdm(0x07);
+    std::string intervals;
+    for (int i = 0; i < 47; i++) {
+        intervals += (i ? "," : "") + std::to_string(i * 11);
+    }
+    EXPECT_EQ("{\"Time\":5,\"Type\":\"IDM\",\"Message\":{\"ERTType\":7,"
+            "\"ERTSerialNumber\":1550000001,\"ConsumptionIntervalCount\":42,"
+            "\"ModuleProgrammingState\":68,\"LastConsumptionCount\":800,"
+            "\"DifferentialConsumptionIntervals\":[" + intervals + "],"
+            "\"TransmitTimeOffset\":300,\"SerialNumberCRC\":4660,\"PacketCRC\":22136}}\n",
+            json(AMR_MSG_TYPE_IDM, &idm, 5));
+
+    idm = testIdm(0x18);
+    std::string out = json(AMR_MSG_TYPE_IDM, &idm, 5);
+    EXPECT_NE(std::string::npos, out.find("\"LastConsumptionCount\":900,\"LastExcess\":1,"
+            "\"LastResidual\":2,\"LastConsumptionHighRes\":3,"));
+    EXPECT_NE(std::string::npos, out.find(",15600],"));
+    EXPECT_EQ(std::string::npos, out.find("ModuleProgrammingState"));
+}
+
+TEST(AmrFormatTest, Csv) {
+    AmrScmMsg scm = testScm();
+    EXPECT_EQ("42,SCM,12345678,7,4294967295,9,\n", csv(AMR_MSG_TYPE_SCM, &scm, 42));
+
+    AmrIdmMsg idm = testIdm(0x18);
+    std::string intervals;
+    for (int i = 0; i < 27; i++) {
+        intervals += (i ? " " : "") + std::to_string(i * 600);
+    }
+    EXPECT_EQ("42,IDM,1550000001,24,900,," + intervals + "\n", csv(AMR_MSG_TYPE_IDM, &idm, 42));
+}
+
+TEST(AmrFormatTest, Binary) {
+    AmrIdmMsg idm = testIdm(0x18);
+    uint8_t buf[AMR_FORMAT_MAX_LEN];
+    memset(buf, 0xaa, sizeof(buf));
+    size_t len = amrFormatBinary(buf, sizeof(buf), AMR_MSG_TYPE_IDM, &idm, 0x0102030405060708ull);
+    ASSERT_EQ(sizeof(AmrRecordHeader) + sizeof(AmrIdmRecord), len);
+    const uint8_t hdr[] = {AMR_RECORD_VERSION, AMR_MSG_TYPE_IDM, (uint8_t)len, 0,
+        0x81, 0x1f, 0x63, 0x5c, 8, 7, 6, 5, 4, 3, 2, 1};
+    EXPECT_EQ(0, memcmp(hdr, buf, sizeof(hdr)));
+
+    // Casting works on little endian hosts
+    AmrIdmRecord rec;
+    memcpy(&rec, buf + sizeof(AmrRecordHeader), sizeof(rec));
+    EXPECT_EQ(900u, rec.lastConsumption);
+    EXPECT_EQ(300u, rec.txTimeOffset);
+    EXPECT_EQ(0x18u, rec.ertType);
+    EXPECT_EQ(42u, rec.intervalCount);
+    EXPECT_EQ(27u, rec.intervals);
+    EXPECT_EQ(15600u, rec.differentialConsumption[26]);
+    EXPECT_EQ(0u, rec.differentialConsumption[27]);
+    EXPECT_EQ(0u, rec.differentialConsumption[46]);
+    EXPECT_EQ(0xaa, buf[len]);
+
+    AmrScmMsg scm = testScm();
+    len = amrFormatBinary(buf, sizeof(buf), AMR_MSG_TYPE_SCM, &scm, 0);
+    ASSERT_EQ(sizeof(AmrRecordHeader) + sizeof(AmrScmRecord), len);
+    AmrRecordHeader h;
+    AmrScmRecord s;
+    memcpy(&h, buf, sizeof(h));
+    memcpy(&s, buf + sizeof(h), sizeof(s));
+    EXPECT_EQ(len, h.size);
+    EXPECT_EQ(12345678u, h.meterId);
+    EXPECT_EQ(4294967295u, s.consumption);
+    EXPECT_EQ(7u, s.ertType);
+    EXPECT_EQ(2u, s.tamperPhy);
+    EXPECT_EQ(1u, s.tamperEnc);
+}
+
+TEST(AmrFormatTest, ShortBuffer) {
+    AmrIdmMsg idm = testIdm(0x07);
+    char buf[AMR_FORMAT_MAX_LEN];
+    for (int fmt = 0; fmt < AMR_FORMAT_CNT; fmt++) {
+        size_t full = amrFormat((AMR_FORMAT)fmt, (uint8_t *)buf, sizeof(buf), AMR_MSG_TYPE_IDM, &idm, 1);
+        ASSERT_GT(full, 0u);
+        memset(buf, 0x55, sizeof(buf));
+        EXPECT_EQ(0u, amrFormat((AMR_FORMAT)fmt, (uint8_t *)buf, full - 1, AMR_MSG_TYPE_IDM, &idm, 1));
+        // Nothing past the given size is touched
+        EXPECT_EQ(0x55, buf[full - 1]);
+        EXPECT_EQ(full, amrFormat((AMR_FORMAT)fmt, (uint8_t *)buf, full, AMR_MSG_TYPE_IDM, &idm, 1));
+    }
+
+    EXPECT_EQ(0u, amrFormatJson(NULL, 100, AMR_MSG_TYPE_IDM, &idm, 1));
+    EXPECT_EQ(0u, amrFormatJson(buf, sizeof(buf), AMR_MSG_TYPE_IDM, NULL, 1));
+    EXPECT_EQ(0u, amrFormatCsv(buf, sizeof(buf), AMR_MSG_TYPE_IDM18, &idm, 1));
+    EXPECT_EQ(0u, amrFormat(AMR_FORMAT_CNT, (uint8_t *)buf, sizeof(buf), AMR_MSG_TYPE_IDM, &idm, 1));
+}
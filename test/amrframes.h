@@ -0,0 +1,131 @@
+#ifndef AMR_FRAMES_H
+#define AMR_FRAMES_H
+
+// Test frame builders. Include after amr.c.
+#include "../amr_crc.hpp"
+#include <string.h>
+#include <vector>
+
+// Append big-endian BCH CRC so the residual over data[start, len+2) is 0
+static inline void appendBCHCRC(uint8_t * data, size_t start, size_t len) {
+    uint16_t crc = AmrCrcScm::compute(data + start, len);
+    data[start + len] = crc >> 8;
+    data[start + len + 1] = crc & 0xff;
+}
+
+// Append inverted big-endian CCITT CRC so the residual is 0x1D0F
+static inline void appendCCITTCRC(uint8_t * data, size_t start, size_t len) {
+    uint16_t crc = ~AmrCrcScmPlus::compute(data + start, len);
+    data[start + len] = crc >> 8;
+    data[start + len + 1] = crc & 0xff;
+}
+
+static inline void buildScmFrame(uint8_t * f, uint32_t id, uint32_t consumption) {
+    memset(f, 0, AMR_MSG_SCM_RAW_SIZE);
+    f[0] = 0xf9;
+    f[1] = 0x53;
+    f[2] = ((id >> 23) & 0x6) | 0x01;
+    f[3] = (0x7 << 2) | (0x1 << 6) | 0x2;
+    f[4] = consumption >> 16;
+    f[5] = consumption >> 8;
+    f[6] = consumption;
+    f[7] = id >> 16;
+    f[8] = id >> 8;
+    f[9] = id;
+    appendBCHCRC(f, 2, 8);
+}
+
+static inline void buildScmPlusFrame(uint8_t * f, uint32_t id, uint32_t consumption) {
+    memset(f, 0, AMR_MSG_SCM_PLUS_RAW_SIZE);
+    f[0] = 0x16;
+    f[1] = 0xa3;
+    f[2] = 0x1e;
+    f[3] = 0x07;
+    for (int i = 0; i < 4; i++) {
+        f[4 + i] = id >> (24 - 8*i);
+        f[8 + i] = consumption >> (24 - 8*i);
+    }
+    f[12] = 0x12;
+    f[13] = 0x34;
+    appendCCITTCRC(f, 2, 12);
+}
+
+static inline void buildIdmFrame(uint8_t * f, uint32_t id, uint32_t consumption) {
+    memset(f, 0, AMR_MSG_IDM_RAW_SIZE);
+    f[0] = 0x55;
+    f[1] = 0x55;
+    f[2] = 0x16;
+    f[3] = 0xa3;
+    f[4] = 0x1c;
+    f[5] = 0x5c;
+    f[8] = 0x07;
+    for (int i = 0; i < 4; i++) {
+        f[9 + i] = id >> (24 - 8*i);
+        f[29 + i] = consumption >> (24 - 8*i);
+    }
+    f[13] = 0x2a;
+    // Differential intervals 9-bits wide: 1, 2, 3, ...
+    for (uint16_t n = 0; n < 47; n++) {
+        uint16_t val = n + 1;
+        for (uint16_t b = 0; b < 9; b++) {
+            uint16_t bit = n * 9 + b;
+            if (val & (1u << (8 - b))) {
+                f[33 + bit / 8] |= 0x80 >> (bit % 8);
+            }
+        }
+    }
+    appendCCITTCRC(f, 4, 86);
+}
+
+// Manchester encode bytes MSB first: 1 -> 0b10, 0 -> 0b01
+static inline void manchEncode(std::vector<uint8_t> & chips, const uint8_t * data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        for (int b = 7; b >= 0; b--) {
+            uint8_t bit = (data[i] >> b) & 1;
+            chips.push_back(bit);
+            chips.push_back(!bit);
+        }
+    }
+}
+
+
+// Random chips with valid frames of every type mixed in at random phases
+static inline std::vector<uint8_t> buildMixedChips(uint32_t seed, size_t frames) {
+    std::vector<uint8_t> chips;
+    uint32_t x = seed;
+    for (size_t n = 0; n < frames; n++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        size_t noise = x % 700;
+        for (size_t i = 0; i < noise; i++) {
+            chips.push_back((x >> (i % 32)) & 1);
+        }
+        uint8_t f[AMR_MSG_IDM_RAW_SIZE];
+        switch (n % 3) {
+            case 0:
+                buildScmFrame(f, x & 0x3ffffff, x >> 8);
+                manchEncode(chips, f, AMR_MSG_SCM_RAW_SIZE);
+                break;
+            case 1:
+                buildScmPlusFrame(f, x, x >> 4);
+                manchEncode(chips, f, AMR_MSG_SCM_PLUS_RAW_SIZE);
+                break;
+            default:
+                buildIdmFrame(f, x, x >> 4);
+                manchEncode(chips, f, AMR_MSG_IDM_RAW_SIZE);
+                break;
+        }
+    }
+    return chips;
+}
+
+static inline std::vector<uint8_t> packChips(const std::vector<uint8_t> & chips) {
+    std::vector<uint8_t> packed((chips.size() + 7) / 8 + 8, 0);
+    for (size_t i = 0; i < chips.size(); i++) {
+        packed[i / 8] |= chips[i] << (7 - i % 8);
+    }
+    return packed;
+}
+
+#endif
@@ -0,0 +1,177 @@
+#include "../ring/ringbuf.c"
+#include "../amr.c"
+#include "../amr_crc.c"
+#include "../amr_manch.c"
+#include "../amr_dedup.c"
+#include "../amr_gen.c"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+typedef std::tuple<uint8_t, uint32_t, uint32_t> MsgKey;
+
+static std::vector<MsgKey> rxKeys;
+static std::vector<AmrGenFrame> truth;
+
+static void testMsgCallback(const void * msg, AMR_MSG_TYPE msgType, const uint8_t * data) {
+    switch (msgType) {
+        case AMR_MSG_TYPE_SCM: {
+            const AmrScmMsg * scm = (const AmrScmMsg *)msg;
+            rxKeys.push_back(MsgKey(msgType, scm->id, scm->consumption));
+        }
+        break;
+        case AMR_MSG_TYPE_SCM_PLUS: {
+            const AmrScmPlusMsg * scmPlus = (const AmrScmPlusMsg *)msg;
+            rxKeys.push_back(MsgKey(msgType, scmPlus->endpointId, scmPlus->consumption));
+        }
+        break;
+        default: {
+            const AmrIdmMsg * idm = (const AmrIdmMsg *)msg;
+            rxKeys.push_back(MsgKey(msgType, idm->ertId, idm->data.std.lastConsumption));
+        }
+        break;
+    }
+}
+
+static void testFrameCallback(void * user, const AmrGenFrame * frame) {
+    truth.push_back(*frame);
+}
+
+class AmrGenTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        rxKeys.clear();
+        truth.clear();
+        amrInit();
+        registerAmrMsgCallback(testMsgCallback);
+    }
+
+    std::vector<uint8_t> generate(const AmrGenConfig & cfg, size_t nbits, size_t chunk) {
+        AmrGen gen;
+        std::vector<uint8_t> packed(nbits / 8);
+        EXPECT_TRUE(amrGenInit(&gen, &cfg, testFrameCallback, NULL));
+        for (size_t pos = 0; pos < nbits; pos += chunk) {
+            amrGenFill(&gen, packed.data() + pos / 8, std::min(chunk, nbits - pos));
+        }
+        EXPECT_EQ(truth.size(), gen.frames);
+        return packed;
+    }
+};
+
+TEST_F(AmrGenTest, Builders) {
+    uint8_t f[AMR_MAX_MSG_SIZE];
+    ASSERT_EQ((size_t)AMR_MSG_SCM_RAW_SIZE, amrGenScm(f, 0x3abcdef, 0xc, 0x9, 0x123456));
+    EXPECT_TRUE(amrCheckCrc(AMR_MSG_TYPE_SCM, f));
+    AmrScmMsg scm;
+    amrParseScm(f, &scm);
+    EXPECT_EQ(0x3abcdefu, scm.id);
+    EXPECT_EQ(0xcu, scm.type);
+    EXPECT_EQ(0x2u, scm.tamper_phy);
+    EXPECT_EQ(0x1u, scm.tamper_enc);
+    EXPECT_EQ(0x123456u, scm.consumption);
+
+    ASSERT_EQ((size_t)AMR_MSG_SCM_PLUS_RAW_SIZE, amrGenScmPlus(f, 0xdeadbeef, 0xab, 0x1234, 0xcafef00d));
+    EXPECT_TRUE(amrCheckCrc(AMR_MSG_TYPE_SCM_PLUS, f));
+    AmrScmPlusMsg scmPlus;
+    amrParseScmPlus(f, &scmPlus);
+    EXPECT_EQ(0xdeadbeefu, scmPlus.endpointId);
+    EXPECT_EQ(0xabu, scmPlus.endpointType);
+    EXPECT_EQ(0x1234u, scmPlus.tamper);
+    EXPECT_EQ(0xcafef00du, scmPlus.consumption);
+
+    uint16_t intervals[47];
+    for (int i = 0; i < 47; i++) {
+        intervals[i] = (uint16_t)(i * 10);
+    }
+    ASSERT_EQ((size_t)AMR_MSG_IDM_RAW_SIZE, amrGenIdm(f, 0x12345678, 0x07, 987654, intervals));
+    EXPECT_TRUE(amrCheckCrc(AMR_MSG_TYPE_IDM, f));
+    AmrIdmMsg idm;
+    amrParseIdm(f, &idm);
+    EXPECT_EQ(0x12345678u, idm.ertId);
+    EXPECT_EQ(987654u, idm.data.std.lastConsumption);
+    for (int i = 0; i < 47; i++) {
+        EXPECT_EQ(intervals[i], idm.data.std.differentialConsumption[i]);
+    }
+}
+
+TEST_F(AmrGenTest, InvalidConfig) {
+    AmrGen gen;
+    AmrGenConfig cfg = {};
+    EXPECT_FALSE(amrGenInit(&gen, &cfg, NULL, NULL));
+    cfg.framesPerSec = 1;
+    cfg.chipErrorRate = 1;
+    EXPECT_FALSE(amrGenInit(&gen, &cfg, NULL, NULL));
+    EXPECT_FALSE(amrGenInit(NULL, &cfg, NULL, NULL));
+}
+
+// The stream only depends on the seed, not on how it is pulled
+TEST_F(AmrGenTest, Deterministic) {
+    AmrGenConfig cfg = {};
+    cfg.seed = 42;
+    cfg.framesPerSec = 30;
+    cfg.chipErrorRate = 1e-3;
+    cfg.randomNoise = 1;
+    std::vector<uint8_t> a = generate(cfg, 1 << 20, 64);
+    std::vector<AmrGenFrame> truthA = truth;
+    truth.clear();
+    std::vector<uint8_t> b = generate(cfg, 1 << 20, 64 * 1000);
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(truthA.size(), truth.size());
+    cfg.seed = 43;
+    truth.clear();
+    EXPECT_NE(a, generate(cfg, 1 << 20, 1 << 20));
+}
+
+TEST_F(AmrGenTest, ChipErrorRate) {
+    AmrGenConfig cfg = {};
+    cfg.seed = 7;
+    cfg.framesPerSec = 1e-9;
+    cfg.chipErrorRate = 0.01;
+    const size_t nbits = 1 << 22;
+    std::vector<uint8_t> packed = generate(cfg, nbits, nbits);
+    EXPECT_TRUE(truth.empty());
+    size_t ones = 0;
+    for (uint8_t byte : packed) {
+        ones += __builtin_popcount(byte);
+    }
+    EXPECT_NEAR(0.01, (double)ones / nbits, 0.0005);
+}
+
+// Every frame that doesn't collide with another one is decoded exactly once
+// and nothing else is
+TEST_F(AmrGenTest, Recall) {
+    AmrGenConfig cfg = {};
+    cfg.seed = 0x5eed;
+    cfg.framesPerSec = 4;
+    cfg.randomNoise = 1;
+    const size_t nbits = 300 * 32768;
+    std::vector<uint8_t> packed = generate(cfg, nbits, 1 << 16);
+    for (size_t pos = 0; pos < nbits; pos += 512) {
+        amrProcessRxBits(packed.data() + pos / 8, 512);
+        amrProcessMsgs();
+    }
+    ASSERT_GT(truth.size(), 1000u);
+
+    std::vector<MsgKey> clean;
+    std::vector<MsgKey> all;
+    for (size_t i = 0; i < truth.size(); i++) {
+        MsgKey key(truth[i].type, truth[i].id, truth[i].consumption);
+        all.push_back(key);
+        bool collided = (i > 0 && truth[i - 1].start + truth[i - 1].chips > truth[i].start) ||
+                (i + 1 < truth.size() && truth[i].start + truth[i].chips > truth[i + 1].start) ||
+                truth[i].start + truth[i].chips > nbits;
+        if (!collided) {
+            clean.push_back(key);
+        }
+    }
+    std::sort(all.begin(), all.end());
+    std::sort(rxKeys.begin(), rxKeys.end());
+    for (const MsgKey & key : clean) {
+        EXPECT_EQ(1, std::count(rxKeys.begin(), rxKeys.end(), key));
+    }
+    for (const MsgKey & key : rxKeys) {
+        EXPECT_TRUE(std::binary_search(all.begin(), all.end(), key));
+    }
+    EXPECT_GE(rxKeys.size(), clean.size());
+}
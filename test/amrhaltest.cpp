@@ -0,0 +1,126 @@
+#define AMR_HOST_HAL
+#include "../ring/ringbuf.c"
+#include "../amr.c"
+#include "../amr_crc.c"
+#include "../amr_manch.c"
+#include "../amr_dedup.c"
+#include "amrframes.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::vector<std::vector<uint8_t> > rxFrames;
+
+static void testMsgCallback(const void * msg, AMR_MSG_TYPE msgType, const uint8_t * data) {
+    static const size_t sizes[] = {
+        AMR_MSG_SCM_RAW_SIZE, AMR_MSG_SCM_PLUS_RAW_SIZE, AMR_MSG_IDM_RAW_SIZE};
+    rxFrames.push_back(std::vector<uint8_t>(data, data + sizes[msgType]));
+}
+
+class AmrHalTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char tmpl[] = "/tmp/amrhaltestXXXXXX";
+        ASSERT_NE(nullptr, mkdtemp(tmpl));
+        dir = tmpl;
+        chips = buildMixedChips(0x4a1, 400);
+        packed = packChips(chips);
+        packed.resize((chips.size() + 7) / 8);
+
+        // Reference decode straight through amrProcessRxBits
+        rxFrames.clear();
+        amrInit();
+        registerAmrMsgCallback(testMsgCallback);
+        for (size_t pos = 0; pos < chips.size(); pos += AMR_HAL_BLOCK_CHIPS) {
+            amrProcessRxBits(packed.data() + pos / 8, std::min<size_t>(AMR_HAL_BLOCK_CHIPS, chips.size() - pos));
+            amrProcessMsgs();
+        }
+        expected = rxFrames;
+    }
+
+    void TearDown() override {
+        amrHalSetSource(NULL, AMR_HAL_FORMAT_PACKED);
+        for (const std::string & f : files) {
+            unlink(f.c_str());
+        }
+        rmdir(dir.c_str());
+    }
+
+    std::string writeFile(const char * name, const std::vector<uint8_t> & data) {
+        std::string path = dir + "/" + name;
+        FILE * f = fopen(path.c_str(), "wb");
+        fwrite(data.data(), 1, data.size(), f);
+        fclose(f);
+        files.push_back(path);
+        return path;
+    }
+
+    // Decode path with the HAL threads and compare with the reference
+    void decode(const std::string & path, AMR_HAL_FORMAT format) {
+        ASSERT_TRUE(amrHalSetSource(path.c_str(), format));
+        rxFrames.clear();
+        amrInit();
+        registerAmrMsgCallback(testMsgCallback);
+        EXPECT_FALSE(amrHalRunning());
+        amrEnable(1);
+        amrHalWait();
+        EXPECT_FALSE(amrHalRunning());
+        EXPECT_EQ(chips.size(), amrHalChips());
+        EXPECT_EQ(0u, amrDefaultDecoder.stats.dropped);
+        EXPECT_EQ(expected, rxFrames);
+    }
+
+    std::string dir;
+    std::vector<std::string> files;
+    std::vector<uint8_t> chips;
+    std::vector<uint8_t> packed;
+    std::vector<std::vector<uint8_t> > expected;
+};
+
+TEST_F(AmrHalTest, Packed) {
+    ASSERT_EQ(400u, expected.size());
+    // Pad to whole bytes with idle chips
+    chips.resize(packed.size() * 8);
+    decode(writeFile("packed", packed), AMR_HAL_FORMAT_PACKED);
+}
+
+TEST_F(AmrHalTest, Bits) {
+    decode(writeFile("bits", chips), AMR_HAL_FORMAT_BITS);
+}
+
+TEST_F(AmrHalTest, Ascii) {
+    std::vector<uint8_t> text;
+    for (size_t i = 0; i < chips.size(); i++) {
+        text.push_back('0' + chips[i]);
+        if (i % 64 == 63) {
+            text.push_back('\n');
+        }
+    }
+    decode(writeFile("ascii", text), AMR_HAL_FORMAT_ASCII);
+}
+
+// Pipes aren't mapped but read in blocks, the odd write size splits chips
+// across reads
+TEST_F(AmrHalTest, Fifo) {
+    std::string path = dir + "/fifo";
+    ASSERT_EQ(0, mkfifo(path.c_str(), 0600));
+    files.push_back(path);
+    std::thread writer([&]() {
+        FILE * f = fopen(path.c_str(), "wb");
+        for (size_t pos = 0; pos < chips.size(); pos += 4093) {
+            fwrite(chips.data() + pos, 1, std::min<size_t>(4093, chips.size() - pos), f);
+            fflush(f);
+        }
+        fclose(f);
+    });
+    decode(path, AMR_HAL_FORMAT_BITS);
+    writer.join();
+}
+
+TEST_F(AmrHalTest, InvalidSource) {
+    EXPECT_FALSE(amrHalSetSource((dir + "/missing").c_str(), AMR_HAL_FORMAT_PACKED));
+    amrEnable(1);
+    EXPECT_FALSE(amrHalRunning());
+    EXPECT_EQ(0u, amrHalChips());
+}
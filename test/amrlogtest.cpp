@@ -0,0 +1,229 @@
+#include "../amr_format.c"
+#include "../amr_log.c"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+class AmrLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char tmpl[] = "/tmp/amrlogtestXXXXXX";
+        ASSERT_NE(nullptr, mkdtemp(tmpl));
+        dir = tmpl;
+        prefix = dir + "/site";
+    }
+
+    void TearDown() override {
+        DIR * d = opendir(dir.c_str());
+        struct dirent * ent;
+        while (d && (ent = readdir(d)) != NULL) {
+            if (ent->d_name[0] != '.') {
+                unlink((dir + "/" + ent->d_name).c_str());
+            }
+        }
+        if (d) {
+            closedir(d);
+        }
+        rmdir(dir.c_str());
+    }
+
+    std::string segmentPath(uint32_t segment) {
+        char path[AMR_LOG_PATH_MAX];
+        EXPECT_TRUE(amrLogSegmentPath(path, sizeof(path), prefix.c_str(), segment));
+        return path;
+    }
+
+    // Read back every record of the segments, in order
+    std::vector<std::vector<uint8_t>> readAll(uint32_t first, uint32_t last) {
+        std::vector<std::vector<uint8_t>> out;
+        for (uint32_t s = first; s <= last; s++) {
+            AmrLogSegment seg;
+            EXPECT_TRUE(amrLogMap(&seg, segmentPath(s).c_str()));
+            const AmrRecordHeader * rec = NULL;
+            while ((rec = amrLogNext(&seg, rec)) != NULL) {
+                out.emplace_back((const uint8_t *)rec, (const uint8_t *)rec + rec->size);
+            }
+            amrLogUnmap(&seg);
+        }
+        return out;
+    }
+
+    std::string dir;
+    std::string prefix;
+    AmrLogWriter log;
+};
+
+static AmrScmMsg scmMsg(uint32_t i) {
+    AmrScmMsg scm = {};
+    scm.id = 1000 + i;
+    scm.type = 4;
+    scm.consumption = i * 7;
+    return scm;
+}
+
+TEST_F(AmrLogTest, InvalidArgs) {
+    EXPECT_FALSE(amrLogOpen(NULL, prefix.c_str(), 1 << 20, 0));
+    EXPECT_FALSE(amrLogOpen(&log, NULL, 1 << 20, 0));
+    EXPECT_FALSE(amrLogOpen(&log, prefix.c_str(), 16, 0));
+    EXPECT_FALSE(amrLogAppend(&log, AMR_MSG_TYPE_SCM, NULL, 0));
+    EXPECT_FALSE(amrLogOpen(&log, "/nonexistent/dir/site", 1 << 20, 0));
+
+    AmrLogSegment seg;
+    EXPECT_FALSE(amrLogMap(&seg, segmentPath(0).c_str()));
+    FILE * f = fopen(segmentPath(0).c_str(), "w");
+    fputs("not a segment header", f);
+    fclose(f);
+    EXPECT_FALSE(amrLogMap(&seg, segmentPath(0).c_str()));
+}
+
+TEST_F(AmrLogTest, RoundTrip) {
+    ASSERT_TRUE(amrLogOpen(&log, prefix.c_str(), 1 << 20, 4096));
+    AmrIdmMsg idm = {};
+    idm.ertType = 7;
+    idm.ertId = 55;
+    idm.data.std.lastConsumption = 12;
+    idm.data.std.differentialConsumption[46] = 9;
+    const uint32_t n = 5000;
+    for (uint32_t i = 0; i < n; i++) {
+        AmrScmMsg scm = scmMsg(i);
+        if (i % 10 == 9) {
+            ASSERT_TRUE(amrLogAppend(&log, AMR_MSG_TYPE_IDM, &idm, i));
+        }
+        else {
+            ASSERT_TRUE(amrLogAppend(&log, AMR_MSG_TYPE_SCM, &scm, i));
+        }
+    }
+    EXPECT_EQ(n, log.records);
+    ASSERT_TRUE(amrLogClose(&log));
+
+    AmrLogSegment seg;
+    ASSERT_TRUE(amrLogMap(&seg, segmentPath(0).c_str()));
+    uint32_t i = 0;
+    for (const AmrRecordHeader * rec = amrLogNext(&seg, NULL); rec; rec = amrLogNext(&seg, rec), i++) {
+        ASSERT_EQ(i, rec->time);
+        if (i % 10 == 9) {
+            ASSERT_EQ(AMR_MSG_TYPE_IDM, rec->type);
+            const AmrIdmRecord * p = (const AmrIdmRecord *)amrLogPayload(rec);
+            EXPECT_EQ(55u, rec->meterId);
+            EXPECT_EQ(12u, p->lastConsumption);
+            EXPECT_EQ(9u, p->differentialConsumption[46]);
+        }
+        else {
+            ASSERT_EQ(AMR_MSG_TYPE_SCM, rec->type);
+            const AmrScmRecord * p = (const AmrScmRecord *)amrLogPayload(rec);
+            EXPECT_EQ(1000 + i, rec->meterId);
+            EXPECT_EQ(i * 7, p->consumption);
+            EXPECT_EQ(4u, p->ertType);
+        }
+    }
+    EXPECT_EQ(n, i);
+    amrLogUnmap(&seg);
+}
+
+TEST_F(AmrLogTest, Segments) {
+    const size_t rec = sizeof(AmrRecordHeader) + sizeof(AmrScmRecord);
+    const uint64_t segmentMax = sizeof(AmrLogSegmentHeader) + 10 * rec;
+    ASSERT_TRUE(amrLogOpen(&log, prefix.c_str(), segmentMax, 0));
+    for (uint32_t i = 0; i < 35; i++) {
+        AmrScmMsg scm = scmMsg(i);
+        ASSERT_TRUE(amrLogAppend(&log, AMR_MSG_TYPE_SCM, &scm, i));
+    }
+    ASSERT_TRUE(amrLogClose(&log));
+    EXPECT_EQ(3u, log.segment);
+
+    // Opening again starts a new segment instead of touching old ones
+    ASSERT_TRUE(amrLogOpen(&log, prefix.c_str(), segmentMax, 0));
+    EXPECT_EQ(4u, log.segment);
+    for (uint32_t i = 35; i < 40; i++) {
+        AmrScmMsg scm = scmMsg(i);
+        ASSERT_TRUE(amrLogAppend(&log, AMR_MSG_TYPE_SCM, &scm, i));
+    }
+    ASSERT_TRUE(amrLogClose(&log));
+
+    struct stat st;
+    ASSERT_EQ(0, stat(segmentPath(0).c_str(), &st));
+    EXPECT_EQ(segmentMax, (uint64_t)st.st_size);
+
+    auto recs = readAll(0, 4);
+    ASSERT_EQ(40u, recs.size());
+    for (uint32_t i = 0; i < recs.size(); i++) {
+        AmrRecordHeader hdr;
+        memcpy(&hdr, recs[i].data(), sizeof(hdr));
+        EXPECT_EQ(i, hdr.time);
+        EXPECT_EQ(1000 + i, hdr.meterId);
+    }
+}
+
+TEST_F(AmrLogTest, TornTail) {
+    ASSERT_TRUE(amrLogOpen(&log, prefix.c_str(), 1 << 20, 0));
+    for (uint32_t i = 0; i < 3; i++) {
+        AmrScmMsg scm = scmMsg(i);
+        ASSERT_TRUE(amrLogAppend(&log, AMR_MSG_TYPE_SCM, &scm, i));
+    }
+    ASSERT_TRUE(amrLogClose(&log));
+
+    // A crash mid-write leaves a partial last record, which is skipped
+    struct stat st;
+    ASSERT_EQ(0, stat(segmentPath(0).c_str(), &st));
+    ASSERT_EQ(0, truncate(segmentPath(0).c_str(), st.st_size - 3));
+    EXPECT_EQ(2u, readAll(0, 0).size());
+}
+
+// Test clock, advances 250 ms per record
+static uint64_t stepClock(void * user) {
+    uint64_t * now = (uint64_t *)user;
+    *now += 250;
+    return *now;
+}
+
+TEST_F(AmrLogTest, DecoderCallback) {
+    ASSERT_TRUE(amrLogOpen(&log, prefix.c_str(), 1 << 20, 0));
+    AmrDecoder dec = {};
+    dec.user = &log;
+    AmrScmMsg scm = scmMsg(1);
+    AmrMsgHeader hdr = {AMR_MSG_TYPE_SCM, 1234, 0};
+    uint64_t before = amrLogRealTimeMs(NULL);
+    amrLogDecoderCallback(&dec, &hdr, &scm, NULL);
+    uint64_t after = amrLogRealTimeMs(NULL);
+    ASSERT_TRUE(amrLogClose(&log));
+
+    auto recs = readAll(0, 0);
+    ASSERT_EQ(1u, recs.size());
+    AmrRecordHeader rec;
+    memcpy(&rec, recs[0].data(), sizeof(rec));
+    EXPECT_GE(rec.time, before);
+    EXPECT_LE(rec.time, after);
+    EXPECT_EQ(1001u, rec.meterId);
+}
+
+TEST_F(AmrLogTest, QueryAcrossChipCountWrap) {
+    ASSERT_TRUE(amrLogOpen(&log, prefix.c_str(), 1 << 20, 0));
+    uint64_t now = 1700000000000ull;
+    log.clock = stepClock;
+    log.clockUser = &now;
+    AmrDecoder dec = {};
+    dec.user = &log;
+
+    // The chip count wraps between the fourth and fifth message
+    const uint32_t chips[] = {0xfff00000u, 0xfff80000u, 0xfffc0000u, 0xffffff00u,
+            0x00000100u, 0x00040000u, 0x00080000u, 0x00100000u};
+    for (uint32_t i = 0; i < 8; i++) {
+        AmrScmMsg scm = scmMsg(i);
+        AmrMsgHeader hdr = {AMR_MSG_TYPE_SCM, chips[i], 0};
+        amrLogDecoderCallback(&dec, &hdr, &scm, NULL);
+    }
+    ASSERT_TRUE(amrLogClose(&log));
+
+    // Records 2 to 5 by time, two on each side of the wrap
+    uint64_t from = 1700000000000ull + 3 * 250;
+    uint64_t to = 1700000000000ull + 6 * 250;
+    std::vector<uint32_t> ids;
+    for (const auto & r : readAll(0, 0)) {
+        AmrRecordHeader rec;
+        memcpy(&rec, r.data(), sizeof(rec));
+        if (rec.time >= from && rec.time <= to) {
+            ids.push_back(rec.meterId);
+        }
+    }
+    EXPECT_EQ((std::vector<uint32_t>{1002, 1003, 1004, 1005}), ids);
+}
@@ -0,0 +1,62 @@
+#include "../amr_manch.c"
+#include <gtest/gtest.h>
+#include <vector>
+
+// Reference decode one chip at a time, the same way amrProcessRxBit does
+static void refDecode(const std::vector<uint8_t> & chips, size_t nbytes, uint8_t prevChip,
+        std::vector<uint8_t> & phase0, std::vector<uint8_t> & phase1) {
+    phase0.assign(nbytes / 2, 0);
+    phase1.assign(nbytes / 2, 0);
+    uint8_t prev = prevChip;
+    for (size_t i = 0; i < nbytes * 8; i++) {
+        uint8_t chip = (chips[i / 8] >> (7 - i % 8)) & 1;
+        uint8_t bit = prev && !chip;
+        std::vector<uint8_t> & out = (i % 2) ? phase1 : phase0;
+        size_t n = i / 2;
+        out[n / 8] |= bit << (7 - n % 8);
+        prev = chip;
+    }
+}
+
+class AmrManchTest : public ::testing::TestWithParam<AMR_MANCH_IMPL> {};
+
+TEST_P(AmrManchTest, MatchesReference) {
+    if (!amrManchImplSupported(GetParam())) {
+        GTEST_SKIP() << amrManchImplName(GetParam()) << " not supported";
+    }
+    ASSERT_TRUE(amrManchSelectImpl(GetParam()));
+    EXPECT_EQ(GetParam(), amrManchImpl());
+
+    uint32_t x = 0xc0ffee;
+    for (size_t nbytes = 0; nbytes < 300; nbytes += 2) {
+        std::vector<uint8_t> chips(nbytes + 1);
+        for (uint8_t & c : chips) {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            c = (uint8_t)x;
+        }
+        for (uint8_t prevChip = 0; prevChip < 2; prevChip++) {
+            std::vector<uint8_t> ref0, ref1;
+            refDecode(chips, nbytes, prevChip, ref0, ref1);
+            // Guard byte catches overruns
+            std::vector<uint8_t> out0(nbytes / 2 + 1, 0xa5), out1(nbytes / 2 + 1, 0xa5);
+            amrManchDecode(chips.data(), nbytes, prevChip, out0.data(), out1.data());
+            EXPECT_EQ(0xa5, out0.back());
+            EXPECT_EQ(0xa5, out1.back());
+            out0.pop_back();
+            out1.pop_back();
+            ASSERT_EQ(ref0, out0) << "nbytes " << nbytes << " prev " << (int)prevChip;
+            ASSERT_EQ(ref1, out1) << "nbytes " << nbytes << " prev " << (int)prevChip;
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Impls, AmrManchTest, ::testing::Values(
+        AMR_MANCH_IMPL_SCALAR, AMR_MANCH_IMPL_BMI2, AMR_MANCH_IMPL_SSE2,
+        AMR_MANCH_IMPL_AVX2, AMR_MANCH_IMPL_NEON));
+
+TEST(AmrManchSelect, Unsupported) {
+    EXPECT_FALSE(amrManchSelectImpl(AMR_MANCH_IMPL_CNT));
+    EXPECT_STREQ("unknown", amrManchImplName(AMR_MANCH_IMPL_CNT));
+}
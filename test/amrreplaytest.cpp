@@ -0,0 +1,171 @@
+#include "../ring/ringbuf.c"
+#include "../amr.c"
+#include "../amr_crc.c"
+#include "../amr_manch.c"
+#include "../amr_dedup.c"
+#include "../amr_replay.c"
+#include "amrframes.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+static std::vector<std::vector<uint8_t> > rxFrames;
+
+static void testMsgCallback(const void * msg, AMR_MSG_TYPE msgType, const uint8_t * data) {
+    static const size_t sizes[] = {
+        AMR_MSG_SCM_RAW_SIZE, AMR_MSG_SCM_PLUS_RAW_SIZE, AMR_MSG_IDM_RAW_SIZE};
+    rxFrames.push_back(std::vector<uint8_t>(data, data + sizes[msgType]));
+}
+
+class AmrReplayTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char tmpl[] = "/tmp/amrreplaytestXXXXXX";
+        ASSERT_NE(nullptr, mkdtemp(tmpl));
+        dir = tmpl;
+        chips = buildMixedChips(0x7e91a, 90);
+        packed = packChips(chips);
+        reset();
+    }
+
+    void TearDown() override {
+        for (const std::string & f : files) {
+            unlink(f.c_str());
+        }
+        rmdir(dir.c_str());
+    }
+
+    void reset() {
+        rxFrames.clear();
+        amrInit();
+        registerAmrMsgCallback(testMsgCallback);
+    }
+
+    std::string path(const char * name) {
+        files.push_back(dir + "/" + name);
+        return files.back();
+    }
+
+    void decode() {
+        for (size_t pos = 0; pos < chips.size(); pos += 512) {
+            amrProcessRxBits(packed.data() + pos / 8, std::min<size_t>(512, chips.size() - pos));
+            amrProcessMsgs();
+        }
+    }
+
+    std::string dir;
+    std::vector<std::string> files;
+    std::vector<uint8_t> chips;
+    std::vector<uint8_t> packed;
+};
+
+TEST_F(AmrReplayTest, Chips) {
+    decode();
+    std::vector<std::vector<uint8_t> > expected = rxFrames;
+    ASSERT_EQ(90u, expected.size());
+
+    // Mix single chips with packed runs that start off byte boundaries
+    AmrRecorder rec;
+    std::string file = path("chips");
+    ASSERT_TRUE(amrRecorderOpen(&rec, file.c_str(), AMR_REPLAY_CHIPS, 0));
+    EXPECT_FALSE(amrRecorderFrame(&rec, NULL, NULL, 0));
+    size_t pos = 0;
+    for (; pos < 1003; pos++) {
+        ASSERT_TRUE(amrRecorderRxBit(&rec, chips[pos]));
+    }
+    std::vector<uint8_t> rest = packChips(std::vector<uint8_t>(chips.begin() + pos, chips.end()));
+    size_t restBits = chips.size() - pos;
+    ASSERT_TRUE(amrRecorderChips(&rec, rest.data(), 77777));
+    ASSERT_TRUE(amrRecorderChips(&rec, rest.data() + 77777 / 8 + 1, 0));
+    std::vector<uint8_t> tail = packChips(std::vector<uint8_t>(chips.begin() + pos + 77777, chips.end()));
+    ASSERT_TRUE(amrRecorderChips(&rec, tail.data(), restBits - 77777));
+    EXPECT_EQ(chips.size(), rec.chips);
+    ASSERT_TRUE(amrRecorderClose(&rec));
+
+    reset();
+    AmrReplayStats stats;
+    ASSERT_TRUE(amrReplay(NULL, file.c_str(), 0, &stats));
+    EXPECT_EQ(AMR_REPLAY_CHIPS, stats.kind);
+    EXPECT_EQ((uint32_t)AMR_REPLAY_CHIP_RATE, stats.chipRate);
+    EXPECT_EQ(chips.size(), stats.chips);
+    ASSERT_EQ(expected.size(), rxFrames.size());
+    EXPECT_TRUE(expected == rxFrames);
+}
+
+// Frames recorded by the tap replay to the same messages and CRC results
+TEST_F(AmrReplayTest, Frames) {
+    AmrRecorder rec;
+    std::string file = path("frames");
+    ASSERT_TRUE(amrRecorderOpen(&rec, file.c_str(), AMR_REPLAY_FRAMES, 0));
+    amrDecoderSetFrameTap(amrGetDecoder(), amrRecorderFrameTap, &rec);
+    decode();
+    std::vector<std::vector<uint8_t> > expected = rxFrames;
+    AmrDecoderStats expectedStats = amrGetDecoder()->stats;
+    ASSERT_EQ(90u, expected.size());
+    EXPECT_EQ(expectedStats.crcPass + expectedStats.crcFail, rec.frames);
+    EXPECT_FALSE(amrRecorderRxBit(&rec, 1));
+    ASSERT_TRUE(amrRecorderClose(&rec));
+
+    reset();
+    AmrReplayStats stats;
+    ASSERT_TRUE(amrReplay(amrGetDecoder(), file.c_str(), 0, &stats));
+    EXPECT_EQ(AMR_REPLAY_FRAMES, stats.kind);
+    EXPECT_EQ(rec.frames, stats.frames);
+    EXPECT_EQ(0u, stats.dropped);
+    EXPECT_EQ(expected, rxFrames);
+    EXPECT_EQ(expectedStats.crcPass, amrGetDecoder()->stats.crcPass);
+    EXPECT_EQ(expectedStats.crcFail, amrGetDecoder()->stats.crcFail);
+
+    struct stat st;
+    ASSERT_EQ(0, stat(file.c_str(), &st));
+    EXPECT_LT((size_t)st.st_size, packed.size());
+}
+
+// A frame the decoder rejects is counted apart from the replayed ones
+TEST_F(AmrReplayTest, DroppedFrame) {
+    AmrRecorder rec;
+    std::string file = path("dropped");
+    ASSERT_TRUE(amrRecorderOpen(&rec, file.c_str(), AMR_REPLAY_FRAMES, 0));
+    amrDecoderSetFrameTap(amrGetDecoder(), amrRecorderFrameTap, &rec);
+    decode();
+    std::vector<std::vector<uint8_t> > expected = rxFrames;
+    AmrMsgHeader hdr = {AMR_MSG_TYPE_IDM, 0, 0};
+    std::vector<uint8_t> oversized(AMR_MAX_MSG_SIZE + 2);
+    ASSERT_TRUE(amrRecorderFrame(&rec, &hdr, oversized.data(), oversized.size()));
+    uint64_t recorded = rec.frames;
+    ASSERT_TRUE(amrRecorderClose(&rec));
+
+    reset();
+    AmrReplayStats stats;
+    ASSERT_TRUE(amrReplay(NULL, file.c_str(), 0, &stats));
+    EXPECT_EQ(recorded - 1, stats.frames);
+    EXPECT_EQ(1u, stats.dropped);
+    EXPECT_EQ(expected, rxFrames);
+}
+
+TEST_F(AmrReplayTest, RealTime) {
+    AmrRecorder rec;
+    std::string file = path("realtime");
+    ASSERT_TRUE(amrRecorderOpen(&rec, file.c_str(), AMR_REPLAY_CHIPS, 1000000));
+    std::vector<uint8_t> idle(100000 / 8);
+    ASSERT_TRUE(amrRecorderChips(&rec, idle.data(), 100000));
+    ASSERT_TRUE(amrRecorderClose(&rec));
+
+    AmrReplayStats stats;
+    ASSERT_TRUE(amrReplay(NULL, file.c_str(), 1, &stats));
+    EXPECT_EQ(100000u, stats.chips);
+    EXPECT_GE(stats.seconds, 0.099);
+    ASSERT_TRUE(amrReplay(NULL, file.c_str(), 0, &stats));
+    EXPECT_LT(stats.seconds, 0.099);
+}
+
+TEST_F(AmrReplayTest, InvalidFile) {
+    AmrRecorder rec;
+    EXPECT_FALSE(amrRecorderOpen(&rec, (dir + "/missing/file").c_str(), AMR_REPLAY_CHIPS, 0));
+    EXPECT_FALSE(amrReplay(NULL, (dir + "/missing").c_str(), 0, NULL));
+    std::string file = path("garbage");
+    FILE * f = fopen(file.c_str(), "wb");
+    fputs("definitely not a recording", f);
+    fclose(f);
+    EXPECT_FALSE(amrReplay(NULL, file.c_str(), 0, NULL));
+}
@@ -0,0 +1,654 @@
+// #define AMR_DEBUG 1
+#include "../ring/ringbuf.c"
+#include "../amr.c"
+#include "../amr_crc.c"
+#include "../amr_manch.c"
+#include "../amr_dedup.c"
+#include "../amr_filter.c"
+#include "amrframes.h"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+static std::vector<AMR_MSG_TYPE> rxTypes;
+static std::vector<std::vector<uint8_t> > rxFrames;
+static AmrScmMsg rxScm;
+static AmrScmPlusMsg rxScmPlus;
+static AmrIdmMsg rxIdm;
+
+static void testMsgCallback(const void * msg, AMR_MSG_TYPE msgType, const uint8_t * data) {
+    static const size_t sizes[] = {
+        AMR_MSG_SCM_RAW_SIZE, AMR_MSG_SCM_PLUS_RAW_SIZE, AMR_MSG_IDM_RAW_SIZE};
+    rxTypes.push_back(msgType);
+    rxFrames.push_back(std::vector<uint8_t>(data, data + sizes[msgType]));
+    switch (msgType) {
+        case AMR_MSG_TYPE_SCM: rxScm = *(const AmrScmMsg *)msg; break;
+        case AMR_MSG_TYPE_SCM_PLUS: rxScmPlus = *(const AmrScmPlusMsg *)msg; break;
+        case AMR_MSG_TYPE_IDM: rxIdm = *(const AmrIdmMsg *)msg; break;
+        default: break;
+    }
+}
+
+class AmrTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        rxTypes.clear();
+        rxFrames.clear();
+        amrInit();
+        registerAmrMsgCallback(testMsgCallback);
+    }
+
+    // Feed chips surrounded by idle zeros, optionally shifted by one chip
+    void feed(const std::vector<uint8_t> & chips, int phaseShift) {
+        static const uint8_t idle[8] = {};
+        std::vector<uint8_t> stream;
+        if (phaseShift) {
+            stream.push_back(1);
+        }
+        manchEncode(stream, idle, sizeof(idle));
+        stream.insert(stream.end(), chips.begin(), chips.end());
+        manchEncode(stream, idle, sizeof(idle));
+        for (uint8_t chip : stream) {
+            amrProcessRxBit(chip);
+        }
+        amrProcessMsgs();
+    }
+};
+
+TEST_F(AmrTest, ScmBothPhases) {
+    uint8_t f[AMR_MSG_SCM_RAW_SIZE];
+    buildScmFrame(f, 0x1234567, 7654321);
+    std::vector<uint8_t> chips;
+    manchEncode(chips, f, sizeof(f));
+
+    for (int shift = 0; shift < 2; shift++) {
+        rxTypes.clear();
+        feed(chips, shift);
+        ASSERT_EQ(1u, rxTypes.size());
+        EXPECT_EQ(AMR_MSG_TYPE_SCM, rxTypes[0]);
+        EXPECT_EQ(0x1234567u & 0x0300ffff, rxScm.id & 0x0300ffff);
+        EXPECT_EQ(7654321u, rxScm.consumption);
+        EXPECT_EQ(7u, rxScm.type);
+        EXPECT_EQ(1u, rxScm.tamper_phy);
+        EXPECT_EQ(2u, rxScm.tamper_enc);
+    }
+}
+
+TEST_F(AmrTest, ScmPlus) {
+    uint8_t f[AMR_MSG_SCM_PLUS_RAW_SIZE];
+    buildScmPlusFrame(f, 87654321, 123456);
+    std::vector<uint8_t> chips;
+    manchEncode(chips, f, sizeof(f));
+    feed(chips, 1);
+
+    ASSERT_EQ(1u, rxTypes.size());
+    EXPECT_EQ(AMR_MSG_TYPE_SCM_PLUS, rxTypes[0]);
+    EXPECT_EQ(0x16a3, rxScmPlus.frameSync);
+    EXPECT_EQ(87654321u, rxScmPlus.endpointId);
+    EXPECT_EQ(123456u, rxScmPlus.consumption);
+    EXPECT_EQ(0x1234, rxScmPlus.tamper);
+}
+
+TEST_F(AmrTest, Idm) {
+    uint8_t f[AMR_MSG_IDM_RAW_SIZE];
+    buildIdmFrame(f, 44332211, 998877);
+    std::vector<uint8_t> chips;
+    manchEncode(chips, f, sizeof(f));
+    feed(chips, 0);
+
+    // The trailing SCM+ hit inside the IDM preamble fails its CRC
+    ASSERT_EQ(1u, rxTypes.size());
+    EXPECT_EQ(AMR_MSG_TYPE_IDM, rxTypes[0]);
+    EXPECT_EQ(44332211u, rxIdm.ertId);
+    EXPECT_EQ(0x07, rxIdm.ertType);
+    EXPECT_EQ(998877u, rxIdm.data.std.lastConsumption);
+    for (int i = 0; i < 47; i++) {
+        EXPECT_EQ(i + 1, rxIdm.data.std.differentialConsumption[i]);
+    }
+}
+
+TEST_F(AmrTest, BackToBack) {
+    uint8_t scm[AMR_MSG_SCM_RAW_SIZE];
+    uint8_t idm[AMR_MSG_IDM_RAW_SIZE];
+    buildScmFrame(scm, 11, 22);
+    buildIdmFrame(idm, 33, 44);
+    std::vector<uint8_t> chips;
+    manchEncode(chips, scm, sizeof(scm));
+    manchEncode(chips, idm, sizeof(idm));
+    manchEncode(chips, scm, sizeof(scm));
+    feed(chips, 1);
+
+    ASSERT_EQ(3u, rxTypes.size());
+    EXPECT_EQ(AMR_MSG_TYPE_SCM, rxTypes[0]);
+    EXPECT_EQ(AMR_MSG_TYPE_IDM, rxTypes[1]);
+    EXPECT_EQ(AMR_MSG_TYPE_SCM, rxTypes[2]);
+}
+
+TEST_F(AmrTest, CorruptedFrame) {
+    uint8_t f[AMR_MSG_SCM_RAW_SIZE];
+    buildScmFrame(f, 0x1234567, 7654321);
+    f[5] ^= 0x10;
+    std::vector<uint8_t> chips;
+    manchEncode(chips, f, sizeof(f));
+    feed(chips, 0);
+
+    EXPECT_EQ(0u, rxTypes.size());
+}
+
+TEST_F(AmrTest, BulkMatchesPerBit) {
+    std::vector<uint8_t> chips = buildMixedChips(0xdeadbeef, 60);
+    for (uint8_t chip : chips) {
+        amrProcessRxBit(chip);
+        amrProcessMsgs();
+    }
+    std::vector<AMR_MSG_TYPE> bitTypes = rxTypes;
+    std::vector<std::vector<uint8_t> > bitFrames = rxFrames;
+    EXPECT_EQ(60u, bitTypes.size());
+
+    // Feed the same chips in uneven blocks so words straddle block edges
+    static const size_t blocks[] = {1, 63, 64, 200, 1024, 7};
+    for (size_t blk : blocks) {
+        rxTypes.clear();
+        rxFrames.clear();
+        amrInit();
+        size_t pos = 0;
+        while (pos < chips.size()) {
+            size_t n = std::min(blk, chips.size() - pos);
+            std::vector<uint8_t> sub(chips.begin() + pos, chips.begin() + pos + n);
+            amrProcessRxBits(packChips(sub).data(), n);
+            amrProcessMsgs();
+            pos += n;
+        }
+        EXPECT_EQ(bitTypes, rxTypes) << "block size " << blk;
+        EXPECT_TRUE(bitFrames == rxFrames) << "block size " << blk;
+    }
+}
+
+static std::vector<uint32_t> rxIdmIds;
+
+// Feed packed chips in blocks, draining messages in between so the ring never fills
+static void feedBlocks(const std::vector<uint8_t> & packed, size_t nchips) {
+    for (size_t pos = 0; pos < nchips; pos += 512) {
+        amrProcessRxBits(packed.data() + pos / 8, std::min<size_t>(512, nchips - pos));
+        amrProcessMsgs();
+    }
+}
+
+static void testIdmMsgCallback(const AmrIdmMsg * msg) {
+    rxIdmIds.push_back(msg->ertId);
+}
+
+// Only IDM is subscribed, the other types are skipped in amrProcessMsgs or,
+// with the preamble filter, never captured
+TEST_F(AmrTest, TypedCallbacks) {
+    std::vector<uint8_t> chips = buildMixedChips(0x5eed, 60);
+    std::vector<uint8_t> packed = packChips(chips);
+    feedBlocks(packed, chips.size());
+    ASSERT_EQ(60u, rxTypes.size());
+    std::vector<uint32_t> idmIds;
+    for (size_t i = 0; i < rxTypes.size(); i++) {
+        if (rxTypes[i] == AMR_MSG_TYPE_IDM) {
+            AmrIdmMsg msg;
+            amrParseIdm(rxFrames[i].data(), &msg);
+            idmIds.push_back(msg.ertId);
+        }
+    }
+    ASSERT_FALSE(idmIds.empty());
+    ASSERT_LT(idmIds.size(), rxTypes.size());
+
+    for (uint8_t filter = 0; filter < 2; filter++) {
+        rxTypes.clear();
+        rxIdmIds.clear();
+        amrInit();
+        registerAmrMsgCallback(NULL);
+        registerIdmMsgCallback(testIdmMsgCallback);
+        amrSetPreambleFilter(filter);
+        feedBlocks(packed, chips.size());
+
+        EXPECT_TRUE(rxTypes.empty());
+        EXPECT_EQ(idmIds, rxIdmIds) << "filter " << (int)filter;
+        if (filter) {
+            EXPECT_EQ(0u, amrDefaultDecoder.stats.unsubscribed);
+            EXPECT_EQ(idmIds.size(), amrDefaultDecoder.stats.preambles);
+        }
+        else {
+            EXPECT_LT(0u, amrDefaultDecoder.stats.unsubscribed);
+        }
+    }
+    registerIdmMsgCallback(NULL);
+    amrSetPreambleFilter(0);
+}
+
+// No callback registered: frames must still reach amrDrainMsgs and a callback
+// set directly on the default decoder
+TEST_F(AmrTest, DrainWithoutCallback) {
+    uint8_t f[AMR_MSG_SCM_RAW_SIZE];
+    buildScmFrame(f, 0x1234567, 7654321);
+    AmrMsgHeader hdr = {AMR_MSG_TYPE_SCM, 100, 0};
+
+    amrInit();
+    registerAmrMsgCallback(NULL);
+    ASSERT_TRUE(amrDecoderInjectFrame(amrGetDecoder(), &hdr, f, sizeof(f)));
+    AmrTaggedMsg msgs[4];
+    ASSERT_EQ(1u, amrDrainMsgs(msgs, 4));
+    EXPECT_EQ(AMR_MSG_TYPE_SCM, msgs[0].hdr.type);
+    EXPECT_EQ(7654321u, msgs[0].msg.scm.consumption);
+    EXPECT_EQ(0u, amrGetDecoder()->stats.unsubscribed);
+    EXPECT_EQ(1u, amrGetDecoder()->stats.crcPass);
+
+    std::vector<std::vector<uint8_t> > frames;
+    amrDecoderRegisterMsgCallback(amrGetDecoder(), [](AmrDecoder * dec, const AmrMsgHeader * h,
+                const void * msg, const uint8_t * data) {
+            ((std::vector<std::vector<uint8_t> > *)dec->user)->push_back(
+                std::vector<uint8_t>(data, data + AMR_MSG_SCM_RAW_SIZE));
+        }, &frames);
+    ASSERT_TRUE(amrDecoderInjectFrame(amrGetDecoder(), &hdr, f, sizeof(f)));
+    amrProcessMsgs();
+    ASSERT_EQ(1u, frames.size());
+    EXPECT_EQ(0, memcmp(f, frames[0].data(), sizeof(f)));
+}
+
+TEST_F(AmrTest, IdFilter) {
+    std::vector<uint8_t> chips = buildMixedChips(0xf117e4, 60);
+    std::vector<uint8_t> packed = packChips(chips);
+    feedBlocks(packed, chips.size());
+    ASSERT_EQ(60u, rxTypes.size());
+    std::vector<uint32_t> ids;
+    for (size_t i = 0; i < rxTypes.size(); i++) {
+        ids.push_back(amrFrameMeterId(rxTypes[i], rxFrames[i].data()));
+    }
+
+    // Every third meter goes in the set
+    uint32_t slots[64];
+    AmrIdFilter filter;
+    ASSERT_TRUE(amrIdFilterInit(&filter, slots, 64, AMR_FILTER_ALLOW));
+    std::vector<uint32_t> allowed, denied;
+    for (size_t i = 0; i < ids.size(); i++) {
+        if (i % 3 == 0) {
+            amrIdFilterAdd(&filter, ids[i]);
+            allowed.push_back(ids[i]);
+        }
+        else {
+            denied.push_back(ids[i]);
+        }
+    }
+
+    for (AMR_FILTER_MODE mode : {AMR_FILTER_ALLOW, AMR_FILTER_DENY}) {
+        filter.mode = mode;
+        rxTypes.clear();
+        rxFrames.clear();
+        amrInit();
+        amrSetIdFilter(&filter);
+        feedBlocks(packed, chips.size());
+        std::vector<uint32_t> rxIds;
+        for (size_t i = 0; i < rxTypes.size(); i++) {
+            rxIds.push_back(amrFrameMeterId(rxTypes[i], rxFrames[i].data()));
+        }
+        EXPECT_EQ(mode == AMR_FILTER_ALLOW ? allowed : denied, rxIds);
+        EXPECT_LE((mode == AMR_FILTER_ALLOW ? denied : allowed).size(),
+                amrDefaultDecoder.stats.filtered);
+    }
+}
+
+// Every frame sent twice in a row is delivered once
+TEST_F(AmrTest, Dedup) {
+    std::vector<uint8_t> chips;
+    static const uint8_t idle[4] = {};
+    for (uint32_t n = 0; n < 8; n++) {
+        uint8_t f[AMR_MSG_IDM_RAW_SIZE];
+        buildIdmFrame(f, 1000 + n % 4, n);
+        for (int copy = 0; copy < 2; copy++) {
+            manchEncode(chips, f, sizeof(f));
+            manchEncode(chips, idle, sizeof(idle));
+        }
+    }
+    std::vector<uint8_t> packed = packChips(chips);
+
+    AmrDedupEntry entries[16];
+    AmrDedup dedup;
+    ASSERT_TRUE(amrDedupInit(&dedup, entries, 16, 100000));
+    amrSetDedup(&dedup);
+    feedBlocks(packed, chips.size());
+    amrSetDedup(NULL);
+
+    ASSERT_EQ(8u, rxTypes.size());
+    EXPECT_EQ(8u, amrDefaultDecoder.stats.duplicates);
+    EXPECT_EQ(8u, dedup.hits);
+    EXPECT_EQ(8u, dedup.misses);
+    EXPECT_EQ(1003u, rxIdm.ertId);
+}
+
+static void decoderMsgCallback(AmrDecoder * dec, const AmrMsgHeader * hdr,
+        const void * msg, const uint8_t * data) {
+    std::vector<uint32_t> * ids = (std::vector<uint32_t> *)dec->user;
+    ASSERT_EQ(AMR_MSG_TYPE_SCM, hdr->type);
+    ids->push_back(((const AmrScmMsg *)msg)->id & 0xffff);
+}
+
+TEST(AmrParseTest, CallerBuffers) {
+    uint8_t scm[AMR_MSG_SCM_RAW_SIZE];
+    uint8_t scmPlus[AMR_MSG_SCM_PLUS_RAW_SIZE];
+    uint8_t idm[AMR_MSG_IDM_RAW_SIZE];
+    buildScmFrame(scm, 0x1234567, 7654321);
+    buildScmPlusFrame(scmPlus, 87654321, 123456);
+    buildIdmFrame(idm, 44332211, 998877);
+
+    AmrScmMsg scmMsg;
+    ASSERT_TRUE(amrParseScm(scm, &scmMsg));
+    EXPECT_EQ(7654321u, scmMsg.consumption);
+    AmrScmPlusMsg scmPlusMsg;
+    ASSERT_TRUE(amrParseScmPlus(scmPlus, &scmPlusMsg));
+    EXPECT_EQ(87654321u, scmPlusMsg.endpointId);
+    AmrIdmMsg idmMsg;
+    ASSERT_TRUE(amrParseIdm(idm, &idmMsg));
+    EXPECT_EQ(44332211u, idmMsg.ertId);
+    EXPECT_EQ(47, idmMsg.data.std.differentialConsumption[46]);
+
+    EXPECT_FALSE(amrParseScm(NULL, &scmMsg));
+    EXPECT_FALSE(amrParseScmPlus(scmPlus, NULL));
+    EXPECT_FALSE(amrParseIdm(NULL, NULL));
+}
+
+// Every thread parses its own frames into its own messages
+TEST(AmrParseTest, Threads) {
+    const int threads = 4;
+    std::vector<int> failures(threads, 0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([t, &failures]() {
+            uint8_t idm[AMR_MSG_IDM_RAW_SIZE];
+            AmrIdmMsg msg;
+            for (uint32_t i = 0; i < 2000; i++) {
+                uint32_t id = t * 100000 + i;
+                buildIdmFrame(idm, id, id * 3);
+                if (!amrParseIdm(idm, &msg) || msg.ertId != id ||
+                        msg.data.std.lastConsumption != id * 3) {
+                    failures[t]++;
+                }
+            }
+        });
+    }
+    for (std::thread & w : workers) {
+        w.join();
+    }
+    for (int t = 0; t < threads; t++) {
+        EXPECT_EQ(0, failures[t]) << "thread " << t;
+    }
+}
+
+TEST(AmrDecoderTest, IndependentInstances) {
+    AmrDecoder decs[2];
+    std::vector<uint32_t> ids[2];
+    std::vector<uint8_t> chips[2];
+    for (int d = 0; d < 2; d++) {
+        amrDecoderInit(&decs[d]);
+        amrDecoderRegisterMsgCallback(&decs[d], decoderMsgCallback, &ids[d]);
+        static const uint8_t idle[5] = {};
+        manchEncode(chips[d], idle, sizeof(idle) - d);
+        for (uint32_t n = 0; n < 4; n++) {
+            uint8_t f[AMR_MSG_SCM_RAW_SIZE];
+            buildScmFrame(f, 100 * d + n, n);
+            manchEncode(chips[d], f, sizeof(f));
+            manchEncode(chips[d], idle, sizeof(idle));
+        }
+    }
+
+    // Interleave the two streams chip by chip
+    for (size_t i = 0; i < std::max(chips[0].size(), chips[1].size()); i++) {
+        for (int d = 0; d < 2; d++) {
+            if (i < chips[d].size()) {
+                uint8_t packed = chips[d][i] << 7;
+                amrDecoderProcessBits(&decs[d], &packed, 1);
+            }
+        }
+    }
+    amrDecoderProcessMsgs(&decs[0]);
+    amrDecoderProcessMsgs(&decs[1]);
+
+    EXPECT_EQ(std::vector<uint32_t>({0, 1, 2, 3}), ids[0]);
+    EXPECT_EQ(std::vector<uint32_t>({100, 101, 102, 103}), ids[1]);
+}
+
+// Feed SCM frames with ids first, first + 1, ... one chip at a time
+static void feedScmFrames(AmrDecoder * dec, uint32_t first, uint32_t cnt) {
+    static const uint8_t idle[4] = {};
+    std::vector<uint8_t> chips;
+    manchEncode(chips, idle, sizeof(idle));
+    for (uint32_t n = 0; n < cnt; n++) {
+        uint8_t f[AMR_MSG_SCM_RAW_SIZE];
+        buildScmFrame(f, first + n, n);
+        manchEncode(chips, f, sizeof(f));
+        manchEncode(chips, idle, sizeof(idle));
+    }
+    for (uint8_t chip : chips) {
+        uint8_t packed = chip << 7;
+        amrDecoderProcessBits(dec, &packed, 1);
+    }
+}
+
+static void batchCallback(AmrDecoder * dec, const AmrTaggedMsg * msgs, size_t cnt) {
+    std::vector<std::vector<uint32_t> > * batches = (std::vector<std::vector<uint32_t> > *)dec->user;
+    batches->push_back(std::vector<uint32_t>());
+    for (size_t i = 0; i < cnt; i++) {
+        EXPECT_EQ(AMR_MSG_TYPE_SCM, msgs[i].hdr.type);
+        AmrScmMsg raw;
+        amrParseScm(msgs[i].frame, &raw);
+        EXPECT_EQ(raw.id, msgs[i].msg.scm.id);
+        batches->back().push_back(msgs[i].msg.scm.id);
+    }
+}
+
+TEST(AmrDecoderTest, BatchCallback) {
+    AmrDecoder dec;
+    AmrTaggedMsg msgs[2];
+    std::vector<std::vector<uint32_t> > batches;
+    amrDecoderInit(&dec);
+    amrDecoderRegisterMsgCallback(&dec, decoderMsgCallback, &batches);
+    amrDecoderRegisterBatchCallback(&dec, batchCallback, msgs, 2);
+
+    feedScmFrames(&dec, 10, 5);
+    amrDecoderProcessMsgs(&dec);
+    ASSERT_EQ(3u, batches.size());
+    EXPECT_EQ(std::vector<uint32_t>({10, 11}), batches[0]);
+    EXPECT_EQ(std::vector<uint32_t>({12, 13}), batches[1]);
+    EXPECT_EQ(std::vector<uint32_t>({14}), batches[2]);
+
+    // An exactly full batch doesn't trigger an empty one
+    batches.clear();
+    feedScmFrames(&dec, 20, 2);
+    amrDecoderProcessMsgs(&dec);
+    ASSERT_EQ(1u, batches.size());
+    EXPECT_EQ(std::vector<uint32_t>({20, 21}), batches[0]);
+}
+
+TEST(AmrDecoderTest, DrainMsgs) {
+    AmrDecoder dec;
+    AmrTaggedMsg msgs[3];
+    amrDecoderInit(&dec);
+
+    feedScmFrames(&dec, 30, 5);
+    ASSERT_EQ(3u, amrDecoderDrainMsgs(&dec, msgs, 3));
+    EXPECT_EQ(30u, msgs[0].msg.scm.id);
+    EXPECT_EQ(32u, msgs[2].msg.scm.id);
+    ASSERT_EQ(2u, amrDecoderDrainMsgs(&dec, msgs, 3));
+    EXPECT_EQ(34u, msgs[1].msg.scm.id);
+    EXPECT_EQ(0u, amrDecoderDrainMsgs(&dec, msgs, 3));
+    EXPECT_EQ(5u, dec.stats.crcPass);
+}
+
+TEST(AmrDecoderTest, RealignMatchesByteLoop) {
+    uint8_t ref[64];
+    uint8_t out[64];
+    uint32_t x = 0x9e3779b9;
+    for (size_t len = 0; len < 48; len++) {
+        for (uint8_t offset = 1; offset < 8; offset++) {
+            for (size_t i = 0; i < sizeof(ref); i++) {
+                x = x * 1103515245 + 12345;
+                ref[i] = out[i] = (uint8_t)(x >> 16);
+            }
+            uint8_t next = ref[len];
+            for (size_t i = 0; i < len; i++) {
+                ref[i] = (ref[i] << offset) | (ref[i+1] >> (8-offset));
+            }
+            amrRealign(out, len, next, offset);
+            ASSERT_EQ(0, memcmp(ref, out, sizeof(ref))) << len << " " << (int)offset;
+        }
+    }
+}
+
+TEST(AmrDecoderTest, UnpackMatchesExtractBits) {
+    uint8_t data[64];
+    uint16_t out[47];
+    uint32_t x = 0x2545f491;
+    for (int round = 0; round < 64; round++) {
+        for (size_t i = 0; i < sizeof(data); i++) {
+            x = x * 1103515245 + 12345;
+            data[i] = (uint8_t)(x >> 16);
+        }
+        amrUnpack9x47(data, out);
+        for (uint16_t i = 0; i < 47; i++) {
+            ASSERT_EQ(extractBits(data, i * 9, 9), out[i]) << i;
+        }
+        amrUnpack14x27(data, out);
+        for (uint16_t i = 0; i < 27; i++) {
+            ASSERT_EQ(extractBits(data, i * 14, 14), out[i]) << i;
+        }
+    }
+}
+
+static void offsetMsgCallback(AmrDecoder * dec, const AmrMsgHeader * hdr,
+        const void * msg, const uint8_t * data) {
+    std::vector<std::vector<uint8_t> > * frames = (std::vector<std::vector<uint8_t> > *)dec->user;
+    static const size_t sizes[] = {
+        AMR_MSG_SCM_RAW_SIZE, AMR_MSG_SCM_PLUS_RAW_SIZE, AMR_MSG_IDM_RAW_SIZE};
+    frames->push_back(std::vector<uint8_t>(data, data + sizes[hdr->type]));
+}
+
+// Frames that start mid byte are pushed with their bit offset and one extra
+// trailing byte, as a producer without byte aligned captures would
+TEST(AmrDecoderTest, BitOffsetFrames) {
+    uint8_t frames[3][AMR_MAX_MSG_SIZE];
+    const size_t sizes[] = {
+        AMR_MSG_SCM_RAW_SIZE, AMR_MSG_SCM_PLUS_RAW_SIZE, AMR_MSG_IDM_RAW_SIZE};
+    buildScmFrame(frames[AMR_MSG_TYPE_SCM], 0x1234567, 7654321);
+    buildScmPlusFrame(frames[AMR_MSG_TYPE_SCM_PLUS], 87654321, 123456);
+    buildIdmFrame(frames[AMR_MSG_TYPE_IDM], 0x1a2b3c4d, 1000);
+
+    AmrDecoder dec;
+    std::vector<std::vector<uint8_t> > rx;
+    amrDecoderInit(&dec);
+    amrDecoderRegisterMsgCallback(&dec, offsetMsgCallback, &rx);
+
+    for (uint8_t offset = 0; offset < 8; offset++) {
+        for (int type = 0; type < 3; type++) {
+            for (int corrupt = 0; corrupt < 2; corrupt++) {
+                uint8_t msg[AMR_MSG_HDR_SIZE + AMR_MAX_MSG_SIZE + 1];
+                AmrMsgHeader * hdr = (AmrMsgHeader *)msg;
+                hdr->type = (AMR_MSG_TYPE)type;
+                hdr->timestamp = 0;
+                hdr->bitOffset = offset;
+
+                // Random leading bits followed by the frame and zero padding
+                uint8_t * data = msg + AMR_MSG_HDR_SIZE;
+                uint8_t prev = 0xa5;
+                for (size_t i = 0; i <= sizes[type]; i++) {
+                    uint8_t cur = i < sizes[type] ? frames[type][i] : 0;
+                    data[i] = (uint8_t)((prev << (8 - offset)) | (cur >> offset));
+                    prev = cur;
+                }
+                if (corrupt) {
+                    data[sizes[type] / 2] ^= 0x10;
+                }
+
+                rx.clear();
+                uint32_t crcFail = dec.stats.crcFail;
+                ASSERT_EQ(RING_STATUS_OK, ringPush(&dec.msgRing, msg,
+                            AMR_MSG_HDR_SIZE + sizes[type] + (offset != 0)));
+                amrDecoderProcessMsgs(&dec);
+
+                if (corrupt) {
+                    EXPECT_EQ(0u, rx.size());
+                    EXPECT_EQ(crcFail + 1, dec.stats.crcFail);
+                    continue;
+                }
+                ASSERT_EQ(1u, rx.size()) << type << " " << (int)offset;
+                EXPECT_EQ(std::vector<uint8_t>(frames[type], frames[type] + sizes[type]), rx[0]);
+            }
+        }
+    }
+
+    // A frame with a bit offset but without the trailing byte is dropped
+    uint8_t msg[AMR_MSG_HDR_SIZE + AMR_MSG_SCM_RAW_SIZE];
+    AmrMsgHeader * hdr = (AmrMsgHeader *)msg;
+    hdr->type = AMR_MSG_TYPE_SCM;
+    hdr->bitOffset = 3;
+    rx.clear();
+    ASSERT_EQ(RING_STATUS_OK, ringPush(&dec.msgRing, msg, sizeof(msg)));
+    amrDecoderProcessMsgs(&dec);
+    EXPECT_EQ(0u, rx.size());
+    EXPECT_EQ(RING_STATUS_EMPTY, ringStatus(&dec.msgRing));
+}
+
+TEST(AmrDecoderTest, EarlyCrc) {
+    // Valid and corrupted frames of every type separated by idle bits
+    std::vector<uint8_t> chips;
+    static const uint8_t idle[4] = {};
+    const size_t sizes[] = {
+        AMR_MSG_SCM_RAW_SIZE, AMR_MSG_SCM_PLUS_RAW_SIZE, AMR_MSG_IDM_RAW_SIZE};
+    for (uint32_t n = 0; n < 60; n++) {
+        uint8_t f[AMR_MAX_MSG_SIZE];
+        switch (n % 3) {
+            case 0: buildScmFrame(f, n, n); break;
+            case 1: buildScmPlusFrame(f, n, n); break;
+            default: buildIdmFrame(f, n, n); break;
+        }
+        if (n & 4) {
+            f[sizes[n % 3] - 3] ^= 0x01;
+        }
+        manchEncode(chips, f, sizes[n % 3]);
+        manchEncode(chips, idle, sizeof(idle));
+    }
+    std::vector<uint8_t> packed = packChips(chips);
+
+    uint32_t offValid = 0;
+    uint32_t offInvalid = 0;
+    for (uint8_t early = 0; early < 2; early++) {
+        AmrDecoder dec;
+        amrDecoderInit(&dec);
+        amrDecoderSetEarlyCrc(&dec, early);
+
+        // Drain the ring after every block and count what reached it
+        uint32_t valid = 0;
+        uint32_t invalid = 0;
+        for (size_t bit = 0; bit < chips.size(); bit += 1024) {
+            size_t nbits = std::min<size_t>(1024, chips.size() - bit);
+            amrDecoderProcessBits(&dec, &packed[bit / 8], nbits);
+            uint8_t * msg = NULL;
+            while (ringPeek(&dec.msgRing, &msg)) {
+                const AmrMsgHeader * hdr = (const AmrMsgHeader *)msg;
+                if (amrCheckCrc(hdr->type, msg + AMR_MSG_HDR_SIZE)) {
+                    ++valid;
+                }
+                else {
+                    ++invalid;
+                }
+                ringRelease(&dec.msgRing);
+            }
+        }
+
+        // The filter keeps every valid frame, including the odd false hit
+        // inside another frame that happens to pass, and rejects the rest
+        EXPECT_EQ(0u, dec.stats.dropped);
+        EXPECT_GE(valid, 30u);
+        if (!early) {
+            EXPECT_GE(invalid, 30u);
+            offValid = valid;
+            offInvalid = invalid;
+        }
+        else {
+            EXPECT_EQ(offValid, valid);
+            EXPECT_EQ(0u, invalid);
+            EXPECT_EQ(offInvalid, dec.stats.crcFail);
+        }
+    }
+}
@@ -1,9 +1,22 @@
 // #define RINGBUF_DEBUG 1
 #include "ringbuf.c"
 #include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
 
 #define RING_BUFFER_SIZE1 32
 
+#ifndef RING_STRESS_MSGS
+#define RING_STRESS_MSGS 100000000ULL
+#endif
+#define RING_STRESS_SIZE 4096
+#define RING_STRESS_MAX_MSG 600
+#define RING_BENCH_MSGS (1u << 22)
+
+// The Init, Basic, Wrapping and ReserveCommit tests check exact positions of
+// the default layout. The RING_POW2 layout has its own tests below.
+#ifndef RING_POW2
+
 TEST(RingTest, Init) {
     uint8_t buffer[RING_BUFFER_SIZE1];
     Ring ring = ringInit(buffer, sizeof(buffer));
@@ -18,6 +31,7 @@ TEST(RingTest, Init) {
 
     EXPECT_EQ(RING_BUFFER_SIZE1 - sizeof(RingPos_t) - 1, ringFree(&ring));
 }
+#endif
 
 TEST(RingTest, InvalidData) {
     uint8_t buffer[RING_BUFFER_SIZE1];
@@ -53,6 +67,7 @@ TEST(RingTest, InvalidData) {
     EXPECT_EQ(0, ringPop(&ring, NULL, sizeof(d0)));
 }
 
+#ifndef RING_POW2
 TEST(RingTest, Basic) {
 
     uint8_t buffer[RING_BUFFER_SIZE1];
@@ -298,3 +313,282 @@ TEST(RingTest, Wrapping) {
     // Ring status isn't reporting correctly for ringPush
     // Fails to wrap tail around.
 }
+
+TEST(RingTest, ReserveCommit) {
+    uint8_t buffer[RING_BUFFER_SIZE1];
+    Ring ring = ringInit(buffer, sizeof(buffer));
+    uint8_t * d = NULL;
+
+    EXPECT_EQ(RING_STATUS_FAIL, ringReserve(NULL, 4, &d));
+    EXPECT_EQ(RING_STATUS_FAIL, ringReserve(&ring, 4, NULL));
+    EXPECT_EQ(RING_STATUS_FAIL, ringReserve(&ring, 0, &d));
+    EXPECT_EQ(RING_STATUS_FAIL, ringCommit(&ring));
+    EXPECT_EQ(RING_STATUS_FAIL, ringRelease(NULL));
+    EXPECT_EQ(RING_STATUS_EMPTY, ringRelease(&ring));
+
+    // Reserved space is invisible to the consumer until committed
+    ASSERT_EQ(RING_STATUS_OK, ringReserve(&ring, 4, &d));
+    EXPECT_EQ(buffer + sizeof(RingPos_t), d);
+    d[0] = 1; d[1] = 2; d[2] = 3; d[3] = 4;
+    EXPECT_EQ(RING_STATUS_EMPTY, ringStatus(&ring));
+    EXPECT_EQ(0, ring.head);
+    EXPECT_EQ(RING_STATUS_OK, ringCommit(&ring));
+    EXPECT_EQ(RING_STATUS_FAIL, ringCommit(&ring));
+    EXPECT_EQ(4 + sizeof(RingPos_t), ring.head);
+
+    // Peek points into ring storage and release drops the frame
+    uint8_t * p = NULL;
+    EXPECT_EQ(4, ringPeek(&ring, &p));
+    EXPECT_EQ(d, p);
+    EXPECT_EQ(3, p[2]);
+    EXPECT_EQ(RING_STATUS_OK, ringRelease(&ring));
+    EXPECT_EQ(ring.head, ring.tail);
+    EXPECT_EQ(RING_STATUS_EMPTY, ringStatus(&ring));
+
+    // A reservation that doesn't fit is counted as an overflow
+    EXPECT_EQ(RING_STATUS_FAIL, ringReserve(&ring, RING_BUFFER_SIZE1, &d));
+    EXPECT_EQ(1, ringOverflowed(&ring));
+
+    // Reservations wrap to the front like ringPush
+    ASSERT_EQ(RING_STATUS_OK, ringReserve(&ring, 16, &d));
+    EXPECT_EQ(RING_STATUS_OK, ringCommit(&ring));
+    EXPECT_EQ(RING_STATUS_OK, ringRelease(&ring));
+    ASSERT_EQ(RING_STATUS_OK, ringReserve(&ring, 20, &d));
+    EXPECT_EQ(buffer + sizeof(RingPos_t), d);
+    EXPECT_EQ(RING_STATUS_OK, ringCommit(&ring));
+    EXPECT_EQ(20, ringPeek(&ring, &p));
+    EXPECT_EQ(d, p);
+    EXPECT_EQ(RING_STATUS_OK, ringRelease(&ring));
+    EXPECT_EQ(RING_STATUS_EMPTY, ringStatus(&ring));
+}
+
+#else
+TEST(RingTest, Pow2Init) {
+    uint8_t buffer[RING_BUFFER_SIZE1];
+    Ring ring = ringInit(buffer, 24);
+    EXPECT_TRUE(ring.data == NULL);
+
+    ring = ringInit(buffer, sizeof(buffer));
+    EXPECT_EQ(sizeof(buffer), ring.size);
+    EXPECT_EQ(RING_STATUS_EMPTY, ringStatus(&ring));
+    // Unlike the default layout the whole buffer is usable
+    EXPECT_EQ(RING_BUFFER_SIZE1 - sizeof(RingPos_t), ringFree(&ring));
+}
+
+TEST(RingTest, Pow2Basic) {
+    uint8_t buffer[RING_BUFFER_SIZE1];
+    Ring ring = ringInit(buffer, sizeof(buffer));
+    uint8_t d0[5] = {1,2,3,4,5};
+    uint8_t dout[RING_BUFFER_SIZE1] = {};
+
+    // Frames are padded to a multiple of sizeof(RingPos_t)
+    EXPECT_EQ(RING_STATUS_OK, ringPush(&ring, d0, sizeof(d0)));
+    EXPECT_EQ(sizeof(RingPos_t) + 8, ring.head);
+    EXPECT_EQ(RING_BUFFER_SIZE1 - ring.head - sizeof(RingPos_t), ringFree(&ring));
+
+    uint8_t * p = NULL;
+    EXPECT_EQ(sizeof(d0), ringPeek(&ring, &p));
+    EXPECT_EQ(buffer + sizeof(RingPos_t), p);
+    EXPECT_EQ(sizeof(d0), ringPop(&ring, dout, sizeof(dout)));
+    EXPECT_EQ(0, memcmp(d0, dout, sizeof(d0)));
+    EXPECT_EQ(ring.head, ring.tail);
+    EXPECT_EQ(RING_STATUS_EMPTY, ringStatus(&ring));
+
+    EXPECT_EQ(RING_STATUS_OK, ringPush(&ring, dout, 8));
+    EXPECT_EQ(8, ringPop(&ring, NULL, 0));
+    EXPECT_EQ(24, ring.tail);
+
+    // A frame that doesn't fit at the back skips to the front, and the
+    // positions keep counting past the capacity
+    ASSERT_EQ(RING_STATUS_OK, ringReserve(&ring, 12, &p));
+    EXPECT_EQ(buffer + sizeof(RingPos_t), p);
+    EXPECT_EQ(RING_STATUS_EMPTY, ringStatus(&ring));
+    EXPECT_EQ(RING_STATUS_OK, ringCommit(&ring));
+    EXPECT_EQ(RING_BUFFER_SIZE1 + sizeof(RingPos_t) + 12, ring.head);
+
+    uint8_t * q = NULL;
+    EXPECT_EQ(12, ringPeek(&ring, &q));
+    EXPECT_EQ(p, q);
+    EXPECT_EQ(RING_STATUS_OK, ringRelease(&ring));
+    EXPECT_EQ(ring.head, ring.tail);
+
+    // Fill the ring completely, no byte is lost to telling full from empty
+    EXPECT_EQ(RING_STATUS_OK, ringPush(&ring, dout, 12));
+    EXPECT_EQ(RING_BUFFER_SIZE1 - 2*sizeof(RingPos_t) - 12, ringFree(&ring));
+    EXPECT_EQ(RING_STATUS_OK, ringPush(&ring, dout, 12));
+    EXPECT_EQ(RING_BUFFER_SIZE1, ring.head - ring.tail);
+    EXPECT_EQ(0, ringFree(&ring));
+    EXPECT_EQ(RING_STATUS_FAIL, ringPush(&ring, dout, 1));
+    EXPECT_EQ(1, ringOverflowed(&ring));
+}
+
+TEST(RingTest, Pow2PositionWrap) {
+    uint8_t buffer[RING_BUFFER_SIZE1 * 8];
+    Ring ring = ringInit(buffer, sizeof(buffer));
+    uint8_t d0[RING_BUFFER_SIZE1] = {};
+    uint8_t dout[RING_BUFFER_SIZE1] = {};
+
+    // Start just short of the 32-bit position wrap, keeping two frames queued
+    ring.head = ring.tail = (RingPos_t)0 - 100;
+    RingPos_t i;
+    for (i = 0; i < 200; i++) {
+        RingPos_t size = 1 + i % RING_BUFFER_SIZE1;
+        memset(d0, (uint8_t)i, size);
+        ASSERT_EQ(RING_STATUS_OK, ringPush(&ring, d0, size));
+        if (i < 2) {
+            continue;
+        }
+
+        RingPos_t expect = 1 + (i - 2) % RING_BUFFER_SIZE1;
+        ASSERT_EQ(expect, ringPop(&ring, dout, sizeof(dout)));
+        EXPECT_EQ((uint8_t)(i - 2), dout[0]);
+        EXPECT_EQ((uint8_t)(i - 2), dout[expect - 1]);
+    }
+    EXPECT_LT(ring.head, (RingPos_t)sizeof(buffer) * 100);
+    EXPECT_EQ(0, ringOverflowed(&ring));
+}
+#endif
+
+// Message length and contents are derived from the sequence number so the
+// consumer can check both ordering and integrity. Every 64th message is
+// longer than 255 bytes to exercise the full RingPos_t size field.
+static RingPos_t stressMsgSize(uint64_t seq) {
+    uint32_t h = (uint32_t)(seq * 2654435761u);
+    if ((seq & 63) == 63) {
+        return 256 + (h >> 8) % (RING_STRESS_MAX_MSG - 256);
+    }
+    return sizeof(seq) + (h >> 8) % 24;
+}
+
+static void stressMsgFill(uint64_t seq, uint8_t * msg, RingPos_t size) {
+    memcpy(msg, &seq, sizeof(seq));
+    for (RingPos_t i = sizeof(seq); i < size; i++) {
+        msg[i] = (uint8_t)(seq + i);
+    }
+}
+
+TEST(RingTest, SpscStress) {
+    static uint8_t buffer[RING_STRESS_SIZE];
+    Ring ring = ringInit(buffer, sizeof(buffer));
+    uint64_t errors = 0;
+    uint64_t received = 0;
+
+    std::thread consumer([&] {
+        uint8_t dout[RING_STRESS_MAX_MSG];
+        uint8_t expect[RING_STRESS_MAX_MSG];
+        for (uint64_t seq = 0; seq < RING_STRESS_MSGS; ) {
+            // Alternate between copying and zero-copy consumption
+            uint8_t * msg = dout;
+            RingPos_t size = (seq & 1) ? ringPeek(&ring, &msg) :
+                ringPop(&ring, dout, sizeof(dout));
+            if (size == 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            RingPos_t expectSize = stressMsgSize(seq);
+            stressMsgFill(seq, expect, expectSize);
+            if (size != expectSize || memcmp(msg, expect, size) != 0) {
+                ++errors;
+            }
+            if (seq & 1) {
+                ringRelease(&ring);
+            }
+            ++seq;
+            ++received;
+        }
+    });
+
+    uint8_t msg[RING_STRESS_MAX_MSG];
+    uint64_t full = 0;
+    for (uint64_t seq = 0; seq < RING_STRESS_MSGS; ) {
+        RingPos_t size = stressMsgSize(seq);
+        // Alternate between copying and zero-copy production
+        if (seq & 2) {
+            uint8_t * dst = NULL;
+            while (ringReserve(&ring, size, &dst) != RING_STATUS_OK) {
+                ++full;
+                std::this_thread::yield();
+            }
+            stressMsgFill(seq, dst, size);
+            ringCommit(&ring);
+        }
+        else {
+            stressMsgFill(seq, msg, size);
+            while (ringPush(&ring, msg, size) != RING_STATUS_OK) {
+                ++full;
+                std::this_thread::yield();
+            }
+        }
+        ++seq;
+    }
+    consumer.join();
+
+    EXPECT_EQ(0u, errors);
+    EXPECT_EQ((uint64_t)RING_STRESS_MSGS, received);
+    EXPECT_EQ(RING_STATUS_EMPTY, ringStatus(&ring));
+    // Failed pushes are counted as overflows by the producer
+    EXPECT_EQ((uint8_t)full, ringOverflowed(&ring));
+    EXPECT_EQ(0, ringOverflowed(&ring));
+}
+
+#ifdef RING_POW2
+#define RING_LAYOUT "pow2"
+#else
+#define RING_LAYOUT "default"
+#endif
+
+static double ringBenchRate(std::chrono::steady_clock::time_point t0, uint64_t msgs) {
+    std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+    return msgs / dt.count() * 1e-6;
+}
+
+// Single threaded push/pop rate in batches of 16 frames. The frame sizes are
+// SCM and IDM messages including the decoder's message header. ringbuftest
+// and ringbuftest_pow2 report the rate of both layouts.
+TEST(RingTest, Throughput) {
+    static uint8_t buffer[RING_STRESS_SIZE];
+    const RingPos_t sizes[] = {18, 98};
+    uint8_t msg[RING_STRESS_MAX_MSG] = {};
+    uint8_t dout[RING_STRESS_MAX_MSG];
+
+    for (RingPos_t size : sizes) {
+        Ring ring = ringInit(buffer, sizeof(buffer));
+        uint64_t popped = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < RING_BENCH_MSGS; i += 16) {
+            for (uint32_t j = 0; j < 16; j++) {
+                msg[0] = (uint8_t)j;
+                ringPush(&ring, msg, size);
+            }
+            while (ringPop(&ring, dout, sizeof(dout)) == size) {
+                popped += dout[0] + 1;
+            }
+        }
+        double copyRate = ringBenchRate(t0, RING_BENCH_MSGS);
+        EXPECT_EQ(RING_BENCH_MSGS / 16 * (16 * 17 / 2), popped);
+
+        ring = ringInit(buffer, sizeof(buffer));
+        popped = 0;
+        t0 = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < RING_BENCH_MSGS; i += 16) {
+            for (uint32_t j = 0; j < 16; j++) {
+                uint8_t * dst = NULL;
+                if (ringReserve(&ring, size, &dst) == RING_STATUS_OK) {
+                    dst[0] = (uint8_t)j;
+                    ringCommit(&ring);
+                }
+            }
+            uint8_t * src = NULL;
+            while (ringPeek(&ring, &src) == size) {
+                popped += src[0] + 1;
+                ringRelease(&ring);
+            }
+        }
+        double zeroCopyRate = ringBenchRate(t0, RING_BENCH_MSGS);
+        EXPECT_EQ(RING_BENCH_MSGS / 16 * (16 * 17 / 2), popped);
+
+        printf("[ %-8s ] %3u byte frames: push/pop %6.1f M/s, "
+                "reserve/release %6.1f M/s\n",
+                RING_LAYOUT, size, copyRate, zeroCopyRate);
+    }
+}
@@ -0,0 +1,131 @@
+// Decode a chip capture with the host HAL and print the messages
+//
+// usage: amrdump [-i packed|bits|ascii] [-o json|csv|binary] [-w frames] [capture|-]
+//        amrdump -r [-t] [-o json|csv|binary] [-w frames] recording
+//
+// -w records the frames queued by the decoder, -r replays a recording made
+// with -w or amrRecorder, -t paces the replay in real time.
+#include "../amr.h"
+#include "../amr_format.h"
+#include "../amr_replay.h"
+#include "../ezradio/platform/host/amr_hal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define DUMP_BATCH 64
+
+static AMR_FORMAT dumpFormat = AMR_FORMAT_JSON;
+static AmrTaggedMsg dumpMsgs[DUMP_BATCH];
+static uint64_t dumpCnt;
+
+static void dumpBatch(const AmrTaggedMsg * msgs, size_t cnt) {
+    uint8_t buf[AMR_FORMAT_MAX_LEN];
+    size_t i = 0;
+    for (; i < cnt; ++i) {
+        size_t len = amrFormat(dumpFormat, buf, sizeof(buf), msgs[i].hdr.type,
+                &msgs[i].msg, msgs[i].hdr.timestamp);
+        fwrite(buf, 1, len, stdout);
+    }
+    dumpCnt += cnt;
+}
+
+static int usage(const char * name) {
+    fprintf(stderr, "usage: %s [-i packed|bits|ascii] [-o json|csv|binary] [-w frames] [capture|-]\n"
+            "       %s -r [-t] [-o json|csv|binary] [-w frames] recording\n", name, name);
+    return 2;
+}
+
+int main(int argc, char ** argv) {
+    AMR_HAL_FORMAT input = AMR_HAL_FORMAT_PACKED;
+    const char * path = "-";
+    const char * framesPath = NULL;
+    uint8_t replay = 0;
+    uint8_t realTime = 0;
+    AmrRecorder recorder;
+    int opt;
+    while ((opt = getopt(argc, argv, "i:o:w:rt")) != -1) {
+        if (opt == 'w') {
+            framesPath = optarg;
+        }
+        else if (opt == 'r') {
+            replay = 1;
+        }
+        else if (opt == 't') {
+            realTime = 1;
+        }
+        else if (opt == 'i' && strcmp(optarg, "packed") == 0) {
+            input = AMR_HAL_FORMAT_PACKED;
+        }
+        else if (opt == 'i' && strcmp(optarg, "bits") == 0) {
+            input = AMR_HAL_FORMAT_BITS;
+        }
+        else if (opt == 'i' && strcmp(optarg, "ascii") == 0) {
+            input = AMR_HAL_FORMAT_ASCII;
+        }
+        else if (opt == 'o' && strcmp(optarg, "json") == 0) {
+            dumpFormat = AMR_FORMAT_JSON;
+        }
+        else if (opt == 'o' && strcmp(optarg, "csv") == 0) {
+            dumpFormat = AMR_FORMAT_CSV;
+        }
+        else if (opt == 'o' && strcmp(optarg, "binary") == 0) {
+            dumpFormat = AMR_FORMAT_BINARY;
+        }
+        else {
+            return usage(argv[0]);
+        }
+    }
+    if (optind + 1 < argc) {
+        return usage(argv[0]);
+    }
+    if (optind < argc) {
+        path = argv[optind];
+    }
+
+    if (!replay && !amrHalSetSource(path, input)) {
+        perror(path);
+        return 1;
+    }
+
+    amrInit();
+    registerAmrBatchCallback(dumpBatch, dumpMsgs, DUMP_BATCH);
+    if (framesPath) {
+        if (!amrRecorderOpen(&recorder, framesPath, AMR_REPLAY_FRAMES, 0)) {
+            perror(framesPath);
+            return 1;
+        }
+        amrDecoderSetFrameTap(amrGetDecoder(), amrRecorderFrameTap, &recorder);
+    }
+    if (dumpFormat == AMR_FORMAT_CSV) {
+        fputs(AMR_FORMAT_CSV_HEADER, stdout);
+    }
+
+    uint64_t chips;
+    if (replay) {
+        AmrReplayStats stats;
+        if (!amrReplay(NULL, path, realTime, &stats)) {
+            fprintf(stderr, "%s: not a recording\n", path);
+            return 1;
+        }
+        chips = stats.chips;
+        if (stats.dropped) {
+            fprintf(stderr, "%s: %llu invalid frames dropped\n", path,
+                    (unsigned long long)stats.dropped);
+        }
+    }
+    else {
+        amrEnable(1);
+        amrHalWait();
+        chips = amrHalChips();
+    }
+    if (framesPath) {
+        amrRecorderClose(&recorder);
+    }
+    fflush(stdout);
+    fprintf(stderr, "%llu chips, %llu messages\n",
+            (unsigned long long)chips, (unsigned long long)dumpCnt);
+    return 0;
+}
@@ -0,0 +1,120 @@
+// Write a synthetic packed chip capture for amrdump
+//
+// usage: amrgen [-s seed] [-f frames/s] [-e chip error rate] [-d seconds]
+//               [-m scm,scm+,idm] [-z] [-g truth.csv] capture|-
+//
+// -m sets the relative share of each frame type, -z fills the gaps between
+// frames with zeros instead of random chips, -g writes one CSV line per
+// generated frame: start chip, chips, type, id, consumption.
+#include "../amr.h"
+#include "../amr_gen.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define GEN_BLOCK_CHIPS (1 << 20)
+
+static const char * genTypes[] = {"SCM", "SCM+", "IDM"};
+static uint8_t genBlock[GEN_BLOCK_CHIPS / 8];
+
+static void genTruth(void * user, const AmrGenFrame * frame) {
+    fprintf((FILE *)user, "%llu,%u,%s,%u,%u\n", (unsigned long long)frame->start, frame->chips,
+            genTypes[frame->type], frame->id, frame->consumption);
+}
+
+static int usage(const char * name) {
+    fprintf(stderr, "usage: %s [-s seed] [-f frames/s] [-e chip error rate] [-d seconds]\n"
+            "       %*s [-m scm,scm+,idm] [-z] [-g truth.csv] capture|-\n", name, (int)strlen(name), "");
+    return 2;
+}
+
+int main(int argc, char ** argv) {
+    AmrGenConfig cfg = {0};
+    AmrGen gen;
+    double seconds = 60;
+    const char * truthPath = NULL;
+    FILE * truth = NULL;
+    FILE * out;
+    uint64_t remaining;
+    int opt;
+
+    cfg.seed = 1;
+    cfg.framesPerSec = 10;
+    cfg.randomNoise = 1;
+    while ((opt = getopt(argc, argv, "s:f:e:d:m:zg:")) != -1) {
+        if (opt == 's') {
+            cfg.seed = strtoull(optarg, NULL, 0);
+        }
+        else if (opt == 'f') {
+            cfg.framesPerSec = atof(optarg);
+        }
+        else if (opt == 'e') {
+            cfg.chipErrorRate = atof(optarg);
+        }
+        else if (opt == 'd') {
+            seconds = atof(optarg);
+        }
+        else if (opt == 'm') {
+            unsigned w[3];
+            if (sscanf(optarg, "%u,%u,%u", &w[0], &w[1], &w[2]) != 3 || w[0] > 255 || w[1] > 255 || w[2] > 255) {
+                return usage(argv[0]);
+            }
+            cfg.weights[0] = (uint8_t)w[0];
+            cfg.weights[1] = (uint8_t)w[1];
+            cfg.weights[2] = (uint8_t)w[2];
+        }
+        else if (opt == 'z') {
+            cfg.randomNoise = 0;
+        }
+        else if (opt == 'g') {
+            truthPath = optarg;
+        }
+        else {
+            return usage(argv[0]);
+        }
+    }
+    if (optind + 1 != argc || seconds <= 0) {
+        return usage(argv[0]);
+    }
+
+    out = strcmp(argv[optind], "-") == 0 ? stdout : fopen(argv[optind], "wb");
+    if (out == NULL) {
+        perror(argv[optind]);
+        return 1;
+    }
+    if (truthPath != NULL) {
+        truth = fopen(truthPath, "w");
+        if (truth == NULL) {
+            perror(truthPath);
+            return 1;
+        }
+    }
+    if (!amrGenInit(&gen, &cfg, truth != NULL ? genTruth : NULL, truth)) {
+        fprintf(stderr, "%s: invalid generator settings\n", argv[0]);
+        return 2;
+    }
+
+    // Whole bytes only, the packed capture format has no bit count
+    remaining = ((uint64_t)(seconds * gen.cfg.chipRate) + 7) & ~(uint64_t)7;
+    while (remaining > 0) {
+        size_t n = remaining < GEN_BLOCK_CHIPS ? (size_t)remaining : GEN_BLOCK_CHIPS;
+        amrGenFill(&gen, genBlock, n);
+        if (fwrite(genBlock, 1, n / 8, out) != n / 8) {
+            perror(argv[optind]);
+            return 1;
+        }
+        remaining -= n;
+    }
+
+    if (truth != NULL && fclose(truth) != 0) {
+        perror(truthPath);
+        return 1;
+    }
+    if (fclose(out) != 0) {
+        perror(argv[optind]);
+        return 1;
+    }
+    return 0;
+}
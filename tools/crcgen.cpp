@@ -0,0 +1,52 @@
+// Generates amr_crc_tables.h for the C build from the CRC templates in
+// amr_crc.hpp: the slicing-by-8 tables and the carry-less multiply folding
+// constants for each ERT CRC-16 polynomial.
+//   make -C tools
+#include "../amr_crc.hpp"
+#include <stdio.h>
+
+template <typename Spec>
+static void printTables(const char * name) {
+    printf("    { // %s\n", name);
+    for (unsigned k = 0; k < Spec::slices; k++) {
+        printf("        {");
+        for (unsigned b = 0; b < 256; b++) {
+            printf("%s0x%04x,", (b % 10) ? "" : "\n            ", Spec::tables.t[k][b]);
+        }
+        printf("\n        },\n");
+    }
+    printf("    },\n");
+}
+
+template <typename Spec>
+static void printFold(const char * name) {
+    printf("    {0x%04llx, 0x%04llx, 0x%04llx, 0x%04llx, 0x%016llxull, 0x%04x}, // %s\n",
+            (unsigned long long)Spec::powMod(64), (unsigned long long)Spec::powMod(96),
+            (unsigned long long)Spec::powMod(128), (unsigned long long)Spec::powMod(192),
+            (unsigned long long)Spec::barrettMu(), Spec::poly, name);
+}
+
+int main() {
+    static_assert(AmrCrcScm::slices == AmrCrcScmPlus::slices, "table shapes differ");
+
+    printf("// Generated by tools/crcgen from amr_crc.hpp, do not edit\n");
+    printf("#ifndef AMR_CRC_TABLES_H\n#define AMR_CRC_TABLES_H\n\n");
+    printf("#include \"amr_crc.h\"\n\n");
+    printf("// amrCrcTables[poly][k][b] is the register after byte b followed by k zero bytes\n");
+    printf("const uint16_t amrCrcTables[AMR_CRC_CNT][%u][256] = {\n", AmrCrcScm::slices);
+    printTables<AmrCrcScm>("AMR_CRC_BCH");
+    printTables<AmrCrcScmPlus>("AMR_CRC_CCITT");
+    printf("};\n\n");
+
+    printf("// Folding constants t^n mod P and the Barrett reduction constant\n");
+    printf("typedef struct {\n");
+    printf("    uint64_t k64, k96, k128, k192;\n");
+    printf("    uint64_t mu; //! floor(t^80 / P) - t^64\n");
+    printf("    uint64_t poly; //! P - t^16\n");
+    printf("} AmrCrcFold;\n\n");
+    printf("static const AmrCrcFold amrCrcFolds[AMR_CRC_CNT] = {\n");
+    printFold<AmrCrcScm>("AMR_CRC_BCH");
+    printFold<AmrCrcScmPlus>("AMR_CRC_CCITT");
+    printf("};\n\n#endif\n");
+    return 0;
+}